@@ -62,6 +62,7 @@ using namespace NVM;
 DDR3Bank::DDR3Bank( )
 {
     nextActivate = 0;
+    nextSubArrayActivate = 0;
     nextPrecharge = 0;
     nextRead = 0;
     nextWrite = 0;
@@ -114,17 +115,20 @@ DDR3Bank::DDR3Bank( )
     activates = 0;
     precharges = 0;
     refreshes = 0;
-    overlapped_activates = 0;
-    overlapped_double_row_activates = 0;
-    overlapped_triple_row_activates = 0;
-    single_row_activates = 0;
-    double_row_activates = 0;
-    triple_row_activates = 0;
+    for( ncounter_t i = 0; i < PIMPrimitives; i++ )
+        pimActivates[i] = 0;
 
     actWaits = 0;
     actWaitTotal = 0;
     actWaitAverage = 0.0;
 
+    masaActivates = 0;
+    masaPeakOpenSubArrays = 0;
+
+    row_buffer_moves = 0;
+    row_buffer_move_hops = 0;
+    local_writes = 0;
+
     averageEndurance = 0;
     worstCaseEndurance = 0;
 
@@ -216,12 +220,22 @@ void DDR3Bank::RegisterStats( )
     AddStat(activates);
     AddStat(precharges);
     AddStat(refreshes);
-    AddStat(overlapped_activates);
-    AddStat(overlapped_double_row_activates);
-    AddStat(overlapped_triple_row_activates);
-    AddStat(single_row_activates);
-    AddStat(double_row_activates);
-    AddStat(triple_row_activates);
+    for( ncounter_t i = 0; i < PIMPrimitives; i++ )
+    {
+        PIMPrimitive primitive = static_cast<PIMPrimitive>(i);
+
+        if( p->pimCosts.IsEnabled( primitive ) )
+            AddNamedStat(pimActivates[i], PIMCostModel::GetInfo( primitive ).statName);
+    }
+
+    if( p->RowClone )
+    {
+        AddStat(row_buffer_moves);
+        AddStat(row_buffer_move_hops);
+    }
+
+    if( p->LocalWrite )
+        AddStat(local_writes);
 
     AddStat(activeCycles);
     AddStat(standbyCycles);
@@ -233,6 +247,12 @@ void DDR3Bank::RegisterStats( )
     AddStat(actWaitTotal); 
     AddStat(actWaitAverage);
 
+    if( p->MASA )
+    {
+        AddStat(masaActivates);
+        AddStat(masaPeakOpenSubArrays);
+    }
+
     AddStat(averageEndurance);
     AddStat(worstCaseEndurance);
 }
@@ -354,8 +374,8 @@ bool DDR3Bank::OverlappedActivate( NVMainRequest *request )
     request->address.GetTranslatedAddress( &activateRow, NULL, NULL, NULL, NULL, &activateSubArray );
 
     /* update the timing constraints */
-    nextPowerDown = MAX( nextPowerDown, 
-                         GetEventQueue()->GetCurrentCycle() + p->tRCD + p->tSH );
+    nextPowerDown = MAX( nextPowerDown, GetEventQueue()->GetCurrentCycle() 
+                         + p->pimCosts.GetActivateCycles( request->type ) + p->tSH );
 
     /* issue OA to the target subarray */
     bool success = GetChild( request )->IssueCommand( request );
@@ -379,22 +399,11 @@ bool DDR3Bank::OverlappedActivate( NVMainRequest *request )
         // if( !alreadyActive )
         //     activeSubArrayQueue.push_front( activateSubArray );
 
-        switch (request->type)
-        {
-            case OA:
-                overlapped_activates++;
-                break;
-            case ODRA:
-                overlapped_double_row_activates++;
-                break;
-            case OTRA:
-                overlapped_triple_row_activates++;
-                break;
-            default:
-                std::cerr << "NVMain Error : OverlappedActivate unknown operation type "
-                            <<  request->type << std::endl;
-                break;
-        }
+        if( PIMCostModel::IsOverlappedActivate( request->type ) )
+            pimActivates[PIMCostModel::GetPrimitive( request->type )]++;
+        else
+            std::cerr << "NVMain Error : OverlappedActivate unknown operation type "
+                        <<  request->type << std::endl;
     }
     else
     {
@@ -436,8 +445,8 @@ bool DDR3Bank::MultiRowActivate( NVMainRequest *request )
     request->address.GetTranslatedAddress( &activateRow, NULL, NULL, NULL, NULL, &activateSubArray );
 
     /* update the timing constraints */
-    nextPowerDown = MAX( nextPowerDown, 
-                         GetEventQueue()->GetCurrentCycle() + p->tRCD + p->tSH );
+    nextPowerDown = MAX( nextPowerDown, GetEventQueue()->GetCurrentCycle() 
+                         + p->pimCosts.GetActivateCycles( request->type ) + p->tSH );
 
     /* issue ACTIVATE to the target subarray */
     bool success = GetChild( request )->IssueCommand( request );
@@ -461,22 +470,13 @@ bool DDR3Bank::MultiRowActivate( NVMainRequest *request )
         if( !alreadyActive )
             activeSubArrayQueue.push_front( activateSubArray );
 
-        switch (request->type)
-        {
-            case SRA:
-                single_row_activates++;
-                break;
-            case DRA:
-                double_row_activates++;
-                break;
-            case TRA:
-                triple_row_activates++;
-                break;
-            default:
-                std::cerr << "NVMain Error : MultiRowActivate unknown operation type "
-                            <<  request->type << std::endl;
-                break;
-        }
+        SubArrayActivated( );
+
+        if( PIMCostModel::IsMultiRowActivate( request->type ) )
+            pimActivates[PIMCostModel::GetPrimitive( request->type )]++;
+        else
+            std::cerr << "NVMain Error : MultiRowActivate unknown operation type "
+                        <<  request->type << std::endl;
     }
     else
     {
@@ -534,6 +534,8 @@ bool DDR3Bank::Activate( NVMainRequest *request )
         state = DDR3BANK_OPEN;
         activeSubArrayQueue.push_front( activateSubArray );
         activates++;
+
+        SubArrayActivated( );
     }
     else
     {
@@ -545,6 +547,84 @@ bool DDR3Bank::Activate( NVMainRequest *request )
 }
 
 
+/*
+ *  LISA row buffer movement from the open source subarray into the
+ *  destination subarray, which becomes active with the copied row buffer.
+ */
+bool DDR3Bank::RowBufferMove( NVMainRequest *request )
+{
+    /* sanity check */
+    if( nextActivate > GetEventQueue()->GetCurrentCycle() )
+    {
+        std::cerr << "NVMain Error: Bank violates ROW BUFFER MOVE timing constraint!"
+            << std::endl;
+        return false;
+    }
+    else if( state != DDR3BANK_OPEN )
+    {
+        std::cerr << "NVMain Error: try to move a row buffer in a bank that is not open!"
+            << std::endl;
+        return false;
+    }
+
+    ncounter_t dstRow, dstSubArray, srcSubArray;
+    request->address.GetTranslatedAddress( &dstRow, NULL, NULL, NULL, NULL, &dstSubArray );
+    request->address2.GetTranslatedAddress( NULL, NULL, NULL, NULL, NULL, &srcSubArray );
+
+    ncounter_t hops = (dstSubArray > srcSubArray) ? (dstSubArray - srcSubArray)
+                                                  : (srcSubArray - dstSubArray);
+
+    nextPowerDown = MAX( nextPowerDown, 
+                         GetEventQueue()->GetCurrentCycle() + hops * p->tRBM );
+
+    /* The source subarray is released first, the destination reports completion. */
+    bool success = GetChild( srcSubArray )->IssueCommand( request )
+                && GetChild( request )->IssueCommand( request );
+
+    if( success && p->PIMFunctional )
+    {
+        SubArray *srcArray = dynamic_cast<SubArray *>( GetChild( srcSubArray )->GetTrampoline( ) );
+        SubArray *dstArray = dynamic_cast<SubArray *>( GetChild( request )->GetTrampoline( ) );
+
+        dstArray->LoadRowBuffer( srcArray->GetRowBuffer( ) );
+    }
+
+    if( success )
+    {
+        openRow = dstRow;
+        activeSubArrayQueue.push_front( dstSubArray );
+
+        row_buffer_moves++;
+        row_buffer_move_hops += hops;
+    }
+    else
+    {
+        std::cerr << "NVMain Error: Bank " << bankId << " failed to "
+            << "move the row buffer of subarray " << srcSubArray 
+            << " to subarray " << dstSubArray << std::endl;
+    }
+
+    return success;
+}
+
+/*
+ *  With MASA, every subarray keeps its row in its local row buffer and the
+ *  bank only spaces consecutive activates by tSAS.
+ */
+void DDR3Bank::SubArrayActivated( )
+{
+    if( !p->MASA )
+        return;
+
+    nextSubArrayActivate = GetEventQueue()->GetCurrentCycle() + p->tSAS;
+
+    if( activeSubArrayQueue.size( ) > 1 )
+        masaActivates++;
+
+    if( activeSubArrayQueue.size( ) > masaPeakOpenSubArrays )
+        masaPeakOpenSubArrays = activeSubArrayQueue.size( );
+}
+
 /*
  * Shift the current dbc to the specified location 
  */
@@ -732,6 +812,58 @@ bool DDR3Bank::Write( NVMainRequest *request )
     return success;
 }
 
+/*
+ * LocalWrite() writes a PIM result held inside the bank back into the open
+ * row. The data never crosses the data bus, so only tCWD/tWR apply.
+ */
+bool DDR3Bank::LocalWrite( NVMainRequest *request )
+{
+    /* sanity check */
+    if( nextWrite > GetEventQueue()->GetCurrentCycle() )
+    {
+        std::cerr << "NVMain Error: Bank violates LOCAL WRITE timing constraint!"
+            << std::endl;
+        return false;
+    }
+    else if( state != DDR3BANK_OPEN )
+    {
+        std::cerr << "NVMain Error: try to local write a bank that is not active!"
+            << std::endl;
+        return false;
+    }
+
+    uint64_t writeSubArray;
+    request->address.GetTranslatedAddress( NULL, NULL, NULL, NULL, NULL, &writeSubArray );
+
+    /* Update timing constraints */
+    nextPowerDown = MAX( nextPowerDown, 
+                         GetEventQueue()->GetCurrentCycle() + p->tWRPDEN );
+
+    nextRead = MAX( nextRead, 
+                    GetEventQueue()->GetCurrentCycle() 
+                    + p->tCWD + p->tBURST + p->tWTR );
+
+    nextWrite = MAX( nextWrite, 
+                     GetEventQueue()->GetCurrentCycle() 
+                     + MAX( p->tBURST, p->tCCD ) );
+
+    /* issue LW to the target subarray */
+    bool success = GetChild( request )->IssueCommand( request );
+
+    if( success )
+    {
+        writeCycle = true;
+        local_writes++;
+    }
+    else
+    {
+        std::cerr << "NVMain Error: Bank " << bankId << " failed to "
+            << "local write the subarray " << writeSubArray << std::endl;
+    }
+
+    return success;
+}
+
 /*
  * Precharge() close a row and force the bank back to DDR3BANK_CLOSED
  */
@@ -895,9 +1027,11 @@ ncycle_t DDR3Bank::NextIssuable( NVMainRequest *request )
 {
     ncycle_t nextCompare = 0;
 
-    if( request->type == ACTIVATE || request->type == REFRESH ) nextCompare = nextActivate;
+    if( request->type == ACTIVATE || PIMCostModel::IsMultiRowActivate( request->type ) ) nextCompare = MAX( nextActivate, nextSubArrayActivate );
+    else if( request->type == REFRESH || request->type == ROWCLONE_LISA ) nextCompare = nextActivate;
     else if( request->type == READ || request->type == READ_PRECHARGE ) nextCompare = nextRead;
-    else if( request->type == WRITE || request->type == WRITE_PRECHARGE ) nextCompare = nextWrite;
+    else if( request->type == WRITE || request->type == WRITE_PRECHARGE 
+             || request->type == LW ) nextCompare = nextWrite;
     else if( request->type == PRECHARGE || request->type == PRECHARGE_ALL ) nextCompare = nextPrecharge;
         
     return MAX(GetChild( request )->NextIssuable( request ), nextCompare );
@@ -916,10 +1050,12 @@ bool DDR3Bank::IsIssuable( NVMainRequest *req, FailReason *reason )
     if( nextCommand != CMD_NOP )
         return false;
       
-    if( req->type == ACTIVATE || req->type == TRA || req->type == DRA || req->type == SRA )
+    if( req->type == ACTIVATE || PIMCostModel::IsMultiRowActivate( req->type ) )
     {
+        ncycle_t activateReady = MAX( nextActivate, nextSubArrayActivate );
+
         /* if the bank-level nextActive is not satisfied, cannot issue */
-        if( nextActivate > ( GetEventQueue()->GetCurrentCycle() ) 
+        if( activateReady > ( GetEventQueue()->GetCurrentCycle() ) 
             || state == DDR3BANK_PDPF || state == DDR3BANK_PDPS || state == DDR3BANK_PDA )
 
         {
@@ -928,14 +1064,14 @@ bool DDR3Bank::IsIssuable( NVMainRequest *req, FailReason *reason )
                 reason->reason = BANK_TIMING;
 
             actWaits++;
-            actWaitTotal += nextActivate - (GetEventQueue()->GetCurrentCycle());
+            actWaitTotal += activateReady - (GetEventQueue()->GetCurrentCycle());
         }
         else
         {
             rv = GetChild( req )->IsIssuable( req, reason );
         }
     }
-    else if( req->type == OA || req->type == ODRA || req->type == OTRA )
+    else if( PIMCostModel::IsOverlappedActivate( req->type ) )
     {
         if( state != DDR3BANK_OPEN  )
         {
@@ -948,6 +1084,26 @@ bool DDR3Bank::IsIssuable( NVMainRequest *req, FailReason *reason )
             rv = GetChild( req )->IsIssuable( req, reason );
         }
     }
+    else if( req->type == ROWCLONE_LISA )
+    {
+        uint64_t srcSubArray;
+
+        req->address2.GetTranslatedAddress( NULL, NULL, NULL, NULL, NULL, &srcSubArray );
+
+        /* The source subarray is open, so is the bank. */
+        if( nextActivate > ( GetEventQueue()->GetCurrentCycle() )
+            || state != DDR3BANK_OPEN )
+        {
+            rv = false;
+            if( reason ) 
+                reason->reason = BANK_TIMING;
+        }
+        else
+        {
+            rv = GetChild( srcSubArray )->IsIssuable( req, reason )
+                 && GetChild( req )->IsIssuable( req, reason );
+        }
+    }
     else if(req->type == SHIFT )
     {
         rv = GetChild( req )->IsIssuable( req, reason );
@@ -966,7 +1122,7 @@ bool DDR3Bank::IsIssuable( NVMainRequest *req, FailReason *reason )
             rv = GetChild( req )->IsIssuable( req, reason );
         }
     }
-    else if( req->type == WRITE || req->type == WRITE_PRECHARGE )
+    else if( req->type == WRITE || req->type == WRITE_PRECHARGE || req->type == LW )
     {
         if( nextWrite > (GetEventQueue()->GetCurrentCycle()) 
             || state != DDR3BANK_OPEN )
@@ -1096,16 +1252,8 @@ bool DDR3Bank::IssueCommand( NVMainRequest *req )
                 rv = this->Activate( req );
                 break;
 
-            case OA:
-            case ODRA:
-            case OTRA:
-                rv = this->OverlappedActivate( req );
-                break;
-
-            case SRA:
-            case DRA:
-            case TRA:
-                rv = this->MultiRowActivate( req );
+            case ROWCLONE_LISA:
+                rv = this->RowBufferMove( req );
                 break;
 
             case SHIFT:
@@ -1121,6 +1269,10 @@ bool DDR3Bank::IssueCommand( NVMainRequest *req )
             case WRITE_PRECHARGE:
                 rv = this->Write( req );
                 break;
+
+            case LW:
+                rv = this->LocalWrite( req );
+                break;
             
             case PRECHARGE:
             case PRECHARGE_ALL:
@@ -1141,8 +1293,14 @@ bool DDR3Bank::IssueCommand( NVMainRequest *req )
                 rv = this->PowerUp( req );
                 break;
 
+            /* PIM activates are dispatched by their entry in the cost table. */
             default:
-                rv = GetChild( req )->IssueCommand( req );
+                if( PIMCostModel::IsMultiRowActivate( req->type ) )
+                    rv = this->MultiRowActivate( req );
+                else if( PIMCostModel::IsOverlappedActivate( req->type ) )
+                    rv = this->OverlappedActivate( req );
+                else
+                    rv = GetChild( req )->IssueCommand( req );
                 break;  
         }
     }
@@ -135,6 +135,7 @@ class DDR3Bank : public Bank
 
     ncycle_t lastActivate;
     ncycle_t nextActivate;
+    ncycle_t nextSubArrayActivate;
     ncycle_t nextPrecharge;
     ncycle_t nextRead;
     ncycle_t nextWrite;
@@ -150,6 +151,13 @@ class DDR3Bank : public Bank
     ncounter_t actWaitTotal;
     double actWaitAverage;
 
+    ncounter_t masaActivates;
+    ncounter_t masaPeakOpenSubArrays;
+
+    ncounter_t row_buffer_moves;
+    ncounter_t row_buffer_move_hops;
+    ncounter_t local_writes;
+
     double bankEnergy;
     double activeEnergy;
     double burstEnergy;
@@ -166,9 +174,8 @@ class DDR3Bank : public Bank
 
     uint64_t averageEndurance, worstCaseEndurance;
 
-    ncounter_t reads, writes, activates, precharges, refreshes, 
-      overlapped_activates, overlapped_double_row_activates, overlapped_triple_row_activates,
-      single_row_activates, double_row_activates, triple_row_activates;
+    ncounter_t reads, writes, activates, precharges, refreshes;
+    ncounter_t pimActivates[PIMPrimitives];
 
     ncounter_t idleTimer;
 
@@ -180,8 +187,11 @@ class DDR3Bank : public Bank
     virtual bool Shift( NVMainRequest *request );
     virtual bool OverlappedActivate( NVMainRequest *request );
     virtual bool MultiRowActivate( NVMainRequest *request );
+    virtual bool RowBufferMove( NVMainRequest *request );
+    void SubArrayActivated( );
     virtual bool Read( NVMainRequest *request );
     virtual bool Write( NVMainRequest *request );
+    virtual bool LocalWrite( NVMainRequest *request );
     virtual bool Precharge( NVMainRequest *request );
     virtual bool Refresh( NVMainRequest *request );
     virtual bool PowerUp( NVMainRequest *request );
@@ -55,6 +55,9 @@ class DRCDecoder : public AddressTranslator
     using AddressTranslator::Translate;
     using AddressTranslator::SetDefaultField;
 
+    /* Cache set mapping is not described by the translation method. */
+    uint64_t GetTranslationLayout( ) { return 0; }
+
     void RegisterStats( ) { }
     void CalculateStats( ) { }
 
@@ -37,6 +37,8 @@
 /* Add your decoder's include file below. */
 #include "Decoders/DRCDecoder/DRCDecoder.h"
 #include "Decoders/Migrator/Migrator.h"
+#include "Decoders/XORDecoder/XORDecoder.h"
+#include "Decoders/PIMDecoder/PIMDecoder.h"
 
 using namespace NVM;
 
@@ -47,6 +49,8 @@ AddressTranslator *DecoderFactory::CreateDecoder( std::string decoder )
     if( decoder == "Default" ) trans = new AddressTranslator( );
     else if( decoder == "DRCDecoder" ) trans = new DRCDecoder( );
     else if( decoder == "Migrator" ) trans = new Migrator( );
+    else if( decoder == "XORDecoder" ) trans = new XORDecoder( );
+    else if( decoder == "PIMDecoder" ) trans = new PIMDecoder( );
 
     return trans;
 }
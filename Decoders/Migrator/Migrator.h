@@ -64,6 +64,9 @@ class Migrator : public AddressTranslator
                             uint64_t *rank, uint64_t *channel, uint64_t *subarray );
     using AddressTranslator::Translate;
 
+    /* Translations change as pages migrate, so they are never reused. */
+    uint64_t GetTranslationLayout( ) { return 0; }
+
     void StartMigration( NVMAddress& promotee, NVMAddress& demotee );
     void SetMigrationState( NVMAddress& address, MigratorState newState );
     bool Migrating( );
@@ -0,0 +1,280 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+
+#include "Decoders/PIMDecoder/PIMDecoder.h"
+#include <iostream>
+#include <cstdlib>
+
+using namespace NVM;
+
+PIMDecoder::PIMDecoder( )
+{
+    baseSet = false;
+    regionBase = 0;
+    regionRows = 0;
+    reservedRows = 0;
+
+    rowSize = 0;
+    rowsPerRegion = 0;
+    regionsPerSubarray = 0;
+    subarraySlots = 0;
+    banks = ranks = channels = 1;
+
+    allocateRegions = 0;
+    allocatedRegions = 0;
+}
+
+void PIMDecoder::SetConfig( Config *config, bool /*createChildren*/ )
+{
+    if( config->KeyExists( "PIMRegionBase" ) )
+    {
+        regionBase = strtoull( config->GetString( "PIMRegionBase" ).c_str( ), NULL, 0 );
+        baseSet = true;
+    }
+
+    /* Zero means one region spans all operand rows of a subarray. */
+    if( config->KeyExists( "PIMRegionRows" ) )
+        regionRows = config->GetValueUL( "PIMRegionRows" );
+
+    /* By default, leave out the compute rows reserved in each subarray. */
+    if( config->KeyExists( "PIMReservedRows" ) )
+    {
+        reservedRows = config->GetValueUL( "PIMReservedRows" );
+    }
+    else
+    {
+        const char *groups[4] = { "ReservedBGroupRows", "ReservedDCCRows", 
+                                  "ReservedZeroRows", "ReservedOneRows" };
+
+        reservedRows = 0;
+        for( int i = 0; i < 4; i++ )
+        {
+            if( config->KeyExists( groups[i] ) )
+                reservedRows += config->GetValueUL( groups[i] );
+        }
+    }
+
+    if( config->KeyExists( "PIMAllocateRegions" ) )
+        allocateRegions = config->GetValueUL( "PIMAllocateRegions" );
+
+    UpdateGeometry( );
+}
+
+void PIMDecoder::SetTranslationMethod( TranslationMethod *m )
+{
+    AddressTranslator::SetTranslationMethod( m );
+
+    UpdateGeometry( );
+}
+
+/*
+ *  Caches the region layout, so translating a region address only divides.
+ *  Decoders are configured before and after their method is installed, so
+ *  this runs on both.
+ */
+void PIMDecoder::UpdateGeometry( )
+{
+    /* Every level creates its own decoder; only print the layout once. */
+    static bool printed = false;
+
+    if( GetTranslationMethod( ) == NULL )
+        return;
+
+    unsigned int rowBits, colBits, bankBits, rankBits, channelBits, subarrayBits;
+    uint64_t rows, cols, subarrays;
+
+    GetTranslationMethod( )->GetBitWidths( &rowBits, &colBits, &bankBits, 
+            &rankBits, &channelBits, &subarrayBits );
+    GetTranslationMethod( )->GetCount( &rows, &cols, &banks, 
+            &ranks, &channels, &subarrays );
+
+    /* Default to the end of physical memory so regions never alias it. */
+    if( !baseSet )
+    {
+        regionBase = 1ULL << (GetLowBits( ) + rowBits + colBits + bankBits 
+                              + rankBits + channelBits + subarrayBits);
+    }
+
+    /* The method's row count is the number of rows in one subarray. */
+    ncounter_t operandRows = (rows > reservedRows) ? rows - reservedRows : 0;
+
+    rowSize = 1ULL << (GetLowBits( ) + colBits);
+    rowsPerRegion = (regionRows != 0) ? regionRows : operandRows;
+    regionsPerSubarray = (rowsPerRegion != 0) ? operandRows / rowsPerRegion : 0;
+    subarraySlots = channels * ranks * banks * subarrays;
+
+    if( !printed )
+    {
+        std::cout << "PIMDecoder: " << GetRegionCount( ) << " regions of " 
+            << rowsPerRegion << " rows (" << rowSize << " bytes each) at 0x" 
+            << std::hex << regionBase << std::dec << ", " << reservedRows 
+            << " reserved rows per subarray." << std::endl;
+        printed = true;
+
+        if( allocateRegions > 0 )
+            PreallocateRegions( );
+    }
+}
+
+void PIMDecoder::PreallocateRegions( )
+{
+    uint64_t regionAddress;
+    uint64_t bank, rank, channel, subarray;
+    ncounter_t allocated = 0;
+
+    while( allocated < allocateRegions && AllocateRegion( &regionAddress ) )
+        allocated++;
+
+    GetRegionLocation( 0, &bank, &rank, &channel, &subarray );
+
+    std::cout << "PIMDecoder: Allocated " << allocated << " of " << allocateRegions 
+        << " regions. Channel " << channel << " rank " << rank << " bank " << bank 
+        << " subarray " << subarray << " has " 
+        << GetOperandRowsLeft( bank, rank, channel, subarray ) << " operand rows and " 
+        << reservedRows << " reserved compute rows left." << std::endl;
+}
+
+uint64_t PIMDecoder::GetRegionBase( )
+{
+    return regionBase;
+}
+
+ncounter_t PIMDecoder::GetRegionRows( )
+{
+    return rowsPerRegion;
+}
+
+ncounter_t PIMDecoder::GetReservedRows( )
+{
+    return reservedRows;
+}
+
+uint64_t PIMDecoder::GetRowSize( )
+{
+    return rowSize;
+}
+
+uint64_t PIMDecoder::GetRegionSize( )
+{
+    return rowSize * rowsPerRegion;
+}
+
+ncounter_t PIMDecoder::GetRegionCount( )
+{
+    return regionsPerSubarray * subarraySlots;
+}
+
+uint64_t PIMDecoder::GetRegionAddress( ncounter_t region, ncounter_t row, uint64_t byte )
+{
+    return regionBase + region * GetRegionSize( ) + row * rowSize + byte;
+}
+
+/*
+ *  Consecutive regions go to consecutive channels first, then banks, ranks
+ *  and subarrays, so independent regions can be operated on in parallel.
+ */
+void PIMDecoder::GetRegionLocation( ncounter_t region, uint64_t *bank, uint64_t *rank, 
+                                    uint64_t *channel, uint64_t *subarray )
+{
+    ncounter_t slot = region % subarraySlots;
+
+    *channel = slot % channels;
+    slot /= channels;
+    *bank = slot % banks;
+    slot /= banks;
+    *rank = slot % ranks;
+    slot /= ranks;
+    *subarray = slot;
+}
+
+ncounter_t PIMDecoder::GetSlot( const uint64_t& bank, const uint64_t& rank,
+                                const uint64_t& channel, const uint64_t& subarray )
+{
+    return ((subarray * ranks + rank) * banks + bank) * channels + channel;
+}
+
+bool PIMDecoder::AllocateRegion( uint64_t *regionAddress )
+{
+    uint64_t bank, rank, channel, subarray;
+
+    if( GetTranslationMethod( ) == NULL || allocatedRegions >= GetRegionCount( ) )
+        return false;
+
+    GetRegionLocation( allocatedRegions, &bank, &rank, &channel, &subarray );
+
+    ncounter_t slot = GetSlot( bank, rank, channel, subarray );
+    if( subarrayRegions.size( ) <= slot )
+        subarrayRegions.resize( slot + 1, 0 );
+    subarrayRegions[slot]++;
+
+    *regionAddress = GetRegionAddress( allocatedRegions, 0 );
+    allocatedRegions++;
+
+    return true;
+}
+
+/* Rows of the subarray that are not yet part of an allocated region. */
+ncounter_t PIMDecoder::GetOperandRowsLeft( const uint64_t& bank, const uint64_t& rank,
+                                           const uint64_t& channel, const uint64_t& subarray )
+{
+    ncounter_t slot = GetSlot( bank, rank, channel, subarray );
+    ncounter_t used = (slot < subarrayRegions.size( )) ? subarrayRegions[slot] : 0;
+
+    return (regionsPerSubarray - used) * rowsPerRegion;
+}
+
+void PIMDecoder::Translate( uint64_t address, uint64_t *row, uint64_t *col, 
+                            uint64_t *bank, uint64_t *rank, uint64_t *channel, uint64_t *subarray )
+{
+    if( GetTranslationMethod( ) == NULL || address < regionBase )
+    {
+        AddressTranslator::Translate( address, row, col, bank, rank, channel, subarray );
+        return;
+    }
+
+    uint64_t offset = address - regionBase;
+    uint64_t size = GetRegionSize( );
+    ncounter_t region = (size != 0) ? offset / size : 0;
+
+    if( size == 0 || region >= GetRegionCount( ) )
+    {
+        std::cerr << "PIMDecoder: Address 0x" << std::hex << address << std::dec
+            << " is beyond the last PIM region." << std::endl;
+        exit(1);
+    }
+
+    GetRegionLocation( region, bank, rank, channel, subarray );
+    *row = (region / subarraySlots) * rowsPerRegion + (offset % size) / rowSize;
+    *col = (offset % rowSize) >> GetLowBits( );
+}
@@ -0,0 +1,124 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+
+#ifndef __DECODERS_PIMDECODER_H__
+#define __DECODERS_PIMDECODER_H__
+
+#include "src/AddressTranslator.h"
+#include "src/Config.h"
+
+#include <vector>
+
+namespace NVM {
+
+/*
+ *  Places PIM operands so they are always in the same subarray.
+ *
+ *  Addresses at or above PIMRegionBase (by default, the end of physical 
+ *  memory) are region-relative: 
+ *
+ *      base + region * regionSize + row * rowSize + byte
+ *
+ *  Every row of a region is in the same channel, rank, bank and subarray,
+ *  so any two addresses of one region are valid PIM operands regardless of
+ *  the AddressMappingScheme. Consecutive regions are spread over channels,
+ *  banks, ranks and then subarrays. The last PIMReservedRows rows of each
+ *  subarray (by default, the Reserved*Rows compute rows) are never given to
+ *  regions.
+ *  Addresses below the base are translated normally.
+ *
+ *  PIMAllocateRegions allocates that many regions up front, in order, and
+ *  reports the operand rows left in the subarray of the first region.
+ */
+class PIMDecoder : public AddressTranslator
+{
+  public:
+    PIMDecoder( );
+    ~PIMDecoder( ) { }
+
+    void SetConfig( Config *config, bool createChildren = true );
+    void SetTranslationMethod( TranslationMethod *m );
+
+    void Translate( uint64_t address, uint64_t *row, uint64_t *col, 
+                    uint64_t *bank, uint64_t *rank, uint64_t *channel, uint64_t *subarray );
+    using AddressTranslator::Translate;
+
+    /* Region addresses are not described by the translation method. */
+    uint64_t GetTranslationLayout( ) { return 0; }
+
+    /* Region geometry. */
+    uint64_t GetRegionBase( );
+    ncounter_t GetRegionRows( );
+    ncounter_t GetReservedRows( );
+    uint64_t GetRowSize( );
+    uint64_t GetRegionSize( );
+    ncounter_t GetRegionCount( );
+    uint64_t GetRegionAddress( ncounter_t region, ncounter_t row, uint64_t byte = 0 );
+    void GetRegionLocation( ncounter_t region, uint64_t *bank, uint64_t *rank, 
+                            uint64_t *channel, uint64_t *subarray );
+
+    /* 
+     *  Allocator helper. AllocateRegion returns the address of the next free
+     *  region, or returns false if all regions are used.
+     */
+    bool AllocateRegion( uint64_t *regionAddress );
+    ncounter_t GetOperandRowsLeft( const uint64_t& bank, const uint64_t& rank,
+                                   const uint64_t& channel, const uint64_t& subarray );
+
+  private:
+    bool baseSet;
+    uint64_t regionBase;
+    ncounter_t regionRows;
+    ncounter_t reservedRows;
+
+    /* Computed from the config and translation method when either is set. */
+    uint64_t rowSize;
+    ncounter_t rowsPerRegion;
+    ncounter_t regionsPerSubarray;
+    ncounter_t subarraySlots;
+    uint64_t banks, ranks, channels;
+
+    ncounter_t allocateRegions;
+    ncounter_t allocatedRegions;
+    std::vector<ncounter_t> subarrayRegions;
+
+    void UpdateGeometry( );
+    void PreallocateRegions( );
+    ncounter_t GetSlot( const uint64_t& bank, const uint64_t& rank,
+                        const uint64_t& channel, const uint64_t& subarray );
+};
+
+};
+
+#endif
@@ -0,0 +1,205 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+
+#include "Decoders/XORDecoder/XORDecoder.h"
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+
+using namespace NVM;
+
+XORDecoder::XORDecoder( )
+{
+    hashChannel = false;
+    hashRank = false;
+    hashBank = true;
+
+    /* Negative means start at the subarray bits. */
+    rowBitOffset = -1;
+
+    verify = false;
+    verifiedTranslations = 0;
+    verifyMismatches = 0;
+}
+
+void XORDecoder::SetConfig( Config *config, bool /*createChildren*/ )
+{
+    /* Every level creates its own decoder; only warn once. */
+    static bool warned = false;
+
+    if( config->KeyExists( "XORHashFields" ) )
+    {
+        std::string fields = config->GetString( "XORHashFields" );
+        std::stringstream fieldStream( fields );
+        std::string field;
+
+        hashChannel = hashRank = hashBank = false;
+
+        while( std::getline( fieldStream, field, ':' ) )
+        {
+            if( field == "CH" ) 
+                hashChannel = true;
+            else if( field == "RK" ) 
+                hashRank = true;
+            else if( field == "BK" ) 
+                hashBank = true;
+            else if( !warned )
+                std::cout << "XORDecoder: Warning: Field `" << field 
+                    << "' in XORHashFields can not be hashed. Only CH, RK "
+                    << "and BK are supported." << std::endl;
+        }
+    }
+
+    if( config->KeyExists( "XORRowBitOffset" ) )
+    {
+        rowBitOffset = static_cast<int>( config->GetValue( "XORRowBitOffset" ) );
+
+        uint64_t subarrayRows = config->KeyExists( "MATHeight" ) 
+                              ? config->GetValue( "MATHeight" ) 
+                              : config->GetValue( "ROWS" );
+
+        if( !warned && rowBitOffset >= 0 && rowBitOffset < 64
+            && (1ULL << rowBitOffset) < subarrayRows )
+        {
+            std::cout << "XORDecoder: Warning: XORRowBitOffset " << rowBitOffset
+                << " hashes with row bits inside a subarray. Rows of the same"
+                << " subarray may be placed in different banks." << std::endl;
+        }
+    }
+
+    if( config->KeyExists( "XORVerify" ) )
+        verify = config->GetBool( "XORVerify" );
+
+    warned = true;
+}
+
+void XORDecoder::RegisterStats( )
+{
+    if( verify )
+    {
+        AddStat(verifiedTranslations);
+        AddStat(verifyMismatches);
+    }
+}
+
+/*
+ *  XOR each hashed field with its own slice of the subarray:row index,
+ *  starting at rowBitOffset for the bank, followed by the rank and channel.
+ */
+void XORDecoder::HashFields( const uint64_t& row, const uint64_t& subarray, 
+                             uint64_t *bank, uint64_t *rank, uint64_t *channel )
+{
+    unsigned int rowBits, colBits, bankBits, rankBits, channelBits, subarrayBits;
+    uint64_t rows, cols, banks, ranks, channels, subarrays;
+
+    GetTranslationMethod( )->GetBitWidths( &rowBits, &colBits, &bankBits, 
+            &rankBits, &channelBits, &subarrayBits );
+    GetTranslationMethod( )->GetCount( &rows, &cols, &banks, 
+            &ranks, &channels, &subarrays );
+
+    uint64_t globalRow = (subarray << rowBits) | row;
+    unsigned int sourceBits = rowBits + subarrayBits;
+    unsigned int shift = (rowBitOffset < 0) ? rowBits 
+                       : static_cast<unsigned int>( rowBitOffset );
+
+    /* 
+     *  Non power-of-two counts are skipped, since the hashed index could
+     *  exceed the count.
+     */
+    if( hashBank && bankBits > 0 && banks == (1ULL << bankBits) )
+    {
+        if( shift < sourceBits )
+            *bank ^= (globalRow >> shift) & (banks - 1);
+        shift += bankBits;
+    }
+
+    if( hashRank && rankBits > 0 && ranks == (1ULL << rankBits) )
+    {
+        if( shift < sourceBits )
+            *rank ^= (globalRow >> shift) & (ranks - 1);
+        shift += rankBits;
+    }
+
+    if( hashChannel && channelBits > 0 && channels == (1ULL << channelBits) )
+    {
+        if( shift < sourceBits )
+            *channel ^= (globalRow >> shift) & (channels - 1);
+    }
+}
+
+void XORDecoder::Translate( uint64_t address, uint64_t *row, uint64_t *col, 
+                            uint64_t *bank, uint64_t *rank, uint64_t *channel, uint64_t *subarray )
+{
+    AddressTranslator::Translate( address, row, col, bank, rank, channel, subarray );
+
+    if( GetTranslationMethod( ) == NULL )
+        return;
+
+    HashFields( *row, *subarray, bank, rank, channel );
+
+    /* The low bits are dropped by the translation and never come back. */
+    if( verify )
+    {
+        uint64_t lowMask = (1ULL << GetLowBits( )) - 1;
+
+        verifiedTranslations++;
+
+        if( ReverseTranslate( *row, *col, *bank, *rank, *channel, *subarray ) 
+            != (address & ~lowMask) )
+        {
+            verifyMismatches++;
+        }
+    }
+}
+
+uint64_t XORDecoder::ReverseTranslate( const uint64_t& row, const uint64_t& col, 
+                                       const uint64_t& bank, const uint64_t& rank, 
+                                       const uint64_t& channel, const uint64_t& subarray )
+{
+    uint64_t unhashedBank = bank;
+    uint64_t unhashedRank = rank;
+    uint64_t unhashedChannel = channel;
+
+    if( GetTranslationMethod( ) == NULL )
+    {
+        std::cerr << "XORDecoder: Translation method not specified!" << std::endl;
+        exit(1);
+    }
+
+    /* Row and subarray are not hashed, so XORing again undoes the hash. */
+    HashFields( row, subarray, &unhashedBank, &unhashedRank, &unhashedChannel );
+
+    return AddressTranslator::ReverseTranslate( row, col, unhashedBank, unhashedRank, 
+                                                unhashedChannel, subarray );
+}
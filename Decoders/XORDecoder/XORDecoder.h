@@ -0,0 +1,89 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+
+#ifndef __DECODERS_XORDECODER_H__
+#define __DECODERS_XORDECODER_H__
+
+#include "src/AddressTranslator.h"
+#include "src/Config.h"
+
+namespace NVM {
+
+/*
+ *  Permutation-based interleaving (Zhang et al., MICRO 2000). The channel,
+ *  rank and/or bank index of the regular mapping is XORed with bits of the
+ *  row index, so rows that would conflict in one bank are spread over
+ *  several banks. Row, column and subarray fields are never modified, so 
+ *  the hash is its own inverse given the (unchanged) row bits.
+ *
+ *  The row index used as hash source is subarray:row. By default hashing
+ *  starts at the subarray bits, so every row of a subarray moves to the
+ *  same bank and PIM operands that are co-located stay co-located.
+ */
+class XORDecoder : public AddressTranslator
+{
+  public:
+    XORDecoder( );
+    ~XORDecoder( ) { }
+
+    void SetConfig( Config *config, bool createChildren = true );
+
+    void Translate( uint64_t address, uint64_t *row, uint64_t *col, 
+                    uint64_t *bank, uint64_t *rank, uint64_t *channel, uint64_t *subarray );
+    uint64_t ReverseTranslate( const uint64_t& row, const uint64_t& col, 
+                               const uint64_t& bank, const uint64_t& rank, 
+                               const uint64_t& channel, const uint64_t& subarray );
+    using AddressTranslator::Translate;
+
+    /* The hash is not described by the translation method. */
+    uint64_t GetTranslationLayout( ) { return 0; }
+
+    void RegisterStats( );
+
+  private:
+    bool hashChannel, hashRank, hashBank;
+    int rowBitOffset;
+
+    /* Reverse translate every translation and count the mismatches. */
+    bool verify;
+    ncounter_t verifiedTranslations;
+    ncounter_t verifyMismatches;
+
+    void HashFields( const uint64_t& row, const uint64_t& subarray, 
+                     uint64_t *bank, uint64_t *rank, uint64_t *channel );
+};
+
+};
+
+#endif
@@ -242,6 +242,12 @@ bool FRFCFS_WQF::IsIssuable( NVMainRequest *request, FailReason * /*fail*/ )
     return rv;
 }
 
+/* Writes wait in the write queue until it is drained. */
+ncounter_t FRFCFS_WQF::GetTransactionQueueId( NVMainRequest *request )
+{
+    return ( request->type == WRITE ) ? writeQueueId : readQueueId;
+}
+
 bool FRFCFS_WQF::IssueCommand( NVMainRequest *request )
 {
     /* during a write drain, no write can enqueue */
@@ -254,13 +260,13 @@ bool FRFCFS_WQF::IssueCommand( NVMainRequest *request )
 
     if( request->type == READ )
     {
-        Enqueue( readQueueId, request );
+        Enqueue( GetTransactionQueueId( request ), request );
 
         mem_reads++;
     }
     else if( request->type == WRITE )
     {
-        Enqueue( writeQueueId, request );
+        Enqueue( GetTransactionQueueId( request ), request );
 
         mem_writes++;
     }
@@ -50,6 +50,7 @@ class FRFCFS_WQF : public MemoryController
     bool IssueCommand( NVMainRequest *request );
     bool IsIssuable( NVMainRequest *request, FailReason *fail = NULL );
     bool RequestComplete( NVMainRequest *request );
+    ncounter_t GetTransactionQueueId( NVMainRequest *request );
 
     void SetConfig( Config *conf, bool createChildren = true );
 
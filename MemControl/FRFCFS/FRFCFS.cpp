@@ -35,6 +35,7 @@
 
 #include "MemControl/FRFCFS/FRFCFS.h"
 #include "src/EventQueue.h"
+#include "src/Params.h"
 #include "include/NVMainRequest.h"
 #ifndef TRACE
 #ifdef GEM5
@@ -70,9 +71,16 @@ FRFCFS::FRFCFS( )
     mem_reads = 0;
     mem_writes = 0;
     mem_SRAs = 0;
-    mem_DRAs=0;
-    mem_TRAs = 0; 
+    mem_DRAs = 0;
+    mem_TRAs = 0;
+    mem_QRAs = 0;
+    mem_FRAs = 0;
     mem_oAs = 0;
+    for( ncounter_t i = 0; i < PIMPrimitives; i++ )
+        mem_pimActivates[i] = 0;
+    mem_BBOPs = 0;
+    mem_LWs = 0;
+    pim_batched = 0;
 
     rb_hits = 0;
     rb_miss = 0;
@@ -119,6 +127,35 @@ void FRFCFS::RegisterStats( )
     AddStat(mem_DRAs);
     AddStat(mem_TRAs);
     AddStat(mem_oAs);
+
+    if( p->pimCosts.IsEnabled( PIM_QRA ) )
+        AddStat(mem_QRAs);
+
+    if( p->pimCosts.IsEnabled( PIM_FRA ) )
+        AddStat(mem_FRAs);
+
+    /* 
+     *  mem_DRAs and mem_TRAs include the overlapped activates. The counts of
+     *  each primitive are mem_<stat name>, e.g., mem_triple_row_activates.
+     */
+    for( ncounter_t i = 0; i < PIMPrimitives; i++ )
+    {
+        PIMPrimitive primitive = static_cast<PIMPrimitive>(i);
+
+        if( p->pimCosts.IsEnabled( primitive ) )
+        {
+            std::string name = PIMCostModel::GetInfo( primitive ).statName;
+
+            AddNamedStat(mem_pimActivates[i], "mem_" + name);
+        }
+    }
+
+    if( p->ReservedRows( ) > 0 )
+        AddStat(mem_BBOPs);
+
+    if( p->LocalWrite )
+        AddStat(mem_LWs);
+
     AddStat(rb_hits);
     AddStat(rb_miss);
     AddStat(starvation_precharges);
@@ -130,6 +167,9 @@ void FRFCFS::RegisterStats( )
     AddStat(measuredTotalLatencies);
     AddStat(write_pauses);
 
+    if( p->PIMBatching )
+        AddStat(pim_batched);
+
     MemoryController::RegisterStats( );
 }
 
@@ -140,7 +180,7 @@ bool FRFCFS::IsIssuable( NVMainRequest * /*request*/, FailReason * /*fail*/ )
     /*
      *  Limit the number of commands in the queue. This will stall the caches/CPU.
      */ 
-    if( memQueue->size( ) >= queueSize )
+    if( memQueue->size( ) + bulkSequences.size( ) >= queueSize )
     {
         rv = false;
     }
@@ -161,6 +201,24 @@ bool FRFCFS::IssueCommand( NVMainRequest *req )
 
     req->arrivalCycle = GetEventQueue()->GetCurrentCycle();
 
+    /* Bulk bitwise operations are expanded by the sequencer instead. */
+    if( req->type == BBOP )
+    {
+        EnqueueBulkOperation( req );
+        mem_BBOPs++;
+
+        return true;
+    }
+
+    /* Packed elements are stored bit-serially by the transposition unit. */
+    if( IsTransposeWrite( req ) )
+    {
+        EnqueueTransposeWrite( req );
+        mem_writes++;
+
+        return true;
+    }
+
     /* 
      *  Just push back the read/write. It's easier to inject dram commands than break it up
      *  here and attempt to remove them later.
@@ -172,18 +230,24 @@ bool FRFCFS::IssueCommand( NVMainRequest *req )
     }else if( req->type == WRITE){
         mem_writes++;
     //Activation based PIM 
-    }else if(req->type == TRA){
-        mem_TRAs++;
-    }else if(req->type == OA){
-        mem_oAs++;
-    }else if(req->type == DRA){
-        mem_DRAs++;
-    }else if(req->type == SRA){
-        mem_SRAs++;
-    }else if(req->type == ODRA){
-        mem_DRAs++;
-    }else if(req->type == OTRA){
-        mem_TRAs++;
+    }else if(PIMCostModel::GetPrimitive( req->type ) != PIMPrimitives){
+        mem_pimActivates[PIMCostModel::GetPrimitive( req->type )]++;
+
+        if(req->type == OA){
+            mem_oAs++;
+        }else if(req->type == SRA){
+            mem_SRAs++;
+        }else if(req->type == DRA || req->type == ODRA){
+            mem_DRAs++;
+        }else if(req->type == TRA || req->type == OTRA){
+            mem_TRAs++;
+        }else if(req->type == QRA){
+            mem_QRAs++;
+        }else if(req->type == FRA){
+            mem_FRAs++;
+        }
+    }else if(req->type == LW){
+        mem_LWs++;
     }
     /*
      *  Return whether the request could be queued. Return false if the queue is full.
@@ -282,14 +346,27 @@ void FRFCFS::Cycle( ncycle_t steps )
     /* Issue the commands for this transaction. */
     if( nextRequest != NULL )
     {   //handle PUM commands 
-        if (nextRequest->type == SRA || nextRequest->type == DRA 
-            || nextRequest->type == TRA || nextRequest->type == OA 
-            || nextRequest->type == ODRA || nextRequest->type == OTRA)
+        if (PIMCostModel::IsMultiRowActivate( nextRequest->type ) 
+            || PIMCostModel::IsOverlappedActivate( nextRequest->type ))
+        {
             IssuePIMCommands( nextRequest );
+
+            /* Start the same operation on other banks/subarrays as well. */
+            if( p->PIMBatching )
+                pim_batched += IssuePIMBatch( *memQueue, nextRequest );
+        }
+        else if( nextRequest->type == ROWCLONE_PSM || nextRequest->type == ROWCLONE_LISA )
+            IssueRowCloneCommands( nextRequest );
+        else if( nextRequest->type == LW )
+            IssueLocalWriteCommands( nextRequest );
         else
             IssueMemoryCommands( nextRequest );
     }
 
+    /* Start the rows of any bulk bitwise operations. */
+    if( !bulkSequences.empty( ) )
+        CycleBulkSequencer( );
+
     /* Issue any commands in the command queues. */
     CycleCommandQueues( );
 
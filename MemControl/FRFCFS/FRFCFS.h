@@ -67,11 +67,14 @@ class FRFCFS : public MemoryController
     /* Stats */
     uint64_t measuredLatencies, measuredQueueLatencies, measuredTotalLatencies;
     double averageLatency, averageQueueLatency, averageTotalLatency;
-    uint64_t mem_reads, mem_writes, mem_SRAs, mem_DRAs, mem_TRAs, mem_oAs;
+    uint64_t mem_reads, mem_writes, mem_BBOPs, mem_LWs;
+    uint64_t mem_SRAs, mem_DRAs, mem_TRAs, mem_QRAs, mem_FRAs, mem_oAs;
+    uint64_t mem_pimActivates[PIMPrimitives];
     uint64_t rb_hits;
     uint64_t rb_miss;
     uint64_t starvation_precharges;
     uint64_t write_pauses;
+    uint64_t pim_batched;
 };
 
 };
@@ -287,8 +287,8 @@ void RTM::Cycle( ncycle_t steps )
     /* Issue the commands for this transaction. */
     if( nextRequest != NULL )
     {
-        if (nextRequest->type == TRA || nextRequest->type == OA || nextRequest->type == DRA ||
-            nextRequest->type == SRA || nextRequest->type == ODRA || nextRequest->type == OTRA)
+        if (PIMCostModel::IsMultiRowActivate( nextRequest->type ) 
+            || PIMCostModel::IsOverlappedActivate( nextRequest->type ))
             IssuePIMCommands( nextRequest );
         else 
             IssueMemoryCommands( nextRequest );
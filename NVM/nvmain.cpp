@@ -39,6 +39,7 @@
 #include "src/Interconnect.h"
 #include "src/SimInterface.h"
 #include "src/EventQueue.h"
+#include "src/PIMCostModel.h"
 #include "Interconnect/InterconnectFactory.h"
 #include "MemControl/MemoryControllerFactory.h"
 #include "traceWriter/TraceWriterFactory.h"
@@ -49,6 +50,7 @@
 #include "Prefetchers/PrefetcherFactory.h"
 
 #include <sstream>
+#include <algorithm>
 #include <cassert>
 
 using namespace NVM;
@@ -69,6 +71,19 @@ NVMain::NVMain( )
     prefetcher = NULL;
     successfulPrefetches = 0;
     unsuccessfulPrefetches = 0;
+
+    parallelChannels = false;
+    deferCompletions = false;
+    channelEventQueues = NULL;
+
+    linked = false;
+
+    fastForward = false;
+    fastForwardTolerance = 1e-6;
+    fastForwardPeriod = 0;
+    fastForwards = 0;
+    fastForwardCycles = 0;
+    fastForwardError = 0.0;
 }
 
 NVMain::~NVMain( )
@@ -87,9 +102,22 @@ NVMain::~NVMain( )
         delete [] memoryControllers;
     }
 
+    if( channelEventQueues )
+    {
+        for( unsigned int i = 0; i < numChannels; i++ )
+        {
+            delete channelEventQueues[i];
+        }
+
+        delete [] channelEventQueues;
+    }
+
     if( translator )
         delete translator;
 
+    if( preTracer )
+        delete preTracer;
+
     if( channelConfig )
     {
         for( unsigned int i = 0; i < numChannels; i++ )
@@ -157,12 +185,42 @@ void NVMain::SetConfig( Config *conf, std::string memoryName, bool createChildre
                     );
         method->SetCount( rows, cols, banks, ranks, channels, subarrays );
         method->SetAddressMappingScheme( p->AddressMappingScheme );
+
+        /* Reserved compute rows are not part of the normal address space. */
+        if( p->ReservedRows( ) > 0 )
+            method->SetDataRows( rows - p->ReservedRows( ) );
+
         translator->SetConfig( config, createChildren );
         translator->SetTranslationMethod( method );
         translator->SetDefaultField( CHANNEL_FIELD );
 
         SetDecoder( translator );
 
+        /* 
+         *  Optionally check the precomputed address layout against the
+         *  generic divide/modulo translation on VerifyTranslation lines
+         *  spread over the memory.
+         */
+        if( config->KeyExists( "VerifyTranslation" ) )
+        {
+            AddressTranslator checker;
+            ncounter_t count = config->GetValueUL( "VerifyTranslation" );
+            uint64_t lines = static_cast<uint64_t>( rows - p->ReservedRows( ) ) 
+                           * cols * banks * ranks * channels * subarrays;
+            uint64_t step = (count > 0) ? lines / count : 0;
+
+            /* An odd number of lines between addresses reaches every column. */
+            if( step > 1 && step % 2 == 0 )
+                step--;
+
+            checker.SetTranslationMethod( method );
+
+            ncounter_t mismatches = checker.VerifyTranslations( step * 64, count );
+
+            std::cout << "NVMain: Verified " << count << " address translations, " 
+                      << mismatches << " mismatches." << std::endl;
+        }
+
         memoryControllers = new MemoryController* [channels];
         channelConfig = new Config* [channels];
         for( int i = 0; i < channels; i++ )
@@ -190,6 +248,19 @@ void NVMain::SetConfig( Config *conf, std::string memoryName, bool createChildre
 
                 channelConfig[i]->Read( channelConfigFile );
             }
+        }
+
+        parallelChannels = CanSimulateChannelsInParallel( channels );
+
+        if( parallelChannels )
+        {
+            channelEventQueues = new EventQueue* [channels];
+            deferredCompletions.resize( channels );
+        }
+
+        for( int i = 0; i < channels; i++ )
+        {
+            std::stringstream confString;
 
             /* Initialize memory controller */
             memoryControllers[i] = 
@@ -206,6 +277,15 @@ void NVMain::SetConfig( Config *conf, std::string memoryName, bool createChildre
             AddChild( memoryControllers[i] );
             memoryControllers[i]->SetParent( this );
 
+            /* Each channel gets its own queue, inherited by its children. */
+            if( parallelChannels )
+            {
+                channelEventQueues[i] = new EventQueue( );
+                channelEventQueues[i]->SetConfig( channelConfig[i] );
+                GetGlobalEventQueue( )->AddChannelQueue( this, channelEventQueues[i] );
+                memoryControllers[i]->SetEventQueue( channelEventQueues[i] );
+            }
+
             /* Set Config recursively. */
             memoryControllers[i]->SetConfig( channelConfig[i], createChildren );
 
@@ -222,6 +302,17 @@ void NVMain::SetConfig( Config *conf, std::string memoryName, bool createChildre
     }
 
     numChannels = static_cast<unsigned int>(p->CHANNELS);
+
+    /* A memory behind a DRAM cache is simulated as a separate system. */
+    if( GetParent( ) != NULL && NVMTypeMatches(MemoryController) 
+        && GetGlobalEventQueue( ) != NULL
+        && GetGlobalEventQueue( )->GetSystemLookahead( ) > 0 )
+    {
+        linked = true;
+        linkIssuable.assign( 2 * numChannels, true );
+    }
+
+    fastForward = CanFastForward( p->CHANNELS );
     
     std::string pretraceFile;
 
@@ -254,13 +345,350 @@ void NVMain::SetConfig( Config *conf, std::string memoryName, bool createChildre
     RegisterStats( );
 }
 
+bool NVMain::CanSimulateChannelsInParallel( int channels )
+{
+    std::string reason = "";
+
+    if( !config->KeyExists( "ParallelChannels" ) 
+        || config->GetString( "ParallelChannels" ) != "true" )
+    {
+        return false;
+    }
+
+    /*
+     *  Channels may only be simulated in parallel if nothing but the request
+     *  completions crosses between them. Otherwise results would depend on
+     *  the thread schedule.
+     */
+    if( channels < 2 )
+        reason = "only one channel";
+    else if( GetGlobalEventQueue( ) == NULL )
+        reason = "no global event queue";
+    else if( !GetHooks( NVMHOOK_PREISSUE ).empty( ) 
+             || !GetHooks( NVMHOOK_POSTISSUE ).empty( ) )
+        reason = "hooks are shared between channels";
+    else if( p->MemoryPrefetcher != "none" )
+        reason = "prefetches cross channels";
+    else if( NVMTypeMatches(MemoryController) )
+        reason = "this memory is behind a DRAM cache";
+
+    for( int i = 0; i < channels && reason == ""; i++ )
+    {
+        std::string memCtl = channelConfig[i]->GetString( "MEM_CTL" );
+
+        if( memCtl == "DRC" || memCtl == "LH_Cache" || memCtl == "LO_Cache" 
+            || memCtl == "PredictorDRC" )
+        {
+            reason = "DRAM caches share the main memory";
+        }
+        else if( channelConfig[i]->KeyExists( "EnduranceModel" ) 
+                 && channelConfig[i]->GetString( "EnduranceModel" ) != "NullModel"
+                 && channelConfig[i]->KeyExists( "EnduranceDist" )
+                 && channelConfig[i]->GetString( "EnduranceDist" ) == "Normal" )
+        {
+            reason = "the normal endurance distribution uses rand()";
+        }
+    }
+
+    if( reason != "" )
+    {
+        std::cout << "NVMain: Simulating channels serially because " 
+                  << reason << "." << std::endl;
+        return false;
+    }
+
+    std::cout << "NVMain: Simulating " << channels << " channels in parallel." 
+              << std::endl;
+
+    return true;
+}
+
+bool NVMain::CanFastForward( int channels )
+{
+    std::string reason = "";
+
+    if( !config->KeyExists( "IdleFastForward" ) 
+        || config->GetString( "IdleFastForward" ) != "true" )
+    {
+        return false;
+    }
+
+    if( config->KeyExists( "IdleFastForwardTolerance" ) )
+        fastForwardTolerance = config->GetEnergy( "IdleFastForwardTolerance" );
+
+    /*
+     *  Only the event queue of this memory is shifted, so everything that
+     *  may be waiting for an event must live in it.
+     */
+    if( GetGlobalEventQueue( ) == NULL )
+        reason = "no global event queue";
+    else if( memoryControllers == NULL || channelConfig == NULL )
+        reason = "no memory controllers were created";
+    else if( parallelChannels )
+        reason = "channels are simulated in parallel";
+    else if( linked || NVMTypeMatches(MemoryController) )
+        reason = "this memory is behind a DRAM cache";
+
+    for( int i = 0; i < channels && reason == ""; i++ )
+    {
+        std::string memCtl = channelConfig[i]->GetString( "MEM_CTL" );
+
+        if( memCtl == "DRC" || memCtl == "LH_Cache" || memCtl == "LO_Cache" 
+            || memCtl == "PredictorDRC" )
+        {
+            reason = "DRAM caches keep requests outside the controller queues";
+        }
+    }
+
+    if( reason == "" )
+    {
+        fastForwardPeriod = memoryControllers[0]->GetRefreshPeriod( );
+
+        if( fastForwardPeriod == 0 )
+            reason = "idle periods without refresh are skipped anyway";
+    }
+
+    if( reason != "" )
+    {
+        std::cout << "NVMain: Not fast forwarding idle periods because " 
+                  << reason << "." << std::endl;
+        return false;
+    }
+
+    std::cout << "NVMain: Fast forwarding idle periods with a tolerance of " 
+              << fastForwardTolerance << "." << std::endl;
+
+    return true;
+}
+
+/*
+ *  Returns the refresh period shared by all channels if none of them has
+ *  queued requests, otherwise 0.
+ */
+ncycle_t NVMain::GetIdlePeriod( )
+{
+    ncycle_t period = 0;
+
+    if( !pendingMemoryRequests.empty( ) )
+        return 0;
+
+    for( unsigned int i = 0; i < numChannels; i++ )
+    {
+        ncycle_t channelPeriod = memoryControllers[i]->GetRefreshPeriod( );
+
+        if( !memoryControllers[i]->Idle( ) )
+            return 0;
+
+        if( channelPeriod == 0 )
+            continue;
+
+        if( period != 0 && channelPeriod != period )
+            return 0;
+
+        period = channelPeriod;
+    }
+
+    return period;
+}
+
+/*
+ *  Skips over an idle period of the event queue up to the target cycle.
+ *  Two refresh periods are simulated first and must change every stat the
+ *  same way. Whole periods are then skipped by shifting the event queue 
+ *  and adding the change of one period to the stats for each of them. The
+ *  largest relative difference between the two periods is reported as the
+ *  fastForwardError stat. Returns true if the event queue was advanced.
+ */
+bool NVMain::FastForward( ncycle_t target )
+{
+    if( !fastForward )
+        return false;
+
+    EventQueue *queue = GetEventQueue( );
+
+    /* 
+     *  Leave at least one period after the skip to simulate stepwise. While
+     *  busy there is an event almost every cycle, so don't check queues then.
+     */
+    if( target < queue->GetCurrentCycle( ) + 4 * fastForwardPeriod 
+        || queue->GetNextEvent( ) <= queue->GetCurrentCycle( ) + 1 )
+    {
+        return false;
+    }
+
+    ncycle_t period = GetIdlePeriod( );
+
+    if( period != fastForwardPeriod )
+        return false;
+
+    std::vector<double> start, middle, end;
+    double error = 0.0;
+
+    GetStats( )->Snapshot( start );
+    queue->Loop( period );
+    GetStats( )->Snapshot( middle );
+    queue->Loop( period );
+    GetStats( )->Snapshot( end );
+
+    if( !GetStats( )->CompareIntervals( start, middle, end, error )
+        || error > fastForwardTolerance )
+    {
+        return true;
+    }
+
+    /* 
+     *  A refresh may have just been issued. Let it finish so that no timing
+     *  constraint refers to a cycle before the skip.
+     */
+    ncycle_t settleCycle = queue->GetCurrentCycle( ) + period;
+
+    while( GetIdlePeriod( ) != period && queue->GetNextEvent( ) <= settleCycle )
+        queue->Loop( queue->GetNextEvent( ) - queue->GetCurrentCycle( ) );
+
+    ncounter_t periods = (target - queue->GetCurrentCycle( )) / period - 1;
+
+    /* Skip whole rotations of the controllers' round-robin schedulers. */
+    ncounter_t rotation = 1;
+
+    for( unsigned int i = 0; i < numChannels; i++ )
+    {
+        ncounter_t length = memoryControllers[i]->GetRoundRobinLength( );
+
+        if( rotation % length != 0 )
+            rotation *= length;
+    }
+
+    periods -= periods % rotation;
+
+    if( GetIdlePeriod( ) != period || periods == 0 )
+        return true;
+
+    ncycle_t cycles = periods * period;
+
+    GetStats( )->Extrapolate( middle, end, periods );
+
+    queue->Shift( cycles );
+
+    for( unsigned int i = 0; i < numChannels; i++ )
+        memoryControllers[i]->FastForward( cycles );
+
+    fastForwards++;
+    fastForwardCycles += cycles;
+    fastForwardError = std::max( fastForwardError, error );
+
+    return true;
+}
+
+void NVMain::DeferCompletions( bool defer )
+{
+    if( !parallelChannels )
+        return;
+
+    deferCompletions = defer;
+
+    if( defer )
+        return;
+
+    /* 
+     *  Merge the completions of each channel by cycle. Ties are broken by
+     *  channel so the order does not depend on the thread schedule.
+     */
+    std::vector<std::pair<ncycle_t, NVMainRequest *> > completions;
+
+    for( size_t i = 0; i < deferredCompletions.size( ); i++ )
+    {
+        completions.insert( completions.end( ), deferredCompletions[i].begin( ),
+                            deferredCompletions[i].end( ) );
+        deferredCompletions[i].clear( );
+    }
+
+    std::stable_sort( completions.begin( ), completions.end( ), CompletionBefore );
+
+    for( size_t i = 0; i < completions.size( ); i++ )
+    {
+        RequestComplete( completions[i].second );
+    }
+}
+
+bool NVMain::CompletionBefore( const std::pair<ncycle_t, NVMainRequest *>& a,
+                               const std::pair<ncycle_t, NVMainRequest *>& b )
+{
+    return a.first < b.first;
+}
+
 bool NVMain::IsIssuable( NVMainRequest *request, FailReason *reason )
+{
+    if( linked )
+        return IsLinkIssuable( request );
+
+    return IsChannelIssuable( request, reason );
+}
+
+/*
+ *  Another system runs its window alongside this one, so it sees whether the
+ *  channels were issuable at the start of the window. Requests sent while a
+ *  channel is full wait in pendingMemoryRequests as in serial simulation.
+ */
+bool NVMain::IsLinkIssuable( NVMainRequest *request )
+{
+    uint64_t channel, rank, bank, row, col, subarray;
+    ncounter_t write = (request->type == WRITE) ? 1 : 0;
+
+    if( request->type == BBOP )
+    {
+        for( unsigned int i = 0; i < numChannels; i++ )
+        {
+            if( !linkIssuable[2 * i + write] )
+                return false;
+        }
+
+        return true;
+    }
+
+    GetDecoder( )->Translate( request->address.GetPhysicalAddress( ), 
+                           &row, &col, &rank, &bank, &channel, &subarray );
+
+    return linkIssuable[2 * channel + write];
+}
+
+/* Called between windows, when no system is running. */
+void NVMain::UpdateLinkIssuable( )
+{
+    NVMainRequest probe;
+
+    for( unsigned int i = 0; i < numChannels; i++ )
+    {
+        probe.address.SetTranslatedAddress( 0, 0, 0, 0, i, 0 );
+
+        probe.type = READ;
+        linkIssuable[2 * i] = pendingMemoryRequests.empty( )
+                              && memoryControllers[i]->IsIssuable( &probe, NULL );
+
+        probe.type = WRITE;
+        linkIssuable[2 * i + 1] = pendingMemoryRequests.empty( )
+                                  && memoryControllers[i]->IsIssuable( &probe, NULL );
+    }
+}
+
+bool NVMain::IsChannelIssuable( NVMainRequest *request, FailReason *reason )
 {
     uint64_t channel, rank, bank, row, col, subarray;
     bool rv;
 
     assert( request != NULL );
 
+    /* Bulk bitwise operations are sent to every channel. */
+    if( request->type == BBOP )
+    {
+        for( unsigned int i = 0; i < numChannels; i++ )
+        {
+            if( !memoryControllers[i]->IsIssuable( request, reason ) )
+                return false;
+        }
+
+        return true;
+    }
+
     GetDecoder( )->Translate( request->address.GetPhysicalAddress( ), 
                            &row, &col, &rank, &bank, &channel, &subarray );
 
@@ -358,13 +786,33 @@ void NVMain::PrintPreTrace( NVMainRequest *request )
     {
         TraceLine tl;
 
-        tl.SetLine( request->address,
-                    request->type,
-                    GetEventQueue( )->GetCurrentCycle( ),
-                    request->data,
-                    request->oldData,
-                    request->threadId 
-                  );
+        if( request->type == BBOP )
+        {
+            tl.SetLine( request->address,
+                        request->address2,
+                        request->type,
+                        GetEventQueue( )->GetCurrentCycle( ),
+                        request->data,
+                        request->oldData,
+                        request->threadId 
+                      );
+            tl.SetBulkOperation( request->address3, request->bulkOp,
+                                 request->bulkSize, request->bulkWidth );
+        }
+        else
+        {
+            tl.SetLine( request->address,
+                        request->type,
+                        GetEventQueue( )->GetCurrentCycle( ),
+                        request->data,
+                        request->oldData,
+                        request->threadId 
+                      );
+
+            /* Pinatubo activates sense an operation over a row count of their own. */
+            if( PIMCostModel::IsMultiRowActivate( request->type ) )
+                tl.SetMultiRowActivate( request->bulkOp, request->activateRows );
+        }
 
         preTracer->SetNextAccess( &tl );
     }
@@ -372,7 +820,61 @@ void NVMain::PrintPreTrace( NVMainRequest *request )
 
 bool NVMain::IssueCommand( NVMainRequest *request )
 {
-    ncounter_t channel, rank, bank, row, col, subarray;
+    if( linked )
+    {
+        SendOverLink( request );
+        return true;
+    }
+
+    return IssueToChannel( request );
+}
+
+void NVMain::SendOverLink( NVMainRequest *request )
+{
+    EventQueue *parentQueue = GetParent( )->GetTrampoline( )->GetEventQueue( );
+    ncycle_t arrival = GetGlobalEventQueue( )->GetArrivalCycle( parentQueue, GetEventQueue( ) );
+
+    linkRequests.push_back( std::make_pair( arrival, request ) );
+}
+
+void NVMain::DeliverLinkRequests( )
+{
+    if( !linked )
+        return;
+
+    /* Called between windows, so both systems are stopped. */
+    EventQueue *parentQueue = GetParent( )->GetTrampoline( )->GetEventQueue( );
+
+    for( size_t i = 0; i < linkRequests.size( ); i++ )
+    {
+        GetEventQueue( )->InsertCallback( this, (CallbackPtr)&NVMain::LinkRequestCallback,
+                                          linkRequests[i].first, linkRequests[i].second );
+    }
+
+    for( size_t i = 0; i < linkResponses.size( ); i++ )
+    {
+        parentQueue->InsertEvent( EventResponse, GetParent( ), linkResponses[i].second,
+                                  linkResponses[i].first );
+    }
+
+    linkRequests.clear( );
+    linkResponses.clear( );
+
+    UpdateLinkIssuable( );
+}
+
+void NVMain::LinkRequestCallback( void *data )
+{
+    NVMainRequest *request = static_cast<NVMainRequest *>( data );
+
+    if( IsChannelIssuable( request, NULL ) )
+        IssueToChannel( request );
+    else
+        pendingMemoryRequests.push( request );
+}
+
+bool NVMain::IssueToChannel( NVMainRequest *request )
+{
     bool mc_rv;
 
     if( !config )
@@ -381,10 +883,11 @@ bool NVMain::IssueCommand( NVMainRequest *request )
         return false;
     }
 
-    /* Translate the address, then copy to the address struct, and copy to request. */
-    GetDecoder( )->Translate( request->address.GetPhysicalAddress( ), 
-                           &row, &col, &bank, &rank, &channel, &subarray );
-    request->address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
+    if( request->type == BBOP )
+        return IssueBulkOperation( request );
+
+    /* Translate the address into the request, unless that was done already. */
+    GetDecoder( )->TranslateAddress( request->address );
     request->bulkCmd = CMD_NOP;
 
     /* Check for any successful prefetches. */
@@ -396,7 +899,8 @@ bool NVMain::IssueCommand( NVMainRequest *request )
         return true;
     }
 
-    assert( GetChild( request )->GetTrampoline( ) == memoryControllers[channel] );
+    assert( GetChild( request )->GetTrampoline( ) 
+            == memoryControllers[request->address.GetChannel( )] );
     mc_rv = GetChild( request )->IssueCommand( request );
     if( mc_rv == true )
     {
@@ -410,13 +914,16 @@ bool NVMain::IssueCommand( NVMainRequest *request )
         {
             totalWriteRequests++;
         }
-        else if(request->type == TRA || request->type == OA || request->type == DRA || request->type == SRA 
-                || request->type == ODRA || request->type == OTRA)
+        else if(PIMCostModel::IsMultiRowActivate( request->type ) 
+                || PIMCostModel::IsOverlappedActivate( request->type )
+                || request->type == ROWCLONE_PSM || request->type == ROWCLONE_LISA)
         {
             /* Translate address 2 for pim commands */
-            GetDecoder( )->Translate( request->address2.GetPhysicalAddress( ), 
-                                &row, &col, &bank, &rank, &channel, &subarray );
-            request->address2.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
+            GetDecoder( )->TranslateAddress( request->address2 );
+            totalPIMRequests++;
+        }
+        else if( request->type == LW )
+        {
             totalPIMRequests++;
         }
         else
@@ -430,9 +937,72 @@ bool NVMain::IssueCommand( NVMainRequest *request )
     return mc_rv;
 }
 
+/*
+ *  The rows of a bulk bitwise operation may be spread over all channels, so
+ *  each memory controller gets a copy and sequences the rows it owns. The
+ *  operation completes once every channel is done.
+ */
+bool NVMain::IssueBulkOperation( NVMainRequest *request )
+{
+    if( !IsChannelIssuable( request, NULL ) )
+        return false;
+
+    bulkChildrenLeft[request] = numChannels;
+
+    for( unsigned int i = 0; i < numChannels; i++ )
+    {
+        NVMainRequest *channelRequest = new NVMainRequest( );
+        ncounter_t row, col, bank, rank, subarray;
+
+        *channelRequest = *request;
+        channelRequest->owner = this;
+
+        /* Completions are deferred per channel, so record the channel here. */
+        GetDecoder( )->TranslateAddress( channelRequest->address );
+        channelRequest->address.GetTranslatedAddress( &row, &col, &bank, &rank, NULL, &subarray );
+        channelRequest->address.SetTranslatedAddress( row, col, bank, rank, i, subarray );
+
+        bulkParents[channelRequest] = request;
+
+        if( !memoryControllers[i]->IssueCommand( channelRequest ) )
+        {
+            std::cerr << "NVMain: Channel " << i << " rejected a bulk bitwise "
+                      << "operation." << std::endl;
+            exit(1);
+        }
+    }
+    totalPIMRequests++;
+
+    PrintPreTrace( request );
+
+    return true;
+}
+
+bool NVMain::BulkOperationComplete( NVMainRequest *request )
+{
+    std::map<NVMainRequest *, NVMainRequest *>::iterator it = bulkParents.find( request );
+
+    assert( it != bulkParents.end( ) );
+
+    NVMainRequest *parentRequest = it->second;
+
+    bulkParents.erase( it );
+    delete request;
+
+    if( --bulkChildrenLeft[parentRequest] != 0 )
+        return true;
+
+    bulkChildrenLeft.erase( parentRequest );
+
+    parentRequest->status = MEM_REQUEST_COMPLETE;
+    parentRequest->completionCycle = GetEventQueue( )->GetCurrentCycle( );
+
+    return RequestComplete( parentRequest );
+}
+
 bool NVMain::IssueAtomic( NVMainRequest *request )
 {
-    ncounter_t channel, rank, bank, row, col, subarray;
+    ncounter_t channel;
     bool mc_rv;
 
     if( !config )
@@ -441,10 +1011,12 @@ bool NVMain::IssueAtomic( NVMainRequest *request )
         return false;
     }
 
-    /* Translate the address, then copy to the address struct, and copy to request. */
-    GetDecoder( )->Translate( request->address.GetPhysicalAddress( ), 
-                           &row, &col, &bank, &rank, &channel, &subarray );
-    request->address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
+    if( request->type == BBOP )
+        return IssueBulkOperation( request );
+
+    /* Translate the address into the request, unless that was done already. */
+    GetDecoder( )->TranslateAddress( request->address );
+    channel = request->address.GetChannel( );
     request->bulkCmd = CMD_NOP;
 
     /* Check for any successful prefetches. */
@@ -466,8 +1038,10 @@ bool NVMain::IssueAtomic( NVMainRequest *request )
         {
             totalWriteRequests++;
         }
-        else if(request->type == TRA || request->type == OA || request->type == DRA || request->type == SRA 
-                || request->type == ODRA || request->type == OTRA)
+        else if(PIMCostModel::IsMultiRowActivate( request->type ) 
+                || PIMCostModel::IsOverlappedActivate( request->type )
+                || request->type == ROWCLONE_PSM || request->type == ROWCLONE_LISA
+                || request->type == LW)
         {
             totalPIMRequests++;
         }
@@ -485,7 +1059,22 @@ bool NVMain::RequestComplete( NVMainRequest *request )
 {
     bool rv = false;
 
-    if( request->owner == this )
+    /* Called from a worker thread, see GlobalEventQueue::CycleParallel. */
+    if( deferCompletions && (request->owner != this || request->type == BBOP) )
+    {
+        ncounter_t channel = request->address.GetChannel( );
+
+        deferredCompletions[channel].push_back( std::make_pair( 
+            memoryControllers[channel]->GetEventQueue( )->GetCurrentCycle( ), request ) );
+
+        return true;
+    }
+
+    if( request->owner == this && request->type == BBOP )
+    {
+        return BulkOperationComplete( request );
+    }
+    else if( request->owner == this )
     {
         if( request->isPrefetch )
         {
@@ -514,6 +1103,14 @@ bool NVMain::RequestComplete( NVMainRequest *request )
             rv = true;
         }
     }
+    else if( linked )
+    {
+        EventQueue *parentQueue = GetParent( )->GetTrampoline( )->GetEventQueue( );
+        ncycle_t arrival = GetGlobalEventQueue( )->GetArrivalCycle( GetEventQueue( ), parentQueue );
+
+        linkResponses.push_back( std::make_pair( arrival, request ) );
+        rv = true;
+    }
     else
     {
         rv = GetParent( )->RequestComplete( request );
@@ -524,8 +1121,8 @@ bool NVMain::RequestComplete( NVMainRequest *request )
      * be issuable at that time. Try to issue these here. */
     if( !pendingMemoryRequests.empty() ){
        NVMainRequest *staleMemReq = pendingMemoryRequests.front();
-        if( IsIssuable(staleMemReq, NULL) ) {
-            IssueCommand( staleMemReq );
+        if( IsChannelIssuable(staleMemReq, NULL) ) {
+            IssueToChannel( staleMemReq );
             pendingMemoryRequests.pop();
         }
     }
@@ -544,6 +1141,13 @@ void NVMain::RegisterStats( )
     AddStat(totalPIMRequests);
     AddStat(successfulPrefetches);
     AddStat(unsuccessfulPrefetches);
+
+    if( fastForward )
+    {
+        AddStat(fastForwards);
+        AddStat(fastForwardCycles);
+        AddStat(fastForwardError);
+    }
 }
 
 void NVMain::CalculateStats( )
@@ -554,6 +1158,12 @@ void NVMain::CalculateStats( )
 
 void NVMain::EnqueuePendingMemoryRequests( NVMainRequest *req )
 {
+    if( linked )
+    {
+        SendOverLink( req );
+        return;
+    }
+
     pendingMemoryRequests.push(req);
 }
 
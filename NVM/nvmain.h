@@ -43,6 +43,7 @@
 #include "include/NVMainRequest.h"
 #include "traceWriter/GenericTraceWriter.h"
 #include <queue>
+#include <map>
 
 namespace NVM {
 
@@ -53,6 +54,7 @@ class Interconnect;
 class AddressTranslator;
 class SimInterface;
 class NVMainRequest;
+class EventQueue;
 
 class NVMain : public NVMObject
 {
@@ -80,6 +82,12 @@ class NVMain : public NVMObject
 
     void EnqueuePendingMemoryRequests( NVMainRequest *request );
 
+    bool FastForward( ncycle_t target );
+
+    void DeferCompletions( bool defer );
+    void DeliverLinkRequests( );
+    void LinkRequestCallback( void *data );
+
   private:
     Config *config;
     Config **channelConfig;
@@ -103,6 +111,44 @@ class NVMain : public NVMObject
     std::ofstream pretraceOutput;
     GenericTraceWriter *preTracer;
 
+    bool parallelChannels;
+    bool deferCompletions;
+    EventQueue **channelEventQueues;
+    std::vector<std::vector<std::pair<ncycle_t, NVMainRequest *> > > deferredCompletions;
+
+    bool CanSimulateChannelsInParallel( int channels );
+
+    /* Idle periods with only refreshes pending are skipped analytically. */
+    bool fastForward;
+    double fastForwardTolerance;
+    ncycle_t fastForwardPeriod;
+    ncounter_t fastForwards;
+    ncycle_t fastForwardCycles;
+    double fastForwardError;
+
+    bool CanFastForward( int channels );
+    ncycle_t GetIdlePeriod( );
+
+    /* Requests to and responses from a memory simulated as its own system. */
+    bool linked;
+    std::vector<std::pair<ncycle_t, NVMainRequest *> > linkRequests;
+    std::vector<std::pair<ncycle_t, NVMainRequest *> > linkResponses;
+    std::vector<bool> linkIssuable;
+
+    /* Bulk bitwise operations are split into one request per channel. */
+    std::map<NVMainRequest *, NVMainRequest *> bulkParents;
+    std::map<NVMainRequest *, ncounter_t> bulkChildrenLeft;
+
+    bool IsChannelIssuable( NVMainRequest *request, FailReason *reason );
+    bool IssueToChannel( NVMainRequest *request );
+    bool IssueBulkOperation( NVMainRequest *request );
+    bool BulkOperationComplete( NVMainRequest *request );
+    void SendOverLink( NVMainRequest *request );
+    bool IsLinkIssuable( NVMainRequest *request );
+    void UpdateLinkIssuable( );
+    static bool CompletionBefore( const std::pair<ncycle_t, NVMainRequest *>& a,
+                                  const std::pair<ncycle_t, NVMainRequest *>& b );
+
     void PrintPreTrace( NVMainRequest *request );
     void GeneratePrefetches( NVMainRequest *request, std::vector<NVMAddress>& prefetchList );
 };
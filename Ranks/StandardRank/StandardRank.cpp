@@ -51,6 +51,7 @@
 #include "Ranks/StandardRank/StandardRank.h"
 #include "src/EventQueue.h"
 #include "Banks/BankFactory.h"
+#include "src/SubArray.h"
 
 #include <iostream>
 #include <sstream>
@@ -82,12 +83,11 @@ StandardRank::StandardRank( )
 
     reads = 0;
     writes = 0;
-    overlapped_activates = 0;
-    overlapped_double_row_activates = 0;
-    overlapped_triple_row_activates = 0;
-    single_row_activates = 0;
-    double_row_activates = 0;
-    triple_row_activates = 0;
+    for( ncounter_t i = 0; i < PIMPrimitives; i++ )
+        pimActivates[i] = 0;
+
+    psm_copies = 0;
+    psm_bursts = 0;
 
     actWaits = 0;
     actWaitTotal = 0;
@@ -101,6 +101,11 @@ StandardRank::StandardRank( )
     fawWaitTotal = 0;
     fawWaitAverage = 0.0;
 
+    budgetRows = 0;
+    budgetWaits = 0;
+    budgetWaitTotal = 0;
+    activatedRows = 0;
+
     lastActivate = NULL;
     RAWindex = 0;
 
@@ -236,12 +241,20 @@ void StandardRank::RegisterStats( )
 
     AddStat(reads);
     AddStat(writes);
-    AddStat(overlapped_activates);
-    AddStat(overlapped_double_row_activates);
-    AddStat(overlapped_triple_row_activates);
-    AddStat(single_row_activates);
-    AddStat(double_row_activates);
-    AddStat(triple_row_activates);
+    for( ncounter_t i = 0; i < PIMPrimitives; i++ )
+    {
+        PIMPrimitive primitive = static_cast<PIMPrimitive>(i);
+
+        if( p->pimCosts.IsEnabled( primitive ) )
+            AddNamedStat(pimActivates[i], PIMCostModel::GetInfo( primitive ).statName);
+    }
+
+    if( p->RowClone )
+    {
+        AddStat(psm_copies);
+        AddStat(psm_bursts);
+    }
+
 
     AddStat(activeCycles);
     AddStat(standbyCycles);
@@ -260,6 +273,13 @@ void StandardRank::RegisterStats( )
     AddStat(fawWaits);
     AddStat(fawWaitTotal);
     AddStat(fawWaitAverage);
+
+    if( p->PIMActivationBudget != 0 )
+    {
+        AddStat(activatedRows);
+        AddStat(budgetWaits);
+        AddStat(budgetWaitTotal);
+    }
 }
 
 bool StandardRank::Idle( )
@@ -289,36 +309,39 @@ bool StandardRank::MultiRowActivate(NVMainRequest *request )
         return false;
     }
 
+    if( lastActivate[( RAWindex + 1 ) % rawNum] + p->tRAW 
+            > GetEventQueue( )->GetCurrentCycle( ) )
+    {
+        std::cerr << "NVMain Error: Rank multi-row activation inside the tRAW window! " 
+            << "Did you check IsIssuable?" << std::endl;
+        exit(1);
+    }
+
     if( state == STANDARDRANK_CLOSED )
         state = STANDARDRANK_OPEN;
     
     /* issue ACTIVATE to target bank */
     GetChild( request )->IssueCommand( request );
 
-    /* move to the next counter (optimistic PIM impact on RAW)*/
+    /* 
+     *  move to the next counter (optimistic PIM impact on RAW). The rows
+     *  opened are charged to the activation budget instead.
+     */
     RAWindex = (RAWindex + 1) % rawNum;
     lastActivate[RAWindex] = GetEventQueue()->GetCurrentCycle();
     nextActivate = MAX( nextActivate, 
                         GetEventQueue()->GetCurrentCycle() + p->tRRDR + p->tSH );
+    ChargeBudget( ActivatedRows( request ) );
 
-    switch (request->type)
+    if( !PIMCostModel::IsMultiRowActivate( request->type ) )
     {
-        case SRA:
-            single_row_activates++;
-            break;
-        case DRA:
-            double_row_activates++;
-            break;
-        case TRA:
-            triple_row_activates++;
-            break;
-        default:
-            std::cerr << "NVMain Error : MultiRowActivate unknown operation type "
-                        <<  request->type << std::endl;
-            return false;
-            break;
+        std::cerr << "NVMain Error : MultiRowActivate unknown operation type "
+                    <<  request->type << std::endl;
+        return false;
     }
 
+    pimActivates[PIMCostModel::GetPrimitive( request->type )]++;
+
     return true;
 }
 
@@ -352,26 +375,173 @@ bool StandardRank::OverlappedActivate( NVMainRequest *request )
     lastActivate[RAWindex] = GetEventQueue()->GetCurrentCycle();
     nextActivate = MAX( nextActivate, 
                         GetEventQueue()->GetCurrentCycle() + p->tRRDR + p->tSH );
+    ChargeBudget( ActivatedRows( request ) );
 
-    switch (request->type){
-        case OA:
-            overlapped_activates++;
-            break;
-        case ODRA:
-            overlapped_double_row_activates++;
-            break;
-        case OTRA:
-            overlapped_triple_row_activates++;
-            break;
-        default:
-            std::cerr << "NVMain Error : OverlappedActivate unknown operation type "
-                        <<  request->type << std::endl;
-            return false;
-            break;
+    if( !PIMCostModel::IsOverlappedActivate( request->type ) )
+    {
+        std::cerr << "NVMain Error : OverlappedActivate unknown operation type "
+                    <<  request->type << std::endl;
+        return false;
+    }
+
+    pimActivates[PIMCostModel::GetPrimitive( request->type )]++;
+
+    return true;
+}
+
+/*
+ *  RowClone PSM streams the open source row into the open destination row
+ *  of another bank over the internal data bus, one burst per column. The
+ *  source bank reads and the destination bank writes every burst, without
+ *  driving the channel I/O.
+ */
+bool StandardRank::RowClonePSM( NVMainRequest *request )
+{
+    NVMainRequest *readBurst = new NVMainRequest( );
+    *readBurst = *request;
+    readBurst->type = READ;
+    readBurst->address = request->address2;
+    readBurst->burstCount = request->burstCount;
+    readBurst->owner = this;
+
+    NVMainRequest *writeBurst = new NVMainRequest( );
+    *writeBurst = *request;
+    writeBurst->type = WRITE;
+    writeBurst->burstCount = request->burstCount;
+    writeBurst->owner = this;
+
+    /* The bursts move whole rows, not the data of the copy request. */
+    if( p->PIMFunctional )
+    {
+        readBurst->data = NVMDataBlock( );
+        writeBurst->data = NVMDataBlock( );
+    }
+
+    if( !GetChild( readBurst )->IssueCommand( readBurst ) 
+        || !GetChild( writeBurst )->IssueCommand( writeBurst ) )
+    {
+        std::cerr << "NVMain Error: Rank RowClone PSM FAILED! Did you check IsIssuable?" 
+            << std::endl;
+        return false;
+    }
+
+    if( p->PIMFunctional )
+    {
+        SubArray *srcArray = FindChild( readBurst, SubArray );
+        SubArray *dstArray = FindChild( writeBurst, SubArray );
+
+        dstArray->StoreOpenRow( srcArray->GetRowBuffer( ) );
     }
+
+    /* The destination write finishes the copy. */
+    psmTransfers[writeBurst] = request;
+
+    /* The internal bus is busy until the last burst reaches the destination. */
+    nextRead = MAX( nextRead, 
+                    GetEventQueue()->GetCurrentCycle() + p->tCAS
+                    + MAX( p->tBURST, p->tCCD ) * request->burstCount );
+
+    nextWrite = MAX( nextWrite, nextRead );
+
+    psm_copies++;
+    psm_bursts += request->burstCount;
+
     return true;
 }
 
+/* Checks the internal bus, then the source bank read and destination bank write. */
+bool StandardRank::CanRowClonePSM( NVMainRequest *request, FailReason *reason )
+{
+    if( nextRead > GetEventQueue( )->GetCurrentCycle( ) 
+        || nextWrite > GetEventQueue( )->GetCurrentCycle( ) )
+    {
+        if( reason ) 
+            reason->reason = RANK_TIMING;
+
+        return false;
+    }
+
+    copyProbe.type = READ;
+    copyProbe.address = request->address2;
+
+    if( !GetChild( &copyProbe )->IsIssuable( &copyProbe, reason ) )
+        return false;
+
+    copyProbe.type = WRITE;
+    copyProbe.address = request->address;
+
+    return GetChild( &copyProbe )->IsIssuable( &copyProbe, reason );
+}
+
+/* Number of rows a command opens, which is what the charge pumps supply. */
+ncounter_t StandardRank::ActivatedRows( NVMainRequest *request )
+{
+    ncounter_t rows = PIMCostModel::GetRows( request->type );
+
+    if( p->pimMode == PIMMode_Pinatubo && request->activateRows > 0
+        && PIMCostModel::IsMultiRowActivate( request->type ) )
+        rows = request->activateRows;
+
+    return rows;
+}
+
+void StandardRank::ExpireBudget( )
+{
+    while( !budgetWindow.empty( ) 
+           && budgetWindow.front( ).first + p->tRAW <= GetEventQueue( )->GetCurrentCycle( ) )
+    {
+        budgetRows -= budgetWindow.front( ).second;
+        budgetWindow.pop_front( );
+    }
+}
+
+/* 
+ *  First cycle at which activating this many more rows stays within the
+ *  PIMActivationBudget of the last tRAW cycles. An activate wider than the
+ *  budget never fits, so the simulation stops instead of letting it through.
+ */
+ncycle_t StandardRank::NextBudgetCycle( ncounter_t rows )
+{
+    ncycle_t nextCycle = GetEventQueue( )->GetCurrentCycle( );
+
+    if( p->PIMActivationBudget == 0 )
+        return nextCycle;
+
+    if( rows > p->PIMActivationBudget )
+    {
+        std::cerr << "NVMain Error: Activate of " << rows << " rows exceeds "
+                  << "PIMActivationBudget (" << p->PIMActivationBudget << ")." 
+                  << std::endl;
+        exit(1);
+    }
+
+    ExpireBudget( );
+
+    ncounter_t windowRows = budgetRows;
+    std::deque<std::pair<ncycle_t, ncounter_t> >::iterator it = budgetWindow.begin( );
+
+    while( windowRows + rows > p->PIMActivationBudget && it != budgetWindow.end( ) )
+    {
+        windowRows -= it->second;
+        nextCycle = it->first + p->tRAW;
+        it++;
+    }
+
+    return nextCycle;
+}
+
+void StandardRank::ChargeBudget( ncounter_t rows )
+{
+    if( p->PIMActivationBudget == 0 )
+        return;
+
+    ExpireBudget( );
+
+    budgetWindow.push_back( std::make_pair( GetEventQueue( )->GetCurrentCycle( ), rows ) );
+    budgetRows += rows;
+    activatedRows += rows;
+}
+
 bool StandardRank::Activate( NVMainRequest *request )
 {
     uint64_t activateBank;
@@ -403,6 +573,7 @@ bool StandardRank::Activate( NVMainRequest *request )
         lastActivate[RAWindex] = GetEventQueue()->GetCurrentCycle();
         nextActivate = MAX( nextActivate, 
                             GetEventQueue()->GetCurrentCycle() + p->tRRDR + p->tSH );
+        ChargeBudget( 1 );
     }
     else
     {
@@ -743,13 +914,34 @@ ncycle_t StandardRank::NextIssuable( NVMainRequest *request )
 
     request->address.GetTranslatedAddress( NULL, NULL, &bank, NULL, NULL, NULL );
 
-    if( request->type == ACTIVATE || request->type == REFRESH || request->type == DRA || request->type == TRA || 
-        request->type == OA || request->type == SRA || request->type == ODRA || request->type == OTRA ) 
+    if( request->type == ACTIVATE || request->type == REFRESH 
+        || PIMCostModel::IsMultiRowActivate( request->type ) 
+        || PIMCostModel::IsOverlappedActivate( request->type ) ) 
+    {
         nextCompare = MAX( nextActivate, lastActivate[(RAWindex+1)%rawNum] + p->tRAW );
+
+        if( request->type != REFRESH && p->PIMActivationBudget != 0 )
+            nextCompare = MAX( nextCompare, NextBudgetCycle( ActivatedRows( request ) ) );
+    }
     else if( request->type == READ || request->type == READ_PRECHARGE ) nextCompare = nextRead;
     else if( request->type == WRITE || request->type == WRITE_PRECHARGE ) nextCompare = nextWrite;
     else if( request->type == PRECHARGE || request->type == PRECHARGE_ALL ) nextCompare = nextPrecharge;
     else if(request->type == SHIFT); //do nothing 
+    else if( request->type == ROWCLONE_PSM )
+    {
+        nextCompare = MAX( nextRead, nextWrite );
+
+        copyProbe.type = READ;
+        copyProbe.address = request->address2;
+        nextCompare = MAX( nextCompare, GetChild( &copyProbe )->NextIssuable( &copyProbe ) );
+
+        copyProbe.type = WRITE;
+        copyProbe.address = request->address;
+        nextCompare = MAX( nextCompare, GetChild( &copyProbe )->NextIssuable( &copyProbe ) );
+
+        return nextCompare;
+    }
+    else if( request->type == ROWCLONE_LISA || request->type == LW ) nextCompare = 0;
     else assert(false);
         
     return MAX(GetChild( request )->NextIssuable( request ), nextCompare );
@@ -764,11 +956,21 @@ bool StandardRank::IsIssuable( NVMainRequest *req, FailReason *reason )
 
     rv = true;
 
-    if( req->type == ACTIVATE || req->type == DRA || req->type == TRA || req->type == SRA )
+    if( req->type == ACTIVATE || PIMCostModel::IsMultiRowActivate( req->type ) )
     {
-        if( nextActivate > GetEventQueue( )->GetCurrentCycle( ) 
+        /* 
+         *  Broadcast PIM commands skip the tRRD spacing to the previous
+         *  activate, but still wait for the tRAW (tFAW) window and the
+         *  activation budget.
+         */
+        bool broadcast = (req->flags & NVMainRequest::FLAG_BROADCAST) 
+                      && p->PIMActivationBudget != 0;
+        ncycle_t budgetCycle = NextBudgetCycle( ActivatedRows( req ) );
+
+        if( ( !broadcast && nextActivate > GetEventQueue( )->GetCurrentCycle( ) )
             || ( lastActivate[(RAWindex + 1) % rawNum] + p->tRAW ) 
-                > GetEventQueue()->GetCurrentCycle() )  
+                > GetEventQueue()->GetCurrentCycle() 
+            || budgetCycle > GetEventQueue( )->GetCurrentCycle( ) )
         {
             rv = false;
 
@@ -802,16 +1004,40 @@ bool StandardRank::IsIssuable( NVMainRequest *req, FailReason *reason )
                 fawWaitTotal += ( lastActivate[( RAWindex + 1 ) % rawNum] + 
                     p->tRAW - GetEventQueue( )->GetCurrentCycle( ) );
             }
+            if( budgetCycle > GetEventQueue( )->GetCurrentCycle( ) )
+            {
+                budgetWaits++;
+                budgetWaitTotal += budgetCycle - GetEventQueue( )->GetCurrentCycle( );
+            }
         }
     }
-    else if( req->type == OA || req->type == ODRA || req->type == OTRA )
+    else if( PIMCostModel::IsOverlappedActivate( req->type ) )
     {
-        rv = GetChild( req )->IsIssuable( req, reason );
+        ncycle_t budgetCycle = NextBudgetCycle( ActivatedRows( req ) );
+
+        if( budgetCycle > GetEventQueue( )->GetCurrentCycle( ) )
+        {
+            rv = false;
+
+            if( reason ) 
+                reason->reason = RANK_TIMING;
+
+            budgetWaits++;
+            budgetWaitTotal += budgetCycle - GetEventQueue( )->GetCurrentCycle( );
+        }
+        else
+        {
+            rv = GetChild( req )->IsIssuable( req, reason );
+        }
     }
     else if( req->type == SHIFT )
     {
         rv = GetChild( req )->IsIssuable( req, reason );
     }
+    else if( req->type == ROWCLONE_PSM )
+    {
+        rv = CanRowClonePSM( req, reason );
+    }
     else if( req->type == READ || req->type == READ_PRECHARGE )
     {
         if( nextRead > GetEventQueue( )->GetCurrentCycle( ) )
@@ -928,15 +1154,15 @@ bool StandardRank::IssueCommand( NVMainRequest *req )
             case SHIFT:
                 rv = this->Shift( req );
                 break;
-            case OA:
-            case ODRA:
-            case OTRA:
-                rv = this->OverlappedActivate( req );
+
+            case ROWCLONE_PSM:
+                rv = this->RowClonePSM( req );
                 break;
-            case SRA:
-            case DRA:
-            case TRA:
-                rv = this->MultiRowActivate( req );
+
+            /* Bank-internal data movement, the rank data bus stays idle. */
+            case ROWCLONE_LISA:
+            case LW:
+                rv = GetChild( req )->IssueCommand( req );
                 break;
 
             case READ:
@@ -968,9 +1194,15 @@ bool StandardRank::IssueCommand( NVMainRequest *req )
                 rv = this->Refresh( req );
                 break;
 
+            /* PIM activates are dispatched by their entry in the cost table. */
             default:
-                std::cout << "NVMain: Rank: Unknown operation in command queue! " 
-                    << req->type << std::endl;
+                if( PIMCostModel::IsMultiRowActivate( req->type ) )
+                    rv = this->MultiRowActivate( req );
+                else if( PIMCostModel::IsOverlappedActivate( req->type ) )
+                    rv = this->OverlappedActivate( req );
+                else
+                    std::cout << "NVMain: Rank: Unknown operation in command queue! " 
+                        << req->type << std::endl;
                 break;  
         }
     }
@@ -1028,6 +1260,20 @@ bool StandardRank::RequestComplete( NVMainRequest* req )
                 break;
         }
 
+        /* Completing the destination write completes the PSM transfer. */
+        if( !psmTransfers.empty( ) )
+        {
+            std::map<NVMainRequest *, NVMainRequest *>::iterator it;
+
+            it = psmTransfers.find( req );
+
+            if( it != psmTransfers.end( ) )
+            {
+                GetParent( )->RequestComplete( it->second );
+                psmTransfers.erase( it );
+            }
+        }
+
         delete req;
         return true;
     }
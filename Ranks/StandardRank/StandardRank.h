@@ -51,6 +51,8 @@
 
 #include <cstdint>
 #include <list>
+#include <deque>
+#include <map>
 #include <iostream>
 
 namespace NVM {
@@ -140,9 +142,21 @@ class StandardRank : public Rank
     ncounter_t actWaitTotal;
     double actWaitAverage;
 
-    ncounter_t reads, writes,
-      overlapped_activates, overlapped_double_row_activates, overlapped_triple_row_activates,
-      single_row_activates, double_row_activates, triple_row_activates;
+    /* Rows activated within the last tRAW cycles, for PIMActivationBudget. */
+    std::deque<std::pair<ncycle_t, ncounter_t> > budgetWindow;
+    ncounter_t budgetRows;
+    ncounter_t budgetWaits;
+    ncounter_t budgetWaitTotal;
+    ncounter_t activatedRows;
+
+    /* RowClone PSM transfers, keyed by the burst written into the destination. */
+    std::map<NVMainRequest *, NVMainRequest *> psmTransfers;
+    NVMainRequest copyProbe;
+    ncounter_t psm_copies;
+    ncounter_t psm_bursts;
+
+    ncounter_t reads, writes;
+    ncounter_t pimActivates[PIMPrimitives];
 
     double totalEnergy, backgroundEnergy, activateEnergy, burstEnergy, refreshEnergy;
     double totalPower, backgroundPower, activatePower, burstPower, refreshPower;
@@ -151,6 +165,13 @@ class StandardRank : public Rank
     bool Shift( NVMainRequest *request );
     bool OverlappedActivate( NVMainRequest *request );
     bool MultiRowActivate( NVMainRequest *request );
+    bool RowClonePSM( NVMainRequest *request );
+    bool CanRowClonePSM( NVMainRequest *request, FailReason *reason );
+
+    ncounter_t ActivatedRows( NVMainRequest *request );
+    void ExpireBudget( );
+    ncycle_t NextBudgetCycle( ncounter_t rows );
+    void ChargeBudget( ncounter_t rows );
 
     bool Read( NVMainRequest *request );
     bool Write( NVMainRequest *request );
@@ -64,12 +64,21 @@ testdata = json.load(json_data)
 
 
 #
-# Run all tests with each trace
+# Run all tests with each trace. Tests that name their own trace only run
+# with that trace.
 #
+runs = []
 
 for trace in testdata["traces"]:
+    runs.append((trace, [idx for idx, test in enumerate(testdata["tests"]) if not "trace" in test]))
 
-    for idx, test in enumerate(testdata["tests"]):
+for idx, test in enumerate(testdata["tests"]):
+    if "trace" in test:
+        runs.append((test["trace"], [idx]))
+
+for trace, testids in runs:
+
+    for idx in testids:
         faillog = testdata["tests"][idx]["name"] + ".out"
 
         # Reset log each time for correct stat comparison
@@ -48,10 +48,27 @@ using namespace NVM;
 PostTrace::PostTrace( )
 {
     SetHookType( NVMHOOK_PREISSUE );
+
+    traceWriter = NULL;
+    traceRanks = 0;
+    traceChannels = 0;
 }
 
 PostTrace::~PostTrace( )
 {
+    /* Close the writers so compressed traces are terminated. */
+    if( traceWriter != NULL )
+    {
+        for( ncounter_t channelIdx = 0; channelIdx < traceChannels; channelIdx++ )
+        {
+            for( ncounter_t rankIdx = 0; rankIdx < traceRanks; rankIdx++ )
+                delete traceWriter[channelIdx][rankIdx];
+
+            delete [] traceWriter[channelIdx];
+        }
+
+        delete [] traceWriter;
+    }
 }
 
 /* 
@@ -66,6 +83,7 @@ void PostTrace::Init( Config *conf )
 
     std::string traceWriterName = "NVMainTrace";
     std::string baseFileName;
+    std::string compressionSuffix = "";
 
     if( conf->KeyExists( "PostTraceWriter" ) )
         traceWriterName = conf->GetString( "PostTraceWriter" );
@@ -94,6 +112,19 @@ void PostTrace::Init( Config *conf )
         baseFileName += conf->GetString( "PostTraceFile" );
     }
 
+    /* Compressed writers are selected by the file extension. */
+    if( conf->KeyExists( "PostTraceCompression" ) )
+    {
+        if( conf->GetString( "PostTraceCompression" ) == "gzip" )
+            compressionSuffix = ".gz";
+        else if( conf->GetString( "PostTraceCompression" ) == "zstd" )
+            compressionSuffix = ".zst";
+        else if( conf->GetString( "PostTraceCompression" ) != "none" )
+            std::cout << "PostTrace: Unknown compression `" 
+                      << conf->GetString( "PostTraceCompression" ) 
+                      << "'. Writing uncompressed traces." << std::endl;
+    }
+
     std::cout << "PostTrace: Using trace file " << baseFileName << std::endl;
 
     /* Determine the number of channels with their own writers. */
@@ -131,7 +162,8 @@ void PostTrace::Init( Config *conf )
         for( ncounter_t rankIdx = 0; rankIdx < traceRanks; rankIdx++ )
         {
             std::stringstream traceFileName;
-            traceFileName << baseFileName << "_ch" << channelIdx << "_rk" << rankIdx;
+            traceFileName << baseFileName << "_ch" << channelIdx << "_rk" << rankIdx
+                          << compressionSuffix;
 
             traceWriter[channelIdx][rankIdx] = TraceWriterFactory::CreateNewTraceWriter( traceWriterName );
             traceWriter[channelIdx][rankIdx]->SetTraceFile( traceFileName.str() );
@@ -0,0 +1,750 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "include/CompressedStream.h"
+
+#include <cstring>
+
+#ifdef NVMAIN_HAS_ZLIB
+#include <zlib.h>
+#endif
+#ifdef NVMAIN_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace NVM;
+
+/* Size of the decompressed blocks handed between the stream and helper. */
+static const size_t CompressedBlockSize = 1 << 20;
+/* Number of blocks the helper thread may run ahead (or behind). */
+static const size_t CompressedQueueDepth = 4;
+/* Size of the buffer for compressed file data. */
+static const size_t CompressedRawSize = 1 << 18;
+
+/*
+ *  Trace writers are not always destroyed before the simulator exits, so
+ *  compressed outputs still open at exit are finished here to make sure the
+ *  compressed stream is terminated properly.
+ */
+static std::vector<CompressedStreamBuf *> *openOutputs = NULL;
+
+static void CloseOpenOutputs( )
+{
+    while( openOutputs != NULL && !openOutputs->empty( ) )
+        openOutputs->back( )->Close( );
+}
+
+CompressedStreamBuf::CompressedStreamBuf( )
+{
+    rawFile = NULL;
+    compression = NoCompression;
+    output = false;
+    finished = false;
+    closing = false;
+    failed = false;
+    streamOpen = false;
+    codec = NULL;
+    rawStart = 0;
+    rawEnd = 0;
+}
+
+CompressedStreamBuf::~CompressedStreamBuf( )
+{
+    Close( );
+}
+
+CompressionType CompressedStreamBuf::DetectCompression( std::string file )
+{
+    CompressionType type = NoCompression;
+    unsigned char magic[4];
+    FILE *probe = fopen( file.c_str( ), "rb" );
+
+    if( probe == NULL )
+        return NoCompression;
+
+    size_t length = fread( magic, 1, sizeof(magic), probe );
+
+    if( length >= 2 && magic[0] == 0x1F && magic[1] == 0x8B )
+        type = GzipCompression;
+    else if( length == 4 && magic[0] == 0x28 && magic[1] == 0xB5 
+             && magic[2] == 0x2F && magic[3] == 0xFD )
+        type = ZstdCompression;
+
+    fclose( probe );
+
+    return type;
+}
+
+CompressionType CompressedStreamBuf::GetCompression( std::string file )
+{
+    if( file.size( ) > 3 && file.compare( file.size( ) - 3, 3, ".gz" ) == 0 )
+        return GzipCompression;
+    if( file.size( ) > 4 && file.compare( file.size( ) - 4, 4, ".zst" ) == 0 )
+        return ZstdCompression;
+
+    return NoCompression;
+}
+
+bool CompressedStreamBuf::IsSupported( CompressionType type )
+{
+    bool supported = (type == NoCompression);
+
+#ifdef NVMAIN_HAS_ZLIB
+    supported = supported || (type == GzipCompression);
+#endif
+#ifdef NVMAIN_HAS_ZSTD
+    supported = supported || (type == ZstdCompression);
+#endif
+
+    return supported;
+}
+
+bool CompressedStreamBuf::Open( std::string file, CompressionType type, bool write )
+{
+    Close( );
+
+    if( !IsSupported( type ) )
+    {
+        std::cerr << "NVMain: " << file << " is " 
+                  << ((type == GzipCompression) ? "gzip" : "zstd")
+                  << " compressed, but NVMain was built without support for it!"
+                  << std::endl;
+        return false;
+    }
+
+    rawFile = fopen( file.c_str( ), write ? "wb" : "rb" );
+
+    if( rawFile == NULL )
+        return false;
+
+    compression = type;
+    output = write;
+    finished = false;
+    closing = false;
+    failed = false;
+    streamOpen = false;
+    rawStart = 0;
+    rawEnd = 0;
+    rawBuffer.resize( CompressedRawSize );
+
+    if( !InitCodec( ) )
+    {
+        std::cerr << "NVMain: Could not initialize the decompressor for " 
+                  << file << "!" << std::endl;
+        fclose( rawFile );
+        rawFile = NULL;
+        return false;
+    }
+
+    if( output )
+    {
+        current.resize( CompressedBlockSize );
+        setp( &current[0], &current[0] + current.size( ) );
+
+        if( openOutputs == NULL )
+        {
+            openOutputs = new std::vector<CompressedStreamBuf *>( );
+            atexit( CloseOpenOutputs );
+        }
+        openOutputs->push_back( this );
+
+        helper = std::thread( &CompressedStreamBuf::CompressLoop, this );
+    }
+    else
+    {
+        setg( NULL, NULL, NULL );
+
+        helper = std::thread( &CompressedStreamBuf::DecompressLoop, this );
+    }
+
+    return true;
+}
+
+bool CompressedStreamBuf::IsOpen( )
+{
+    return (rawFile != NULL);
+}
+
+bool CompressedStreamBuf::IsFailed( )
+{
+    return failed;
+}
+
+void CompressedStreamBuf::Close( )
+{
+    if( rawFile == NULL )
+        return;
+
+    if( output )
+    {
+        HandOff( );
+
+        {
+            std::unique_lock<std::mutex> lock( blockLock );
+            closing = true;
+        }
+        blockReady.notify_all( );
+        helper.join( );
+
+        for( size_t i = 0; i < openOutputs->size( ); i++ )
+        {
+            if( (*openOutputs)[i] == this )
+            {
+                openOutputs->erase( openOutputs->begin( ) + i );
+                break;
+            }
+        }
+
+        setp( NULL, NULL );
+    }
+    else
+    {
+        {
+            std::unique_lock<std::mutex> lock( blockLock );
+            closing = true;
+        }
+        blockTaken.notify_all( );
+        helper.join( );
+
+        setg( NULL, NULL, NULL );
+    }
+
+    if( failed )
+        std::cerr << "NVMain: Error while accessing a compressed trace!" << std::endl;
+
+    blocks.clear( );
+    current.clear( );
+    FreeCodec( );
+    fclose( rawFile );
+    rawFile = NULL;
+}
+
+CompressedStreamBuf::int_type CompressedStreamBuf::underflow( )
+{
+    if( gptr( ) < egptr( ) )
+        return traits_type::to_int_type( *gptr( ) );
+
+    if( rawFile == NULL || output )
+        return traits_type::eof( );
+
+    std::unique_lock<std::mutex> lock( blockLock );
+
+    while( blocks.empty( ) && !finished )
+        blockReady.wait( lock );
+
+    if( blocks.empty( ) )
+        return traits_type::eof( );
+
+    current.swap( blocks.front( ) );
+    blocks.pop_front( );
+    blockTaken.notify_all( );
+
+    setg( &current[0], &current[0], &current[0] + current.size( ) );
+
+    return traits_type::to_int_type( *gptr( ) );
+}
+
+CompressedStreamBuf::int_type CompressedStreamBuf::overflow( int_type c )
+{
+    if( rawFile == NULL || !output )
+        return traits_type::eof( );
+
+    HandOff( );
+
+    if( failed )
+        return traits_type::eof( );
+
+    if( !traits_type::eq_int_type( c, traits_type::eof( ) ) )
+    {
+        *pptr( ) = traits_type::to_char_type( c );
+        pbump( 1 );
+        return c;
+    }
+
+    return traits_type::not_eof( c );
+}
+
+/* 
+ *  Writers flush after every line, so data is only handed to the helper
+ *  thread once a block is full or the stream is closed.
+ */
+int CompressedStreamBuf::sync( )
+{
+    return (failed ? -1 : 0);
+}
+
+/* Passes the filled part of the put area to the helper thread. */
+void CompressedStreamBuf::HandOff( )
+{
+    size_t size = static_cast<size_t>( pptr( ) - pbase( ) );
+
+    if( size == 0 )
+        return;
+
+    current.resize( size );
+
+    {
+        std::unique_lock<std::mutex> lock( blockLock );
+
+        while( blocks.size( ) >= CompressedQueueDepth )
+            blockTaken.wait( lock );
+
+        blocks.push_back( std::vector<char>( ) );
+        blocks.back( ).swap( current );
+    }
+    blockReady.notify_all( );
+
+    current.resize( CompressedBlockSize );
+    setp( &current[0], &current[0] + current.size( ) );
+}
+
+void CompressedStreamBuf::DecompressLoop( )
+{
+    bool more = true;
+
+    while( more )
+    {
+        std::vector<char> block;
+
+        more = DecompressBlock( block );
+
+        std::unique_lock<std::mutex> lock( blockLock );
+
+        while( blocks.size( ) >= CompressedQueueDepth && !closing )
+            blockTaken.wait( lock );
+
+        if( closing )
+            break;
+
+        if( !block.empty( ) )
+        {
+            blocks.push_back( std::vector<char>( ) );
+            blocks.back( ).swap( block );
+        }
+
+        finished = !more;
+        blockReady.notify_all( );
+    }
+}
+
+void CompressedStreamBuf::CompressLoop( )
+{
+    while( true )
+    {
+        std::vector<char> block;
+
+        {
+            std::unique_lock<std::mutex> lock( blockLock );
+
+            while( blocks.empty( ) && !closing )
+                blockReady.wait( lock );
+
+            if( blocks.empty( ) )
+                break;
+
+            block.swap( blocks.front( ) );
+            blocks.pop_front( );
+        }
+        blockTaken.notify_all( );
+
+        if( !failed && !CompressBlock( block, false ) )
+            failed = true;
+    }
+
+    std::vector<char> last;
+
+    if( !failed && !CompressBlock( last, true ) )
+        failed = true;
+}
+
+bool CompressedStreamBuf::InitCodec( )
+{
+    bool initialized = false;
+
+#ifdef NVMAIN_HAS_ZLIB
+    if( compression == GzipCompression )
+    {
+        z_stream *stream = new z_stream;
+
+        memset( stream, 0, sizeof(z_stream) );
+
+        /* 15+16 writes a gzip header, 15+32 accepts gzip or zlib headers. */
+        if( output )
+            initialized = (deflateInit2( stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                                         15 + 16, 8, Z_DEFAULT_STRATEGY ) == Z_OK);
+        else
+            initialized = (inflateInit2( stream, 15 + 32 ) == Z_OK);
+
+        if( initialized )
+            codec = stream;
+        else
+            delete stream;
+    }
+#endif
+#ifdef NVMAIN_HAS_ZSTD
+    if( compression == ZstdCompression )
+    {
+        if( output )
+        {
+            ZSTD_CStream *stream = ZSTD_createCStream( );
+
+            initialized = (stream != NULL && !ZSTD_isError( ZSTD_initCStream( stream, 3 ) ));
+            codec = stream;
+        }
+        else
+        {
+            ZSTD_DStream *stream = ZSTD_createDStream( );
+
+            initialized = (stream != NULL && !ZSTD_isError( ZSTD_initDStream( stream ) ));
+            codec = stream;
+        }
+    }
+#endif
+
+    if( !initialized )
+        FreeCodec( );
+
+    return initialized;
+}
+
+void CompressedStreamBuf::FreeCodec( )
+{
+    if( codec == NULL )
+        return;
+
+#ifdef NVMAIN_HAS_ZLIB
+    if( compression == GzipCompression )
+    {
+        z_stream *stream = static_cast<z_stream *>( codec );
+
+        if( output )
+            deflateEnd( stream );
+        else
+            inflateEnd( stream );
+
+        delete stream;
+    }
+#endif
+#ifdef NVMAIN_HAS_ZSTD
+    if( compression == ZstdCompression )
+    {
+        if( output )
+            ZSTD_freeCStream( static_cast<ZSTD_CStream *>( codec ) );
+        else
+            ZSTD_freeDStream( static_cast<ZSTD_DStream *>( codec ) );
+    }
+#endif
+
+    codec = NULL;
+}
+
+/* Refills the raw buffer once it has been consumed. Returns false at EOF. */
+bool CompressedStreamBuf::FillRaw( )
+{
+    if( rawStart < rawEnd )
+        return true;
+
+    rawStart = 0;
+    rawEnd = fread( &rawBuffer[0], 1, rawBuffer.size( ), rawFile );
+
+    return (rawEnd > 0);
+}
+
+/* 
+ *  Fills block with decompressed data. Returns false at the end of the file.
+ *  Running out of input before the codec reaches the end of its stream is
+ *  reported as an error rather than a silent end of the trace.
+ */
+bool CompressedStreamBuf::DecompressBlock( std::vector<char>& block )
+{
+    size_t produced = 0;
+    bool error = false;
+    bool truncated = false;
+
+    block.resize( CompressedBlockSize );
+
+#ifdef NVMAIN_HAS_ZLIB
+    if( compression == GzipCompression )
+    {
+        z_stream *stream = static_cast<z_stream *>( codec );
+
+        stream->next_out = reinterpret_cast<Bytef *>( &block[0] );
+        stream->avail_out = static_cast<uInt>( block.size( ) );
+
+        while( stream->avail_out > 0 )
+        {
+            bool more = FillRaw( );
+
+            if( !more && !streamOpen )
+                break;
+
+            /* At EOF the decompressor is only asked to flush what it holds. */
+            stream->next_in = (more ? reinterpret_cast<Bytef *>( &rawBuffer[rawStart] ) : NULL);
+            stream->avail_in = (more ? static_cast<uInt>( rawEnd - rawStart ) : 0);
+
+            uInt space = stream->avail_out;
+            int rv = inflate( stream, Z_NO_FLUSH );
+
+            if( more )
+                rawStart = rawEnd - stream->avail_in;
+
+            /* Concatenated gzip members are decompressed back to back. */
+            if( rv == Z_STREAM_END )
+            {
+                inflateReset( stream );
+                streamOpen = false;
+            }
+            else if( rv != Z_OK && rv != Z_BUF_ERROR )
+            {
+                error = true;
+                break;
+            }
+            else
+            {
+                streamOpen = true;
+
+                if( !more && stream->avail_out == space )
+                {
+                    truncated = true;
+                    break;
+                }
+            }
+        }
+
+        produced = block.size( ) - stream->avail_out;
+    }
+#endif
+#ifdef NVMAIN_HAS_ZSTD
+    if( compression == ZstdCompression )
+    {
+        ZSTD_DStream *stream = static_cast<ZSTD_DStream *>( codec );
+        ZSTD_outBuffer out = { &block[0], block.size( ), 0 };
+
+        while( out.pos < out.size )
+        {
+            bool more = FillRaw( );
+
+            if( !more && !streamOpen )
+                break;
+
+            ZSTD_inBuffer in = { (more ? &rawBuffer[rawStart] : NULL),
+                                 (more ? rawEnd - rawStart : 0), 0 };
+
+            size_t space = out.pos;
+            size_t rv = ZSTD_decompressStream( stream, &out, &in );
+
+            rawStart += in.pos;
+
+            if( ZSTD_isError( rv ) )
+            {
+                error = true;
+                break;
+            }
+
+            /* A nonzero hint means the current frame is not complete yet. */
+            streamOpen = (rv != 0);
+
+            if( !more && streamOpen && out.pos == space )
+            {
+                truncated = true;
+                break;
+            }
+        }
+
+        produced = out.pos;
+    }
+#endif
+
+    if( truncated )
+    {
+        std::cerr << "NVMain Error: Compressed trace ends in the middle of a "
+                  << "stream. The file is truncated." << std::endl;
+        error = true;
+    }
+
+    if( error )
+        failed = true;
+
+    block.resize( produced );
+
+    return (!error && produced == CompressedBlockSize);
+}
+
+/* Compresses block and writes it out, finishing the stream if requested. */
+bool CompressedStreamBuf::CompressBlock( std::vector<char>& block, bool finish )
+{
+#ifdef NVMAIN_HAS_ZLIB
+    if( compression == GzipCompression )
+    {
+        z_stream *stream = static_cast<z_stream *>( codec );
+
+        stream->next_in = reinterpret_cast<Bytef *>( block.empty( ) ? NULL : &block[0] );
+        stream->avail_in = static_cast<uInt>( block.size( ) );
+
+        do
+        {
+            stream->next_out = reinterpret_cast<Bytef *>( &rawBuffer[0] );
+            stream->avail_out = static_cast<uInt>( rawBuffer.size( ) );
+
+            if( deflate( stream, finish ? Z_FINISH : Z_NO_FLUSH ) == Z_STREAM_ERROR )
+                return false;
+
+            size_t have = rawBuffer.size( ) - stream->avail_out;
+
+            if( fwrite( &rawBuffer[0], 1, have, rawFile ) != have )
+                return false;
+        } while( stream->avail_out == 0 );
+    }
+#endif
+#ifdef NVMAIN_HAS_ZSTD
+    if( compression == ZstdCompression )
+    {
+        ZSTD_CStream *stream = static_cast<ZSTD_CStream *>( codec );
+        ZSTD_inBuffer in = { block.empty( ) ? NULL : &block[0], block.size( ), 0 };
+        size_t remaining = 1;
+
+        while( in.pos < in.size || (finish && remaining > 0) )
+        {
+            ZSTD_outBuffer out = { &rawBuffer[0], rawBuffer.size( ), 0 };
+
+            if( in.pos < in.size )
+                remaining = ZSTD_compressStream( stream, &out, &in );
+            else
+                remaining = ZSTD_endStream( stream, &out );
+
+            if( ZSTD_isError( remaining ) )
+                return false;
+
+            if( fwrite( &rawBuffer[0], 1, out.pos, rawFile ) != out.pos )
+                return false;
+        }
+    }
+#endif
+
+    if( finish && fflush( rawFile ) != 0 )
+        return false;
+
+    return true;
+}
+
+TraceInputStream::TraceInputStream( ) : std::istream( NULL )
+{
+
+}
+
+TraceInputStream::~TraceInputStream( )
+{
+    close( );
+}
+
+void TraceInputStream::open( const char *file )
+{
+    CompressionType type = CompressedStreamBuf::DetectCompression( file );
+
+    close( );
+
+    if( type == NoCompression )
+    {
+        if( plainBuffer.open( file, std::ios::in ) )
+            rdbuf( &plainBuffer );
+    }
+    else if( compressedBuffer.Open( file, type, false ) )
+    {
+        rdbuf( &compressedBuffer );
+    }
+
+    if( !is_open( ) )
+        setstate( std::ios::failbit );
+}
+
+bool TraceInputStream::is_open( )
+{
+    return (plainBuffer.is_open( ) || compressedBuffer.IsOpen( ));
+}
+
+bool TraceInputStream::is_corrupt( )
+{
+    return compressedBuffer.IsFailed( );
+}
+
+void TraceInputStream::close( )
+{
+    plainBuffer.close( );
+    compressedBuffer.Close( );
+    rdbuf( NULL );
+}
+
+TraceOutputStream::TraceOutputStream( ) : std::ostream( NULL )
+{
+
+}
+
+TraceOutputStream::~TraceOutputStream( )
+{
+    close( );
+}
+
+void TraceOutputStream::open( const char *file )
+{
+    CompressionType type = CompressedStreamBuf::GetCompression( file );
+
+    close( );
+
+    if( type == NoCompression )
+    {
+        if( plainBuffer.open( file, std::ios::out | std::ios::trunc ) )
+            rdbuf( &plainBuffer );
+    }
+    else if( compressedBuffer.Open( file, type, true ) )
+    {
+        rdbuf( &compressedBuffer );
+    }
+
+    if( !is_open( ) )
+        setstate( std::ios::failbit );
+}
+
+bool TraceOutputStream::is_open( )
+{
+    return (plainBuffer.is_open( ) || compressedBuffer.IsOpen( ));
+}
+
+void TraceOutputStream::close( )
+{
+    if( rdbuf( ) != NULL )
+        flush( );
+
+    plainBuffer.close( );
+    compressedBuffer.Close( );
+    rdbuf( NULL );
+}
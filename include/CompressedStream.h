@@ -0,0 +1,145 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_COMPRESSEDSTREAM_H__
+#define __NVMAIN_COMPRESSEDSTREAM_H__
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <streambuf>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace NVM {
+
+enum CompressionType { NoCompression, GzipCompression, ZstdCompression };
+
+/*
+ *  Stream buffer that (de)compresses a gzip or zstd file on a helper thread.
+ *  The helper thread works one block ahead (behind for output) of the stream
+ *  so that (de)compression overlaps with the simulation.
+ */
+class CompressedStreamBuf : public std::streambuf
+{
+  public:
+    CompressedStreamBuf( );
+    ~CompressedStreamBuf( );
+
+    bool Open( std::string file, CompressionType type, bool write );
+    bool IsOpen( );
+    bool IsFailed( );
+    void Close( );
+
+    /* Compression of an existing file, from its magic number. */
+    static CompressionType DetectCompression( std::string file );
+    /* Compression of a file to be written, from its extension. */
+    static CompressionType GetCompression( std::string file );
+    static bool IsSupported( CompressionType type );
+
+  protected:
+    int_type underflow( );
+    int_type overflow( int_type c );
+    int sync( );
+
+  private:
+    FILE *rawFile;
+    CompressionType compression;
+    bool output;
+    bool finished;
+    bool closing;
+    std::atomic<bool> failed;
+    bool streamOpen;
+    void *codec;
+
+    std::vector<char> current;
+    std::vector<char> rawBuffer;
+    size_t rawStart, rawEnd;
+    std::deque< std::vector<char> > blocks;
+    std::mutex blockLock;
+    std::condition_variable blockReady;
+    std::condition_variable blockTaken;
+    std::thread helper;
+
+    bool InitCodec( );
+    void FreeCodec( );
+    bool FillRaw( );
+    bool DecompressBlock( std::vector<char>& block );
+    bool CompressBlock( std::vector<char>& block, bool finish );
+    void DecompressLoop( );
+    void CompressLoop( );
+    void HandOff( );
+};
+
+/* Drop-in replacement for std::ifstream that reads compressed traces. */
+class TraceInputStream : public std::istream
+{
+  public:
+    TraceInputStream( );
+    ~TraceInputStream( );
+
+    void open( const char *file );
+    bool is_open( );
+    /* True if a compressed trace was corrupt or ended early. */
+    bool is_corrupt( );
+    void close( );
+
+  private:
+    std::filebuf plainBuffer;
+    CompressedStreamBuf compressedBuffer;
+};
+
+/* Drop-in replacement for std::ofstream that writes compressed traces. */
+class TraceOutputStream : public std::ostream
+{
+  public:
+    TraceOutputStream( );
+    ~TraceOutputStream( );
+
+    void open( const char *file );
+    bool is_open( );
+    void close( );
+
+  private:
+    std::filebuf plainBuffer;
+    CompressedStreamBuf compressedBuffer;
+};
+
+};
+
+#endif
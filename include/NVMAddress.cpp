@@ -41,6 +41,12 @@ NVMAddress::NVMAddress( )
     hasPhysicalAddress = false;
     physicalAddress = 0;
     subarray = row = col = bank = rank = channel = 0;
+    translationLayout = 0;
+}
+
+NVMAddress::NVMAddress( const NVMAddress& m )
+{
+    *this = m;
 }
 
 NVMAddress::~NVMAddress( )
@@ -57,6 +63,7 @@ void NVMAddress::SetTranslatedAddress( uint64_t addrRow, uint64_t addrCol, uint6
                                        uint64_t addrRank, uint64_t addrChannel, uint64_t addrSA )
 {
     translated = true;
+    translationLayout = 0;
     row = addrRow;
     col = addrCol;
     bank = addrBank;
@@ -69,6 +76,7 @@ void NVMAddress::SetPhysicalAddress( uint64_t pAddress )
 {
     hasPhysicalAddress = true;
     physicalAddress = pAddress;
+    translationLayout = 0;
 }
 
 void NVMAddress::SetBitAddress( uint8_t bitAddr )
@@ -77,7 +85,7 @@ void NVMAddress::SetBitAddress( uint8_t bitAddr )
 }
 
 void NVMAddress::GetTranslatedAddress( uint64_t *addrRow, uint64_t *addrCol, uint64_t *addrBank, 
-                                       uint64_t *addrRank, uint64_t *addrChannel, uint64_t *addrSA )
+                                       uint64_t *addrRank, uint64_t *addrChannel, uint64_t *addrSA ) const
 {
     if( addrRow ) *addrRow = row;
     if( addrCol ) *addrCol = col;
@@ -87,52 +95,52 @@ void NVMAddress::GetTranslatedAddress( uint64_t *addrRow, uint64_t *addrCol, uin
     if( addrSA ) *addrSA = subarray;
 }
 
-uint64_t NVMAddress::GetPhysicalAddress( )
+uint64_t NVMAddress::GetPhysicalAddress( ) const
 {
     return physicalAddress;
 }
 
-uint64_t NVMAddress::GetBitAddress( )
+uint64_t NVMAddress::GetBitAddress( ) const
 {
     return bit;
 }
 
-uint64_t NVMAddress::GetRow( )
+uint64_t NVMAddress::GetRow( ) const
 {
     return row;
 }
 
-uint64_t NVMAddress::GetCol( )
+uint64_t NVMAddress::GetCol( ) const
 {
     return col;
 }
 
-uint64_t NVMAddress::GetBank( )
+uint64_t NVMAddress::GetBank( ) const
 {
     return bank;
 }
 
-uint64_t NVMAddress::GetRank( )
+uint64_t NVMAddress::GetRank( ) const
 {
     return rank;
 }
 
-uint64_t NVMAddress::GetChannel( )
+uint64_t NVMAddress::GetChannel( ) const
 {
     return channel;
 }
 
-uint64_t NVMAddress::GetSubArray( )
+uint64_t NVMAddress::GetSubArray( ) const
 {
     return subarray;
 }
 
-bool NVMAddress::IsTranslated( )
+bool NVMAddress::IsTranslated( ) const
 {
     return translated;
 }
 
-bool NVMAddress::HasPhysicalAddress( )
+bool NVMAddress::HasPhysicalAddress( ) const
 {
     return hasPhysicalAddress;
 }
@@ -149,6 +157,17 @@ NVMAddress& NVMAddress::operator=( const NVMAddress& m )
     channel = m.channel;
     subarray = m.subarray;
     bit = m.bit;
+    translationLayout = m.translationLayout;
 
     return *this;
 }
+
+void NVMAddress::SetTranslationLayout( uint64_t layout )
+{
+    translationLayout = layout;
+}
+
+uint64_t NVMAddress::GetTranslationLayout( ) const
+{
+    return translationLayout;
+}
@@ -42,6 +42,7 @@ class NVMAddress
 {
   public:
     NVMAddress( );
+    NVMAddress( const NVMAddress& m );
     ~NVMAddress( );
 
     NVMAddress( uint64_t addrRow, uint64_t addrCol, uint64_t addrBank,
@@ -53,19 +54,23 @@ class NVMAddress
     void SetBitAddress( uint8_t bitAddr );
     
     void GetTranslatedAddress( uint64_t *addrRow, uint64_t *addrCol, uint64_t *addrBank, 
-                               uint64_t *addrRank, uint64_t *addrChannel, uint64_t *addrSA );
-    uint64_t GetPhysicalAddress( );
-    uint64_t GetBitAddress( );
+                               uint64_t *addrRank, uint64_t *addrChannel, uint64_t *addrSA ) const;
+    uint64_t GetPhysicalAddress( ) const;
+    uint64_t GetBitAddress( ) const;
 
-    uint64_t GetRow( );
-    uint64_t GetCol( );
-    uint64_t GetBank( );
-    uint64_t GetRank( );
-    uint64_t GetChannel( );
-    uint64_t GetSubArray( );
+    uint64_t GetRow( ) const;
+    uint64_t GetCol( ) const;
+    uint64_t GetBank( ) const;
+    uint64_t GetRank( ) const;
+    uint64_t GetChannel( ) const;
+    uint64_t GetSubArray( ) const;
     
-    bool IsTranslated( );
-    bool HasPhysicalAddress( );
+    bool IsTranslated( ) const;
+    bool HasPhysicalAddress( ) const;
+
+    /* Layout of the translator that produced the translated address. */
+    void SetTranslationLayout( uint64_t layout );
+    uint64_t GetTranslationLayout( ) const;
 
     NVMAddress& operator=( const NVMAddress& m );
   
@@ -80,6 +85,7 @@ class NVMAddress
     uint64_t rank;
     uint64_t channel;
     uint64_t bit;
+    uint64_t translationLayout;
 };
 
 };
@@ -44,22 +44,60 @@ NVMDataBlock::NVMDataBlock( )
     rawData = NULL;
     isValid = false;
     size = 0;
+    capacity = 0;
+    spare = NULL;
+    spareCapacity = 0;
 }
 
 NVMDataBlock::~NVMDataBlock( )
 {
     delete[] rawData;
+    delete[] spare;
     rawData = NULL;
+    spare = NULL;
+}
+
+uint8_t *NVMDataBlock::TakeBuffer( uint64_t s )
+{
+    uint8_t *buffer;
+
+    if( spare != NULL && spareCapacity >= s )
+    {
+        buffer = spare;
+        capacity = spareCapacity;
+        spare = NULL;
+    }
+    else
+    {
+        buffer = new uint8_t[s];
+        capacity = s;
+    }
+
+    return buffer;
 }
 
 void NVMDataBlock::SetSize( uint64_t s )
 {
     assert( rawData == NULL );
-    rawData = new uint8_t[s];
+    rawData = TakeBuffer( s );
     size = s;
     isValid = true;
 }
 
+void NVMDataBlock::Clear( )
+{
+    if( rawData != NULL )
+    {
+        delete[] spare;
+        spare = rawData;
+        spareCapacity = capacity;
+        rawData = NULL;
+    }
+
+    isValid = false;
+    size = 0;
+}
+
 uint64_t NVMDataBlock::GetSize( )
 {
     return size;
@@ -113,8 +151,15 @@ NVMDataBlock& NVMDataBlock::operator=( const NVMDataBlock& m )
 {
     if( m.rawData )
     {
+        /* Blocks may differ in size, e.g., for variable length trace data. */
+        if( rawData != NULL && capacity < m.size )
+        {
+            delete[] rawData;
+            rawData = NULL;
+        }
+
         if( rawData == NULL )
-            rawData = new uint8_t[m.size];
+            rawData = TakeBuffer( m.size );
         memcpy(rawData, m.rawData, m.size);
     }
     isValid = m.isValid;
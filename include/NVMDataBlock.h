@@ -55,6 +55,9 @@ class NVMDataBlock
     void SetValid( bool valid );
     bool IsValid( );
 
+    /* Empties the block, keeping its buffer for the next SetSize or copy. */
+    void Clear( );
+
     void Print( std::ostream& out ) const;
     
     NVMDataBlock& operator=( const NVMDataBlock& m );
@@ -64,6 +67,11 @@ class NVMDataBlock
   private:
     bool isValid;
     uint64_t size;
+    uint64_t capacity;
+    uint8_t *spare;
+    uint64_t spareCapacity;
+
+    uint8_t *TakeBuffer( uint64_t s );
 
     NVMDataBlock( const NVMDataBlock& ) { }
 };
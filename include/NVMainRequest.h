@@ -78,7 +78,27 @@ enum OpType
     ODRA, /*Overlapped Double Row Activate primitive for PIM in DRAM*/
     OTRA, /*Overlapped Triple Row Activate primitive for PIM in DRAM*/
     LW, /*Local Write primitive for PIM in DRAM*/
-    ROWCLONE_PSM /*Row Clone PSM primitive for PIM in DRAM (not implemented yet) */
+    ROWCLONE_PSM, /*Row Clone Pipelined Serial Mode copy between two banks over the internal bus*/
+    BBOP, /*Bulk bitwise operation over whole rows, expanded by the memory controller*/
+    ROWCLONE_LISA, /*LISA row buffer movement between subarrays of a bank over linked bitlines*/
+    QRA, /*Quadruple Row Activate primitive for PIM in DRAM*/
+    FRA /*Five Row Activate primitive for PIM in DRAM*/
+};
+
+enum BulkBitwiseOp
+{
+    BBOP_AND = 0,
+    BBOP_OR,
+    BBOP_XOR,
+    BBOP_NOT,
+    BBOP_NAND,
+    BBOP_NOR,
+    BBOP_COPY,
+    BBOP_ADD,       /* Arithmetic over bit-serial vertical operands */
+    BBOP_SUB,
+    BBOP_LT,
+    BBOP_MUL,
+    BBOP_POPCOUNT
 };
 
 enum MemRequestStatus 
@@ -151,6 +171,10 @@ class NVMainRequest
         burstCount = 1;
         writeProgress = 0;
         cancellations = 0;
+        bulkOp = BBOP_COPY;
+        bulkSize = 0;
+        bulkWidth = 1;
+        activateRows = 0;
         owner = NULL;
     };
 
@@ -160,6 +184,11 @@ class NVMainRequest
 
     NVMAddress address;            //< Address of request (for PIM requests this is dest 
     NVMAddress address2;           //< Second address of request (for PIM requests this is source
+    NVMAddress address3;           //< Third address of request (second source of a bulk bitwise op)
+    BulkBitwiseOp bulkOp;          //< Operation of a BBOP request, or sensed by a Pinatubo activate
+    ncounter_t bulkSize;           //< Size of each BBOP operand in bytes
+    ncounter_t bulkWidth;          //< Bits per element of arithmetic BBOP sources
+    ncounter_t activateRows;       //< Rows raised by a Pinatubo multi-row activate (0 = by type)
     OpType type;                   //< Operation type of request (read, write, etc)
     BulkCommand bulkCmd;           //< Bulk Commands (i.e., Read+Precharge, Write+Precharge, etc)
     ncounters_t threadId;                  //< Thread ID of issuing application
@@ -197,6 +226,7 @@ class NVMainRequest
         FLAG_FORCED = 32,               // This write can not be paused or cancelled
         FLAG_PRIORITY = 64,             // Request (or precursor) that takes priority over write
         FLAG_ISSUED = 128,              // Request has left the command queue
+        FLAG_BROADCAST = 256,           // PIM command issued alongside another in the same cycle
         FLAG_COUNT
     };
 
@@ -206,6 +236,8 @@ inline
 const NVMainRequest& NVMainRequest::operator=( const NVMainRequest& m )
 {
     address = m.address;
+    address2 = m.address2;
+    address3 = m.address3;
     type = m.type;
     bulkCmd = m.bulkCmd;
     threadId = m.threadId;
@@ -218,6 +250,10 @@ const NVMainRequest& NVMainRequest::operator=( const NVMainRequest& m )
     isPrefetch = m.isPrefetch;
     pfTrigger = m.pfTrigger;
     programCounter = m.programCounter;
+    bulkOp = m.bulkOp;
+    bulkSize = m.bulkSize;
+    bulkWidth = m.bulkWidth;
+    activateRows = m.activateRows;
     owner = m.owner;
 
     arrivalCycle = m.arrivalCycle;
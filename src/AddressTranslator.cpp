@@ -35,6 +35,7 @@
 
 #include <iostream>
 #include <cstdlib>
+#include <vector>
 
 
 #include "src/AddressTranslator.h"
@@ -53,7 +54,7 @@ AddressTranslator::AddressTranslator( )
     /* the default burst length is 8 to comply with JEDEC-DDR */
     burstLength = 8; 
 
-    lowColBits = 0;
+    UpdateLowBits( );
 }
 
 
@@ -90,9 +91,30 @@ uint64_t AddressTranslator::ReverseTranslate( const uint64_t& row,
     uint64_t phyAddr = 0;
     MemoryPartition part = MEM_UNKNOWN;
 
-    int busOffsetBits = mlog2( busWidth / 8 );
-    int burstBits = mlog2( (busWidth * burstLength) / 8 );
-    lowColBits = burstBits - busOffsetBits;
+    if( method->HasLayout( ) )
+    {
+        int lowBits = busOffsetBits + lowColBits;
+
+        phyAddr += row << (lowBits + method->GetFieldShift( MEM_ROW ));
+        phyAddr += col << (lowBits + method->GetFieldShift( MEM_COL ));
+        phyAddr += bank << (lowBits + method->GetFieldShift( MEM_BANK ));
+        phyAddr += rank << (lowBits + method->GetFieldShift( MEM_RANK ));
+        phyAddr += channel << (lowBits + method->GetFieldShift( MEM_CHANNEL ));
+        phyAddr += subarray << (lowBits + method->GetFieldShift( MEM_SUBARRAY ));
+
+        /* Count the fields above the row in units of the data rows. */
+        if( method->GetDataRows( ) != 0 )
+        {
+            unsigned int rowShift = lowBits + method->GetFieldShift( MEM_ROW );
+            unsigned int aboveShift = rowShift + GetRowBits( );
+            uint64_t above = (aboveShift < 64) ? phyAddr >> aboveShift : 0;
+
+            phyAddr &= (1ULL << rowShift) - 1;
+            phyAddr += (above * method->GetDataRows( ) + row) << rowShift;
+        }
+
+        return phyAddr;
+    }
 
     /* first of all, add the bus width */
     unitAddr <<= busOffsetBits;
@@ -114,7 +136,10 @@ uint64_t AddressTranslator::ReverseTranslate( const uint64_t& row,
         {
             case MEM_ROW:
                   phyAddr += ( row * unitAddr ); 
-                  unitAddr <<= rowBits;
+                  if( method->GetDataRows( ) != 0 )
+                      unitAddr *= method->GetDataRows( );
+                  else
+                      unitAddr <<= rowBits;
                   break;
 
             case MEM_COL:
@@ -160,6 +185,8 @@ uint64_t AddressTranslator::ReverseTranslate( const uint64_t& row,
 void AddressTranslator::SetBusWidth( int bits )
 {
     busWidth = bits;
+
+    UpdateLowBits( );
 }
 
 /* 
@@ -170,6 +197,20 @@ void AddressTranslator::SetBusWidth( int bits )
 void AddressTranslator::SetBurstLength( int beat )
 {
     burstLength = beat;
+
+    UpdateLowBits( );
+}
+
+/*
+ * UpdateLowBits() computes the bus offset and lowest column bits that are
+ * truncated from every address.
+ */
+void AddressTranslator::UpdateLowBits( )
+{
+    int burstBits = mlog2( (busWidth * burstLength) / 8 );
+
+    busOffsetBits = mlog2( busWidth / 8 );
+    lowColBits = burstBits - busOffsetBits;
 }
 
 /*
@@ -190,9 +231,6 @@ void AddressTranslator::Translate( uint64_t address, uint64_t *row, uint64_t *co
 				   uint64_t *rank, uint64_t *channel, uint64_t *subarray )
 {
     uint64_t refAddress;
-    MemoryPartition part;
-
-    uint64_t *partitions[6] = { row, col, bank, rank, channel, subarray };
 
     if( GetTranslationMethod( ) == NULL )
     {
@@ -200,16 +238,54 @@ void AddressTranslator::Translate( uint64_t address, uint64_t *row, uint64_t *co
         return;
     }
 
-    int busOffsetBits = mlog2( busWidth / 8 );
-    int burstBits = mlog2( (busWidth * burstLength) / 8 );
-    lowColBits = burstBits - busOffsetBits;
-
     /* first of all, truncate the bus offset bits */
     refAddress = address >> busOffsetBits;
 
     /* then, truncate the lowest column bits */
     refAddress >>= lowColBits;
 
+    /* Each partition is a contiguous bit field; extract it directly. */
+    if( method->HasLayout( ) )
+    {
+        if( method->GetDataRows( ) != 0 )
+            refAddress = SpreadDataRows( refAddress );
+
+        *row = (refAddress >> method->GetFieldShift( MEM_ROW )) 
+               & method->GetFieldMask( MEM_ROW );
+        *col = (refAddress >> method->GetFieldShift( MEM_COL )) 
+               & method->GetFieldMask( MEM_COL );
+        *bank = (refAddress >> method->GetFieldShift( MEM_BANK )) 
+                & method->GetFieldMask( MEM_BANK );
+        *rank = (refAddress >> method->GetFieldShift( MEM_RANK )) 
+                & method->GetFieldMask( MEM_RANK );
+        *channel = (refAddress >> method->GetFieldShift( MEM_CHANNEL )) 
+                   & method->GetFieldMask( MEM_CHANNEL );
+        *subarray = (refAddress >> method->GetFieldShift( MEM_SUBARRAY )) 
+                    & method->GetFieldMask( MEM_SUBARRAY );
+
+        return;
+    }
+
+    DivideTranslate( address, row, col, bank, rank, channel, subarray );
+} 
+
+/*
+ * DivideTranslate() walks the partitions from low to high, dividing the
+ * address by the size of each one. This is the translation for methods
+ * without a precomputed layout.
+ */
+void AddressTranslator::DivideTranslate( uint64_t address, uint64_t *row, uint64_t *col, 
+                                         uint64_t *bank, uint64_t *rank, uint64_t *channel, 
+                                         uint64_t *subarray )
+{
+    uint64_t refAddress;
+    MemoryPartition part;
+
+    uint64_t *partitions[6] = { row, col, bank, rank, channel, subarray };
+
+    refAddress = address >> busOffsetBits;
+    refAddress >>= lowColBits;
+
     /* 0->4, low to high, FindOrder() will find the correct one */
     for( int i = 0; i < 6; i++ )
     {
@@ -323,6 +399,114 @@ void AddressTranslator::SetDefaultField( TranslationField f )
     defaultField = f;
 }
 
+uint64_t AddressTranslator::GetTranslationLayout( )
+{
+    if( method == NULL || !method->HasLayout( ) || method->GetDataRows( ) != 0 )
+        return 0;
+
+    return method->GetLayout( ) 
+           | (static_cast<uint64_t>( busOffsetBits + lowColBits ) << 54) 
+           | (1ULL << 60);
+}
+
+bool AddressTranslator::TranslateAddress( NVMAddress& address )
+{
+    uint64_t row, col, bank, rank, channel, subarray;
+    uint64_t layout = GetTranslationLayout( );
+
+    if( layout != 0 && address.IsTranslated( ) 
+        && address.GetTranslationLayout( ) == layout )
+    {
+        return false;
+    }
+
+    Translate( address.GetPhysicalAddress( ), &row, &col, &bank, 
+               &rank, &channel, &subarray );
+    address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
+    address.SetTranslationLayout( layout );
+
+    return true;
+}
+
+void AddressTranslator::TranslateMany( NVMAddress *addresses, ncounter_t count )
+{
+    for( ncounter_t i = 0; i < count; i++ )
+        TranslateAddress( addresses[i] );
+}
+
+ncounter_t AddressTranslator::VerifyTranslations( uint64_t stride, ncounter_t count )
+{
+    std::vector<NVMAddress> addresses( count );
+    uint64_t lowMask = (1ULL << (busOffsetBits + lowColBits)) - 1;
+    ncounter_t mismatches = 0;
+
+    if( count == 0 )
+        return 0;
+
+    for( ncounter_t i = 0; i < count; i++ )
+        addresses[i].SetPhysicalAddress( i * stride );
+
+    TranslateMany( &addresses[0], count );
+
+    for( ncounter_t i = 0; i < count; i++ )
+    {
+        NVMAddress& address = addresses[i];
+        uint64_t row, col, bank, rank, channel, subarray;
+
+        DivideTranslate( address.GetPhysicalAddress( ), &row, &col, &bank, 
+                         &rank, &channel, &subarray );
+
+        if( row != address.GetRow( ) || col != address.GetCol( ) 
+            || bank != address.GetBank( ) || rank != address.GetRank( ) 
+            || channel != address.GetChannel( ) || subarray != address.GetSubArray( ) 
+            || ReverseTranslate( row, col, bank, rank, channel, subarray ) 
+               != (address.GetPhysicalAddress( ) & ~lowMask) )
+        {
+            if( mismatches == 0 )
+            {
+                std::cerr << "NVMain Error: Address 0x" << std::hex 
+                    << address.GetPhysicalAddress( ) << std::dec 
+                    << " translates differently with the precomputed layout." << std::endl;
+            }
+
+            mismatches++;
+        }
+    }
+
+    return mismatches;
+}
+
+/*
+ *  Rows that are not addressable are skipped by counting the fields above
+ *  the row field in units of the data rows. Rewrites such an address into
+ *  the plain bit fields of the layout.
+ */
+uint64_t AddressTranslator::SpreadDataRows( uint64_t refAddress )
+{
+    unsigned int rowShift = method->GetFieldShift( MEM_ROW );
+    unsigned int rowBits = GetRowBits( );
+    uint64_t dataRows = method->GetDataRows( );
+    uint64_t above = refAddress >> rowShift;
+    uint64_t spread = refAddress & ((1ULL << rowShift) - 1);
+
+    spread |= (above % dataRows) << rowShift;
+
+    if( rowShift + rowBits < 64 )
+        spread |= (above / dataRows) << (rowShift + rowBits);
+
+    return spread;
+}
+
+unsigned int AddressTranslator::GetRowBits( )
+{
+    unsigned int channelBits, rankBits, bankBits, rowBits, colBits, subarrayBits;
+
+    method->GetBitWidths( &rowBits, &colBits, &bankBits, 
+                          &rankBits, &channelBits, &subarrayBits );
+
+    return rowBits;
+}
+
 /*
  * Divide() right shift the physical address for address translation
  */
@@ -334,7 +518,9 @@ uint64_t AddressTranslator::Divide( uint64_t partSize, MemoryPartition partition
     method->GetBitWidths( &rowBits, &colBits, &bankBits, 
                           &rankBits, &channelBits, &subarrayBits );
     
-    if( partition == MEM_ROW )
+    if( partition == MEM_ROW && method->GetDataRows( ) != 0 )
+        retSize /= method->GetDataRows( );
+    else if( partition == MEM_ROW )
         retSize >>= rowBits;
     else if( partition == MEM_COL )
         retSize >>= ( colBits /*- lowColBits*/ );
@@ -365,7 +551,9 @@ uint64_t AddressTranslator::Modulo( uint64_t partialAddr, MemoryPartition partit
 
     uint64_t moduloSize = 1;
 
-    if( partition == MEM_ROW )
+    if( partition == MEM_ROW && method->GetDataRows( ) != 0 )
+        moduloSize = method->GetDataRows( );
+    else if( partition == MEM_ROW )
         moduloSize <<= rowBits;
     else if( partition == MEM_COL )
         moduloSize <<= ( colBits /*- lowColBits*/ );
@@ -64,7 +64,7 @@ class AddressTranslator
 
     void SetBusWidth( int );
     void SetBurstLength( int );
-    void SetTranslationMethod( TranslationMethod *m );
+    virtual void SetTranslationMethod( TranslationMethod *m );
     TranslationMethod *GetTranslationMethod( );
     
     virtual void Translate( uint64_t address, uint64_t *row, uint64_t *col, uint64_t *bank, 
@@ -80,6 +80,27 @@ class AddressTranslator
     virtual uint64_t Translate( NVMainRequest *request );
     virtual void SetDefaultField( TranslationField f ); 
 
+    /* 
+     *  Translates the physical address into the address itself, unless it
+     *  was already translated with the same layout. Returns true if the
+     *  address was translated.
+     */
+    bool TranslateAddress( NVMAddress& address );
+    void TranslateMany( NVMAddress *addresses, ncounter_t count );
+
+    /* 
+     *  Translates count addresses, stride bytes apart, with TranslateMany
+     *  and with the generic divide/modulo walk, then reverse translates
+     *  them. Returns the number of addresses that do not agree.
+     */
+    ncounter_t VerifyTranslations( uint64_t stride, ncounter_t count );
+
+    /* 
+     *  Identifies the address layout, or 0 if translations from this
+     *  translator should never be reused.
+     */
+    virtual uint64_t GetTranslationLayout( );
+
     void SetStats( Stats *stats );
     Stats *GetStats( );
 
@@ -98,11 +119,21 @@ class AddressTranslator
     int busWidth;
     int burstLength;
     int lowColBits;
+    int busOffsetBits;
+
+    void UpdateLowBits( );
 
     Stats *stats;
     std::string statName;
 
   protected:
+    /* Address bits below the column field (bus offset and burst). */
+    int GetLowBits( ) { return busOffsetBits + lowColBits; }
+
+    unsigned int GetRowBits( );
+    uint64_t SpreadDataRows( uint64_t refAddress );
+    void DivideTranslate( uint64_t address, uint64_t *row, uint64_t *col, uint64_t *bank, 
+                          uint64_t *rank, uint64_t *channel, uint64_t *subarray );
     uint64_t Divide( uint64_t partSize, MemoryPartition partition );
     uint64_t Modulo( uint64_t partialAddr, MemoryPartition partition );
     void FindOrder( int order, MemoryPartition *p );
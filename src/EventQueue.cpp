@@ -37,24 +37,15 @@
 #include "NVM/nvmain.h"
 
 #include <limits>
+#include <algorithm>
 #include <assert.h>
 
 using namespace NVM;
 
 void Event::SetRecipient( NVMObject *r )
 {
-    std::vector<NVMObject_hook *>& children = r->GetParent( )->GetTrampoline( )->GetChildren( );
-    std::vector<NVMObject_hook *>::iterator it;
-    NVMObject_hook *hook = NULL;
-
-    for( it = children.begin(); it != children.end(); it++ )
-    {
-        if( (*it)->GetTrampoline() == r )
-        {
-            hook = (*it);
-            break;
-        }
-    }
+    /* The parent has our hook in the children list, it is cached there. */
+    NVMObject_hook *hook = r->GetSelfHook( );
 
     assert( hook != NULL );
 
@@ -67,63 +58,239 @@ EventQueue::EventQueue( )
     lastEventCycle = 0;
     nextEventCycle = std::numeric_limits<ncycle_t>::max();
     currentCycle = 0;
+
+    queueModel = EventQueueModel_Map;
+    wheelBase = 0;
+    wheelSize = 0;
+    wheelMask = 0;
 }
 
 EventQueue::~EventQueue( )
 {
+    std::vector<Event *>::iterator it;
+
+    for( it = freeEvents.begin( ); it != freeEvents.end( ); it++ )
+        delete (*it);
 }
 
-void EventQueue::InsertEvent( EventType type, NVMObject *recipient, ncycle_t when, void *data, int priority )
+Event *EventQueue::AllocateEvent( )
 {
-    /* The parent has our hook in the children list, we need to find this. */
-    std::vector<NVMObject_hook *>& children = recipient->GetParent( )->GetTrampoline( )->GetChildren( );
-    std::vector<NVMObject_hook *>::iterator it;
-    NVMObject_hook *hook = NULL;
+    if( freeEvents.empty( ) )
+        return new Event( );
 
-    for( it = children.begin(); it != children.end(); it++ )
+    Event *event = freeEvents.back( );
+    freeEvents.pop_back( );
+
+    *event = Event( );
+
+    return event;
+}
+
+void EventQueue::FreeEvent( Event *event )
+{
+    freeEvents.push_back( event );
+}
+
+void EventQueue::SetConfig( Config *config )
+{
+    EventQueueModel model = EventQueueModel_Map;
+    ncycle_t size = 1024;
+
+    if( config->KeyExists( "EventQueueModel" ) )
     {
-        if( (*it)->GetTrampoline() == recipient )
+        std::string modelName = config->GetString( "EventQueueModel" );
+
+        if( modelName == "TimingWheel" )
         {
-            hook = (*it);
-            break;
+            model = EventQueueModel_TimingWheel;
+        }
+        else if( modelName != "Map" )
+        {
+            std::cout << "EventQueue: Warning: Unknown EventQueueModel '" 
+                      << modelName << "'. Using 'Map' instead." << std::endl;
         }
     }
 
-    assert( hook != NULL );
+    if( config->KeyExists( "TimingWheelSize" ) )
+        size = config->GetValueUL( "TimingWheelSize" );
 
-    InsertEvent( type, hook, NULL, when, data, priority );
+    /* The wheel is indexed by masking, so round up to a power of two. */
+    ncycle_t roundedSize = 64;
+    while( roundedSize < size )
+        roundedSize <<= 1;
+
+    /* Any events scheduled so far are moved back to the map first. */
+    FlushWheel( );
+
+    queueModel = model;
+
+    if( queueModel == EventQueueModel_TimingWheel )
+    {
+        wheelSize = roundedSize;
+        wheelMask = roundedSize - 1;
+        wheel.assign( wheelSize, EventList( ) );
+        wheelOccupied.assign( wheelSize / 64, 0 );
+
+        wheelBase = currentCycle;
+        if( nextEventCycle != std::numeric_limits<ncycle_t>::max( ) )
+            wheelBase = nextEventCycle;
+
+        AdvanceWheel( wheelBase );
+    }
+    else
+    {
+        wheelSize = wheelMask = 0;
+        wheel.clear( );
+        wheelOccupied.clear( );
+    }
 }
 
-void EventQueue::InsertEvent( EventType type, NVMObject_hook *recipient, ncycle_t when, void *data, int priority )
+/*
+ *  A cycle lives in the wheel iff it is within wheelSize cycles of the
+ *  wheel base. Everything else (past or far-future cycles) is kept in the
+ *  overflow map. No cycle ever has events in both tiers.
+ */
+bool EventQueue::InWheel( ncycle_t when ) const
 {
-    InsertEvent( type, recipient, NULL, when, data, priority );
+    return (queueModel == EventQueueModel_TimingWheel && when >= wheelBase 
+            && when - wheelBase < wheelSize);
 }
 
-void EventQueue::InsertEvent( EventType type, NVMObject *recipient, NVMainRequest *req, ncycle_t when, void *data, int priority )
+EventList *EventQueue::GetEventList( ncycle_t when )
+{
+    return const_cast<EventList *>( 
+               static_cast<const EventQueue *>(this)->GetEventList( when ) );
+}
+
+const EventList *EventQueue::GetEventList( ncycle_t when ) const
+{
+    const EventList *rv = NULL;
+
+    if( InWheel( when ) )
+    {
+        if( !wheel[when & wheelMask].empty( ) )
+            rv = &wheel[when & wheelMask];
+    }
+    else
+    {
+        std::map<ncycle_t, EventList>::const_iterator it = eventMap.find( when );
+
+        if( it != eventMap.end( ) )
+            rv = &(it->second);
+    }
+
+    return rv;
+}
+
+void EventQueue::AdvanceWheel( ncycle_t base )
+{
+    if( base < wheelBase )
+        return;
+
+    wheelBase = base;
+
+    /* Pull overflow events that are now within the wheel window. */
+    std::map<ncycle_t, EventList>::iterator it = eventMap.lower_bound( wheelBase );
+
+    while( it != eventMap.end( ) && it->first - wheelBase < wheelSize )
+    {
+        ncycle_t slot = it->first & wheelMask;
+
+        assert( wheel[slot].empty( ) );
+
+        wheel[slot].splice( wheel[slot].end( ), it->second );
+        wheelOccupied[slot >> 6] |= (1ULL << (slot & 63));
+
+        eventMap.erase( it++ );
+    }
+}
+
+void EventQueue::FlushWheel( )
+{
+    if( queueModel != EventQueueModel_TimingWheel )
+        return;
+
+    for( ncycle_t slot = 0; slot < wheelSize; slot++ )
+    {
+        if( wheel[slot].empty( ) )
+            continue;
+
+        ncycle_t when = wheel[slot].front( )->GetCycle( );
+        EventList& eventList = eventMap[when];
+
+        eventList.splice( eventList.end( ), wheel[slot] );
+    }
+
+    wheelOccupied.assign( wheelOccupied.size( ), 0 );
+}
+
+ncycle_t EventQueue::FindNextWheelCycle( ) const
 {
-    /* The parent has our hook in the children list, we need to find this. */
-    std::vector<NVMObject_hook *>& children = recipient->GetParent( )->GetTrampoline( )->GetChildren( );
-    std::vector<NVMObject_hook *>::iterator it;
-    NVMObject_hook *hook = NULL;
+    ncycle_t start = wheelBase & wheelMask;
+    ncycle_t words = wheelSize >> 6;
 
-    for( it = children.begin(); it != children.end(); it++ )
+    /* 
+     *  Scan the occupancy bitmap starting at the wheel base. The first word
+     *  is visited twice: once for the slots at or after the base and once
+     *  more after wrapping around for the slots before it.
+     */
+    for( ncycle_t i = 0; i <= words; i++ )
     {
-        if( (*it)->GetTrampoline() == recipient )
+        ncycle_t word = ((start >> 6) + i) % words;
+        uint64_t bits = wheelOccupied[word];
+
+        if( i == 0 )
+            bits &= (~0ULL << (start & 63));
+        else if( i == words )
+            bits &= ((1ULL << (start & 63)) - 1);
+
+        if( bits != 0 )
         {
-            hook = (*it);
-            break;
+            ncycle_t slot = (word << 6) + __builtin_ctzll( bits );
+
+            return wheelBase + ((slot - start) & wheelMask);
         }
     }
 
-    assert( hook != NULL );
+    return std::numeric_limits<ncycle_t>::max( );
+}
+
+void EventQueue::UpdateNextEvent( )
+{
+    nextEventCycle = std::numeric_limits<ncycle_t>::max( );
+
+    /* map is sorted by keys, so this works out. */
+    if( !eventMap.empty( ) )
+        nextEventCycle = eventMap.begin( )->first;
+
+    if( queueModel == EventQueueModel_TimingWheel )
+    {
+        ncycle_t nextWheelCycle = FindNextWheelCycle( );
+
+        if( nextWheelCycle < nextEventCycle )
+            nextEventCycle = nextWheelCycle;
+    }
+}
+
+void EventQueue::InsertEvent( EventType type, NVMObject *recipient, ncycle_t when, void *data, int priority )
+{
+    InsertEvent( type, FindHook( recipient ), NULL, when, data, priority );
+}
+
+void EventQueue::InsertEvent( EventType type, NVMObject_hook *recipient, ncycle_t when, void *data, int priority )
+{
+    InsertEvent( type, recipient, NULL, when, data, priority );
+}
 
-    InsertEvent( type, hook, req, when, data, priority );
+void EventQueue::InsertEvent( EventType type, NVMObject *recipient, NVMainRequest *req, ncycle_t when, void *data, int priority )
+{
+    InsertEvent( type, FindHook( recipient ), req, when, data, priority );
 }
 
 void EventQueue::InsertEvent( EventType type, NVMObject_hook *recipient, NVMainRequest *req, ncycle_t when, void *data, int priority )
 {
     /* Create our event */
-    Event *event = new Event( );
+    Event *event = AllocateEvent( );
 
     event->SetType( type );
     event->SetRecipient( recipient );
@@ -138,25 +305,44 @@ void EventQueue::InsertEvent( Event *event, ncycle_t when, int priority )
 {
     event->SetCycle( when );
 
+    /* An empty timing wheel can be moved up to the new event for free. */
+    if( queueModel == EventQueueModel_TimingWheel && when > wheelBase
+        && nextEventCycle == std::numeric_limits<ncycle_t>::max( ) )
+    {
+        wheelBase = when;
+    }
+
     /* If this event time is before our previous nextEventCycle, change it. */
     if( when < nextEventCycle )
     {
         nextEventCycle = when;
     }
 
+    EventList *existingList = GetEventList( when );
+
     /* If there are no events at this time, create a new mapping. */ 
-    if( eventMap.count( when ) == 0 )
+    if( existingList == NULL )
     {
-        EventList eventList;
+        if( InWheel( when ) )
+        {
+            ncycle_t slot = when & wheelMask;
 
-        eventList.push_back( event );
+            wheel[slot].push_back( event );
+            wheelOccupied[slot >> 6] |= (1ULL << (slot & 63));
+        }
+        else
+        {
+            EventList eventList;
 
-        eventMap.insert( std::pair<ncycle_t, EventList>( when, eventList ) );
+            eventList.push_back( event );
+
+            eventMap.insert( std::pair<ncycle_t, EventList>( when, eventList ) );
+        }
     }
     /* Otherwise append this event to the event list for this cycle. */
     else
     {
-        EventList& eventList = eventMap[when];
+        EventList& eventList = *existingList;
 
         EventList::iterator it;
         bool inserted = false;
@@ -176,13 +362,15 @@ void EventQueue::InsertEvent( Event *event, ncycle_t when, int priority )
             eventList.push_back( event );
         }
     }
+
+    IndexEvent( event );
 }
 
 
 void EventQueue::InsertCallback( NVMObject *recipient, CallbackPtr method,
                                  ncycle_t when, void *data, int priority )
 {
-    Event *event = new Event( );
+    Event *event = AllocateEvent( );
 
     event->SetType( EventCallback );
     event->SetRecipient( recipient );
@@ -198,40 +386,45 @@ void EventQueue::InsertCallback( NVMObject *recipient, CallbackPtr method,
 bool EventQueue::RemoveEvent( Event *event, ncycle_t when )
 {
     bool rv = false;
+    EventList *existingList = GetEventList( when );
 
-    if( eventMap.count( when ) == 0 )
+    if( existingList == NULL )
     {
         rv = false;
     }
     else
     {
-        EventList& eventList = eventMap[when];
+        EventList& eventList = *existingList;
 
         EventList::iterator it;
         for( it = eventList.begin(); it != eventList.end(); it++ )
         {
             if( (*it) == event )
             {
+                UnindexEvent( event );
                 eventList.erase( it );
 
                 rv = true;
 
                 /* If the list is empty now, we can also erase the map entry. */
                 if( eventList.empty() )
-                    eventMap.erase( when );
+                {
+                    if( InWheel( when ) )
+                    {
+                        ncycle_t slot = when & wheelMask;
+                        wheelOccupied[slot >> 6] &= ~(1ULL << (slot & 63));
+                    }
+                    else
+                    {
+                        eventMap.erase( when );
+                    }
+                }
 
                 break;
             }
         }
 
-        if( eventMap.empty() )
-        {
-            nextEventCycle = std::numeric_limits<uint64_t>::max( );
-        }
-        else
-        {
-            nextEventCycle = eventMap.begin()->first;
-        }
+        UpdateNextEvent( );
     }
 
     return rv;
@@ -240,34 +433,19 @@ bool EventQueue::RemoveEvent( Event *event, ncycle_t when )
 
 Event *EventQueue::FindEvent( EventType type, NVMObject *recipient, NVMainRequest *req, ncycle_t when ) const
 {
-    /* The parent has our hook in the children list, we need to find this. */
-    std::vector<NVMObject_hook *>& children = recipient->GetParent( )->GetTrampoline( )->GetChildren( );
-    std::vector<NVMObject_hook *>::iterator it;
-    NVMObject_hook *hook = NULL;
-
-    for( it = children.begin(); it != children.end(); it++ )
-    {
-        if( (*it)->GetTrampoline() == recipient )
-        {
-            hook = (*it);
-            break;
-        }
-    }
-
-    assert( hook != NULL );
-
-    return FindEvent( type, hook, req, when );
+    return FindEvent( type, FindHook( recipient ), req, when );
 }
 
 
 Event *EventQueue::FindEvent( EventType type, NVMObject_hook *recipient, NVMainRequest *req, ncycle_t when ) const
 {
     Event *rv = NULL;
+    const EventList *existingList = GetEventList( when );
 
-    if (eventMap.count(when) == 0) {
+    if (existingList == NULL) {
         return rv;
     } else {
-        const EventList& eventList = eventMap.find(when)->second;
+        const EventList& eventList = *existingList;
 
         EventList::const_iterator it;
         for( it = eventList.begin(); it != eventList.end(); it++ )
@@ -286,10 +464,11 @@ Event *EventQueue::FindEvent( EventType type, NVMObject_hook *recipient, NVMainR
 Event *EventQueue::FindCallback( NVMObject *recipient, CallbackPtr method, ncycle_t when, void *data, int priority ) const
 {
     Event *rv = NULL;
+    const EventList *existingList = GetEventList( when );
 
-    if( eventMap.count(when) != 0 )
+    if( existingList != NULL )
     {
-        const EventList& eventList = eventMap.find(when)->second;
+        const EventList& eventList = *existingList;
 
         EventList::const_iterator it;
         for( it = eventList.begin(); it != eventList.end(); it++ )
@@ -309,6 +488,135 @@ Event *EventQueue::FindCallback( NVMObject *recipient, CallbackPtr method, ncycl
 }
 
 
+bool EventQueue::IsEventScheduled( EventType type, NVMObject *recipient, NVMainRequest *req, ncycle_t when ) const
+{
+    EventKey key = MakeEventKey( type, FindHook( recipient ), req, when );
+
+    return (eventIndex.count( key ) != 0);
+}
+
+
+bool EventQueue::IsCallbackScheduled( NVMObject *recipient, CallbackPtr method, ncycle_t when, void *data, int priority ) const
+{
+    EventKey key = MakeCallbackKey( recipient, method, when, data, priority );
+
+    return (eventIndex.count( key ) != 0);
+}
+
+
+bool EventQueue::InsertUniqueEvent( EventType type, NVMObject *recipient, ncycle_t when, void *data, int priority )
+{
+    NVMObject_hook *hook = FindHook( recipient );
+
+    if( eventIndex.count( MakeEventKey( type, hook, NULL, when ) ) != 0 )
+        return false;
+
+    InsertEvent( type, hook, NULL, when, data, priority );
+
+    return true;
+}
+
+
+bool EventQueue::InsertUniqueCallback( NVMObject *recipient, CallbackPtr method, ncycle_t when, void *data, int priority )
+{
+    if( eventIndex.count( MakeCallbackKey( recipient, method, when, data, priority ) ) != 0 )
+        return false;
+
+    InsertCallback( recipient, method, when, data, priority );
+
+    return true;
+}
+
+
+NVMObject_hook *EventQueue::FindHook( NVMObject *recipient ) const
+{
+    /* The parent has our hook in the children list, it is cached there. */
+    NVMObject_hook *hook = recipient->GetSelfHook( );
+
+    assert( hook != NULL );
+
+    return hook;
+}
+
+
+EventKey EventQueue::MakeEventKey( EventType type, NVMObject_hook *recipient, NVMainRequest *req, ncycle_t when ) const
+{
+    EventKey key;
+
+    key.cycle = when;
+    key.type = type;
+    key.recipient = recipient;
+    key.request = req;
+    key.method = NULL;
+    key.data = NULL;
+    key.priority = 0;
+
+    return key;
+}
+
+
+EventKey EventQueue::MakeCallbackKey( NVMObject *recipient, CallbackPtr method, ncycle_t when, void *data, int priority ) const
+{
+    EventKey key;
+
+    key.cycle = when;
+    key.type = EventCallback;
+    key.recipient = recipient;
+    key.request = NULL;
+    key.method = method;
+    key.data = data;
+    key.priority = priority;
+
+    return key;
+}
+
+
+EventKey EventQueue::MakeKey( Event *event ) const
+{
+    if( event->GetType( ) == EventCallback )
+    {
+        return MakeCallbackKey( event->GetRecipient( )->GetTrampoline( ), 
+                                event->GetCallback( ), event->GetCycle( ),
+                                event->GetData( ), event->GetPriority( ) );
+    }
+
+    return MakeEventKey( event->GetType( ), event->GetRecipient( ), 
+                         event->GetRequest( ), event->GetCycle( ) );
+}
+
+
+void EventQueue::IndexEvent( Event *event )
+{
+    eventIndex[MakeKey( event )]++;
+}
+
+
+void EventQueue::UnindexEvent( Event *event )
+{
+    std::unordered_map<EventKey, ncounter_t, EventKeyHash>::iterator it;
+
+    it = eventIndex.find( MakeKey( event ) );
+
+    if( it != eventIndex.end( ) && --(it->second) == 0 )
+        eventIndex.erase( it );
+}
+
+
+size_t EventKeyHash::operator()( const EventKey& k ) const
+{
+    /* The callback method is left out since member pointers can not be hashed portably. */
+    size_t hash = static_cast<size_t>( k.cycle );
+
+    hash = hash * 31 + static_cast<size_t>( k.type );
+    hash = hash * 31 + reinterpret_cast<size_t>( k.recipient );
+    hash = hash * 31 + reinterpret_cast<size_t>( k.request );
+    hash = hash * 31 + reinterpret_cast<size_t>( k.data );
+    hash = hash * 31 + static_cast<size_t>( k.priority );
+
+    return hash;
+}
+
+
 void EventQueue::Loop( )
 {
     /* 
@@ -355,12 +663,60 @@ void EventQueue::Loop( ncycle_t steps )
 }
 
 
+/*
+ *  Move the current cycle and every scheduled event forward by the same
+ *  number of cycles without processing anything in between. The caller is
+ *  responsible for accounting for whatever would have happened meanwhile.
+ */
+void EventQueue::Shift( ncycle_t cycles )
+{
+    std::map< ncycle_t, EventList> shiftedMap;
+    std::map< ncycle_t, EventList>::iterator it;
+
+    FlushWheel( );
+    eventIndex.clear( );
+
+    for( it = eventMap.begin( ); it != eventMap.end( ); it++ )
+    {
+        EventList& eventList = shiftedMap[it->first + cycles];
+        EventList::iterator eit;
+
+        for( eit = it->second.begin( ); eit != it->second.end( ); eit++ )
+        {
+            (*eit)->SetCycle( (*eit)->GetCycle( ) + cycles );
+            IndexEvent( (*eit) );
+        }
+
+        eventList.splice( eventList.end( ), it->second );
+    }
+
+    eventMap.swap( shiftedMap );
+
+    currentCycle += cycles;
+    lastEventCycle += cycles;
+
+    /* The wheel was flushed, so it may start over at the current cycle. */
+    if( queueModel == EventQueueModel_TimingWheel )
+    {
+        wheelBase = currentCycle;
+        AdvanceWheel( wheelBase );
+    }
+
+    UpdateNextEvent( );
+}
+
+
 void EventQueue::Process( )
 {
     /* Process all the events at the next cycle, and figure out the next next cycle. */
-    assert( eventMap.count( nextEventCycle ) );
+    if( queueModel == EventQueueModel_TimingWheel )
+        AdvanceWheel( nextEventCycle );
 
-    EventList& eventList = eventMap[nextEventCycle];
+    EventList *existingList = GetEventList( nextEventCycle );
+
+    assert( existingList != NULL );
+
+    EventList& eventList = *existingList;
     EventList::iterator it;
 
     for( it = eventList.begin( ); it != eventList.end( ); it++ )
@@ -398,23 +754,25 @@ void EventQueue::Process( )
         }
 
         /* Free event data */
-        delete (*it);
+        UnindexEvent( (*it) );
+        FreeEvent( (*it) );
     }
 
-    eventMap.erase( nextEventCycle );
-
-    /* Figure out the next cycle. */
-    if( eventMap.empty( ) )
+    if( InWheel( nextEventCycle ) )
     {
-        lastEventCycle = nextEventCycle;
-        nextEventCycle = std::numeric_limits<ncycle_t>::max();
+        ncycle_t slot = nextEventCycle & wheelMask;
+
+        eventList.clear( );
+        wheelOccupied[slot >> 6] &= ~(1ULL << (slot & 63));
     }
     else
     {
-        lastEventCycle = nextEventCycle;
-        /* map is sorted by keys, so this works out. */
-        nextEventCycle = eventMap.begin()->first; 
+        eventMap.erase( nextEventCycle );
     }
+
+    /* Figure out the next cycle. */
+    lastEventCycle = nextEventCycle;
+    UpdateNextEvent( );
 }
 
 void EventQueue::SetFrequency( double freq )
@@ -446,11 +804,26 @@ void EventQueue::SetCurrentCycle( ncycle_t curCycle )
 GlobalEventQueue::GlobalEventQueue( )
 {
     currentCycle = 0;
+    systemLookahead = 0;
+    threadCount = 1;
+    workerGeneration = 0;
+    workersBusy = 0;
+    workersExit = false;
 }
 
 GlobalEventQueue::~GlobalEventQueue( )
 {
+    if( !workers.empty( ) )
+    {
+        {
+            std::unique_lock<std::mutex> lock( workerMutex );
+            workersExit = true;
+        }
+        workerStart.notify_all( );
 
+        for( size_t i = 0; i < workers.size( ); i++ )
+            workers[i].join( );
+    }
 }
 
 void GlobalEventQueue::AddSystem( NVMain *subSystem, Config *config )
@@ -467,19 +840,82 @@ void GlobalEventQueue::AddSystem( NVMain *subSystem, Config *config )
      */
     eventQueues.insert( std::pair<EventQueue*, double>(queue, subSystemFrequency) );
     queue->SetFrequency( subSystemFrequency );
+    queue->SetConfig( config );
+    systems.push_back( subSystem );
+
+    /* Worker threads used for channels simulated in parallel. */
+    if( systems.size( ) == 1 )
+    {
+        threadCount = std::thread::hardware_concurrency( );
+
+        if( config->KeyExists( "ParallelThreads" ) )
+            threadCount = config->GetValueUL( "ParallelThreads" );
+
+        if( threadCount == 0 )
+            threadCount = 1;
+
+        /* Systems exchange requests over a link with this latency. */
+        if( config->KeyExists( "ParallelSystems" ) 
+            && config->GetString( "ParallelSystems" ) == "true" )
+        {
+            systemLookahead = 20;
+
+            if( config->KeyExists( "SystemLookahead" ) )
+                systemLookahead = config->GetValueUL( "SystemLookahead" );
+
+            if( systemLookahead == 0 )
+                systemLookahead = 1;
+
+            std::cout << "NVMain: GlobalEventQueue: Memory subsystems are linked with a "
+                      << "lookahead of " << systemLookahead << " cycles." << std::endl;
+        }
+    }
 
     std::cout << "NVMain: GlobalEventQueue: Added a memory subsystem running at "
               << config->GetEnergy( "CLK" ) << "MHz. My frequency is "
               << (frequency / 1000000.0) << "MHz." << std::endl;
 }
 
+void GlobalEventQueue::AddChannelQueue( NVMain *subSystem, EventQueue *queue )
+{
+    std::map<EventQueue *, double>::iterator iter;
+
+    iter = eventQueues.find( subSystem->GetEventQueue( ) );
+
+    assert( iter != eventQueues.end( ) );
+
+    /* Channel queues run at the frequency of the system they belong to. */
+    eventQueues.insert( std::pair<EventQueue*, double>(queue, iter->second) );
+    queue->SetFrequency( iter->second );
+    queue->SetCurrentCycle( iter->first->GetCurrentCycle( ) );
+    channelQueues.push_back( queue );
+    channelSystemQueues.push_back( iter->first );
+}
+
 void GlobalEventQueue::Cycle( ncycle_t steps )
 {
     EventQueue *nextEventQueue;
     ncycle_t iterationSteps = 0;
 
+    if( systemLookahead > 0 && systems.size( ) > 1 )
+    {
+        CycleSystems( steps );
+        return;
+    }
+
+    if( PrepareParallelCycle( currentCycle + steps ) )
+    {
+        CycleParallel( steps );
+        return;
+    }
+
     while( iterationSteps <= steps )
     {
+        ncycle_t fastForwardStart = currentCycle;
+
+        if( FastForward( currentCycle + steps - iterationSteps ) )
+            iterationSteps += currentCycle - fastForwardStart;
+
         ncycle_t nextEvent = GetNextEvent( &nextEventQueue );
 
         ncycle_t globalQueueSteps = 0;
@@ -567,6 +1003,314 @@ void GlobalEventQueue::Sync( )
             iter->first->Loop( stepCount );
         }
     }
+
+    /*
+     *  A single system queue may have been looped past the synced cycle to 
+     *  reach an event. Keep the channel queues of a system on the same cycle 
+     *  so they behave as if they shared one queue.
+     */
+    for( size_t i = 0; i < channelQueues.size( ); i++ )
+    {
+        if( channelQueues[i]->GetCurrentCycle( ) > channelSystemQueues[i]->GetCurrentCycle( ) )
+        {
+            channelSystemQueues[i]->Loop( channelQueues[i]->GetCurrentCycle( ) 
+                                          - channelSystemQueues[i]->GetCurrentCycle( ) );
+        }
+    }
+
+    for( size_t i = 0; i < channelQueues.size( ); i++ )
+    {
+        if( channelSystemQueues[i]->GetCurrentCycle( ) > channelQueues[i]->GetCurrentCycle( ) )
+        {
+            channelQueues[i]->Loop( channelSystemQueues[i]->GetCurrentCycle( ) 
+                                    - channelQueues[i]->GetCurrentCycle( ) );
+        }
+    }
+}
+
+/*
+ *  Lets a single system skip over idle time on its own. The system queue
+ *  may end up ahead of the global cycle afterwards, as after any Loop( ).
+ */
+bool GlobalEventQueue::FastForward( ncycle_t target )
+{
+    if( systems.size( ) != 1 || eventQueues.size( ) != 1 )
+        return false;
+
+    double frequencyMultiplier = frequency / eventQueues.begin( )->second;
+    EventQueue *queue = eventQueues.begin( )->first;
+
+    if( !systems[0]->FastForward( GetLocalTarget( frequencyMultiplier, target ) ) )
+        return false;
+
+    ncycle_t queueCycle = static_cast<ncycle_t>( queue->GetCurrentCycle( ) * frequencyMultiplier );
+
+    if( queueCycle > currentCycle )
+        currentCycle = std::min( queueCycle, target );
+
+    return true;
+}
+
+ncycle_t GlobalEventQueue::GetLocalTarget( double frequencyMultiplier, ncycle_t target )
+{
+    /* 
+     *  Find the last local cycle that GetNextEvent( ) would map to a global
+     *  cycle no later than target. This may be one past the cycle Sync( ) 
+     *  would set when the frequencies do not divide evenly.
+     */
+    ncycle_t localTarget = static_cast<ncycle_t>( static_cast<double>(target) / frequencyMultiplier );
+
+    while( static_cast<ncycle_t>( (localTarget + 1) * frequencyMultiplier ) <= target )
+        localTarget++;
+
+    return localTarget;
+}
+
+bool GlobalEventQueue::IsChannelQueue( EventQueue *queue )
+{
+    std::vector<EventQueue *>::iterator it;
+
+    for( it = channelQueues.begin( ); it != channelQueues.end( ); it++ )
+    {
+        if( (*it) == queue )
+            return true;
+    }
+
+    return false;
+}
+
+bool GlobalEventQueue::PrepareParallelCycle( ncycle_t target )
+{
+    std::map<EventQueue *, double>::const_iterator iter;
+
+    if( channelQueues.size( ) < 2 || threadCount < 2 || systems.size( ) != 1 )
+        return false;
+
+    activeQueues.clear( );
+    activeTargets.clear( );
+    activeSyncCycles.clear( );
+
+    for( iter = eventQueues.begin( ); iter != eventQueues.end( ); iter++ )
+    {
+        if( iter->first->GetNextEvent( ) == std::numeric_limits<ncycle_t>::max( ) )
+            continue;
+
+        double frequencyMultiplier = frequency / iter->second;
+        ncycle_t localTarget = GetLocalTarget( frequencyMultiplier, target );
+
+        if( iter->first->GetNextEvent( ) > localTarget )
+            continue;
+
+        /* 
+         *  Events outside of the channels (e.g., prefetch responses) may 
+         *  interact with any channel. Run the serial loop in this case.
+         */
+        if( !IsChannelQueue( iter->first ) )
+            return false;
+
+        activeQueues.push_back( iter->first );
+        activeTargets.push_back( localTarget );
+        activeSyncCycles.push_back( static_cast<ncycle_t>( 
+                    static_cast<double>(target) / frequencyMultiplier ) );
+    }
+
+    /* Not worth waking the workers for a single channel. */
+    return (activeQueues.size( ) >= 2);
+}
+
+void GlobalEventQueue::AdvanceQueue( EventQueue *queue, ncycle_t localTarget, ncycle_t syncCycle )
+{
+    /* Same sequence of Loop( ) calls as the serial Cycle( ) for this queue. */
+    while( queue->GetNextEvent( ) <= localTarget )
+    {
+        queue->Loop( queue->GetNextEvent( ) - queue->GetCurrentCycle( ) );
+    }
+
+    if( syncCycle > queue->GetCurrentCycle( ) )
+        queue->Loop( syncCycle - queue->GetCurrentCycle( ) );
+}
+
+void GlobalEventQueue::AdvanceActiveQueues( ncounter_t worker )
+{
+    ncounter_t workerCount = workers.size( ) + 1;
+
+    for( ncounter_t i = worker; i < activeQueues.size( ); i += workerCount )
+    {
+        AdvanceQueue( activeQueues[i], activeTargets[i], activeSyncCycles[i] );
+    }
+}
+
+void GlobalEventQueue::WorkerLoop( ncounter_t worker )
+{
+    ncounter_t generation = 0;
+
+    while( true )
+    {
+        {
+            std::unique_lock<std::mutex> lock( workerMutex );
+
+            while( !workersExit && workerGeneration == generation )
+                workerStart.wait( lock );
+
+            if( workersExit )
+                return;
+
+            generation = workerGeneration;
+        }
+
+        AdvanceActiveQueues( worker );
+
+        {
+            std::unique_lock<std::mutex> lock( workerMutex );
+
+            workersBusy--;
+            if( workersBusy == 0 )
+                workerDone.notify_one( );
+        }
+    }
+}
+
+void GlobalEventQueue::RunActiveQueues( )
+{
+    std::vector<NVMain *>::iterator it;
+
+    /* The calling thread acts as worker 0. */
+    if( workers.empty( ) )
+    {
+        ncounter_t workerCount = std::min( threadCount, 
+                                 static_cast<ncounter_t>(eventQueues.size( )) );
+
+        for( ncounter_t i = 1; i < workerCount; i++ )
+            workers.push_back( std::thread( &GlobalEventQueue::WorkerLoop, this, i ) );
+    }
+
+    for( it = systems.begin( ); it != systems.end( ); it++ )
+        (*it)->DeferCompletions( true );
+
+    {
+        std::unique_lock<std::mutex> lock( workerMutex );
+
+        workersBusy = workers.size( );
+        workerGeneration++;
+    }
+    workerStart.notify_all( );
+
+    AdvanceActiveQueues( 0 );
+
+    {
+        std::unique_lock<std::mutex> lock( workerMutex );
+
+        while( workersBusy != 0 )
+            workerDone.wait( lock );
+    }
+
+    /* Hand the completions to the parents in cycle order. */
+    for( it = systems.begin( ); it != systems.end( ); it++ )
+        (*it)->DeferCompletions( false );
+}
+
+void GlobalEventQueue::CycleParallel( ncycle_t steps )
+{
+    RunActiveQueues( );
+
+    currentCycle += steps;
+    Sync( );
+}
+
+void GlobalEventQueue::CycleSystems( ncycle_t steps )
+{
+    std::map<EventQueue *, double>::const_iterator iter;
+    std::vector<NVMain *>::iterator it;
+    ncycle_t target = currentCycle + steps;
+
+    while( true )
+    {
+        ncycle_t nextEvent = GetNextEvent( );
+
+        if( nextEvent > target )
+            break;
+
+        /*
+         *  Requests sent between systems arrive SystemLookahead cycles later,
+         *  so nothing sent in this window can arrive before it ends.
+         */
+        ncycle_t windowEnd = std::min( target, std::max( nextEvent, currentCycle ) 
+                                               + systemLookahead - 1 );
+
+        activeQueues.clear( );
+        activeTargets.clear( );
+        activeSyncCycles.clear( );
+
+        for( iter = eventQueues.begin( ); iter != eventQueues.end( ); iter++ )
+        {
+            double frequencyMultiplier = frequency / iter->second;
+            ncycle_t localTarget = GetLocalTarget( frequencyMultiplier, windowEnd );
+
+            if( iter->first->GetNextEvent( ) > localTarget )
+                continue;
+
+            activeQueues.push_back( iter->first );
+            activeTargets.push_back( localTarget );
+            activeSyncCycles.push_back( static_cast<ncycle_t>( 
+                        static_cast<double>(windowEnd) / frequencyMultiplier ) );
+        }
+
+        /* The result is the same for any number of threads. */
+        if( activeQueues.size( ) >= 2 && threadCount >= 2 )
+        {
+            RunActiveQueues( );
+        }
+        else
+        {
+            for( size_t i = 0; i < activeQueues.size( ); i++ )
+                AdvanceQueue( activeQueues[i], activeTargets[i], activeSyncCycles[i] );
+        }
+
+        for( it = systems.begin( ); it != systems.end( ); it++ )
+            (*it)->DeliverLinkRequests( );
+
+        currentCycle = windowEnd;
+        Sync( );
+
+        if( windowEnd == target )
+            break;
+    }
+
+    currentCycle = target;
+    Sync( );
 }
 
+ncycle_t GlobalEventQueue::GetSystemLookahead( )
+{
+    return systemLookahead;
+}
+
+ncycle_t GlobalEventQueue::GetArrivalCycle( EventQueue *source, EventQueue *destination )
+{
+    std::map<EventQueue *, double>::const_iterator sourceIter, destinationIter;
+
+    sourceIter = eventQueues.find( source );
+    destinationIter = eventQueues.find( destination );
+
+    assert( sourceIter != eventQueues.end( ) );
+    assert( destinationIter != eventQueues.end( ) );
 
+    double sourceMultiplier = frequency / sourceIter->second;
+    double destinationMultiplier = frequency / destinationIter->second;
+
+    /* A slower source may lag behind the start of the current window. */
+    ncycle_t sent = static_cast<ncycle_t>( source->GetCurrentCycle( ) * sourceMultiplier );
+    ncycle_t arrival = std::max( sent, currentCycle ) + systemLookahead;
+
+    /* First destination cycle that GetNextEvent( ) maps to the arrival or later. */
+    ncycle_t arrivalCycle = static_cast<ncycle_t>( static_cast<double>(arrival) / destinationMultiplier );
+
+    while( arrivalCycle > 0 
+           && static_cast<ncycle_t>( (arrivalCycle - 1) * destinationMultiplier ) >= arrival )
+        arrivalCycle--;
+
+    while( static_cast<ncycle_t>( arrivalCycle * destinationMultiplier ) < arrival )
+        arrivalCycle++;
+
+    return arrivalCycle;
+}
@@ -36,6 +36,12 @@
 
 #include <map>
 #include <list>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
 #include "include/NVMTypes.h"
 #include "include/NVMainRequest.h"
 
@@ -60,7 +66,7 @@ enum EventType { EventUnknown,
 class Event
 {
   public:
-    Event() : type(EventUnknown), recipient(NULL), request(NULL), data(NULL), cycle(0), priority(0) {}
+    Event() : type(EventUnknown), recipient(NULL), request(NULL), data(NULL), cycle(0), priority(0), method(NULL) {}
     ~Event() {}
 
     void SetType( EventType e ) { type = e; }
@@ -91,12 +97,53 @@ class Event
 };
 
 
+/*
+ *  Key used to index scheduled events for duplicate detection. Callbacks are
+ *  identified by the object, method, data and priority, and all other events
+ *  by the recipient hook and request, matching FindCallback and FindEvent.
+ */
+struct EventKey
+{
+    ncycle_t cycle;
+    EventType type;
+    void *recipient;
+    NVMainRequest *request;
+    CallbackPtr method;
+    void *data;
+    int priority;
+
+    bool operator==( const EventKey& k ) const
+    {
+        return (cycle == k.cycle && type == k.type && recipient == k.recipient
+                && request == k.request && method == k.method 
+                && data == k.data && priority == k.priority);
+    }
+};
+
+struct EventKeyHash
+{
+    size_t operator()( const EventKey& k ) const;
+};
+
+/*
+ *  EventQueue backends. The default map backend keeps every cycle in a
+ *  std::map. The timing wheel keeps near-future cycles in a ring of buckets
+ *  indexed by cycle and spills far-future events (e.g., refresh) into the
+ *  map, which is used as an overflow tier. Both backends process events in
+ *  the same order.
+ */
+enum EventQueueModel { EventQueueModel_Map,
+                       EventQueueModel_TimingWheel
+};
+
 class EventQueue
 {
   public:
     EventQueue();
     ~EventQueue();
 
+    void SetConfig( Config *config );
+
     void InsertEvent( EventType type, NVMObject_hook *recipient, NVMainRequest *req, ncycle_t when, void *data = NULL, int priority = 0 );
     void InsertEvent( EventType type, NVMObject *recipient, NVMainRequest *req, ncycle_t when, void *data = NULL, int priority = 0 );
     void InsertEvent( EventType type, NVMObject_hook *recipient, ncycle_t when, void *data = NULL, int priority = 0 );
@@ -110,11 +157,22 @@ class EventQueue
 
     Event *FindCallback( NVMObject *recipient, CallbackPtr method, ncycle_t when, void *data = NULL, int priority = 0 ) const;
 
+    bool IsEventScheduled( EventType type, NVMObject *recipient, NVMainRequest *req, ncycle_t when ) const;
+    bool IsCallbackScheduled( NVMObject *recipient, CallbackPtr method, ncycle_t when, void *data = NULL, int priority = 0 ) const;
+
+    /* Insert only if no matching event is scheduled. Returns true if inserted. */
+    bool InsertUniqueEvent( EventType type, NVMObject *recipient, ncycle_t when, void *data = NULL, int priority = 0 );
+    bool InsertUniqueCallback( NVMObject *recipient, CallbackPtr method, ncycle_t when, void *data = NULL, int priority = 0 );
+
     bool RemoveEvent( Event *event, ncycle_t when );
 
+    Event *AllocateEvent( );
+    void FreeEvent( Event *event );
+
     void Process( );
     void Loop( );
     void Loop( ncycle_t steps );
+    void Shift( ncycle_t cycles );
 
     void SetFrequency( double freq );
     double GetFrequency( );
@@ -130,6 +188,34 @@ class EventQueue
     double frequency;
 
     std::map< ncycle_t, EventList> eventMap; 
+
+    /* Processed events are kept here and handed out again by AllocateEvent. */
+    std::vector<Event *> freeEvents;
+
+    /* Number of scheduled events for each key. */
+    std::unordered_map<EventKey, ncounter_t, EventKeyHash> eventIndex;
+
+    NVMObject_hook *FindHook( NVMObject *recipient ) const;
+    EventKey MakeEventKey( EventType type, NVMObject_hook *recipient, NVMainRequest *req, ncycle_t when ) const;
+    EventKey MakeCallbackKey( NVMObject *recipient, CallbackPtr method, ncycle_t when, void *data, int priority ) const;
+    EventKey MakeKey( Event *event ) const;
+    void IndexEvent( Event *event );
+    void UnindexEvent( Event *event );
+
+    EventQueueModel queueModel;
+    ncycle_t wheelBase;
+    ncycle_t wheelSize;
+    ncycle_t wheelMask;
+    std::vector<EventList> wheel;
+    std::vector<uint64_t> wheelOccupied;
+
+    bool InWheel( ncycle_t when ) const;
+    EventList *GetEventList( ncycle_t when );
+    const EventList *GetEventList( ncycle_t when ) const;
+    void AdvanceWheel( ncycle_t base );
+    void FlushWheel( );
+    ncycle_t FindNextWheelCycle( ) const;
+    void UpdateNextEvent( );
 };
 
 
@@ -140,6 +226,7 @@ class GlobalEventQueue
     ~GlobalEventQueue();
 
     void AddSystem( NVMain *subSystem, Config *config );
+    void AddChannelQueue( NVMain *subSystem, EventQueue *queue );
     void Cycle( ncycle_t steps );
 
     void SetFrequency( double freq );
@@ -148,14 +235,55 @@ class GlobalEventQueue
     ncycle_t GetNextEvent( EventQueue **eq = NULL );
     ncycle_t GetCurrentCycle( );
 
+    ncycle_t GetSystemLookahead( );
+    ncycle_t GetArrivalCycle( EventQueue *source, EventQueue *destination );
+
   private:
     ncycle_t currentCycle;
     double frequency;
 
+    /*
+     *  When non-zero, requests between systems take this many cycles so the
+     *  systems are advanced independently in windows of this length.
+     */
+    ncycle_t systemLookahead;
+
     std::map<EventQueue *, double> eventQueues;
+    std::vector<NVMain *> systems;
+
+    /*
+     *  Channel queues do not interact with each other within one call to 
+     *  Cycle( ) so they may be advanced on worker threads. Completions are
+     *  deferred to the parent system and replayed in order afterwards.
+     */
+    std::vector<EventQueue *> channelQueues;
+    std::vector<EventQueue *> channelSystemQueues;
+    ncounter_t threadCount;
+
+    std::vector<std::thread> workers;
+    std::mutex workerMutex;
+    std::condition_variable workerStart;
+    std::condition_variable workerDone;
+    ncounter_t workerGeneration;
+    ncounter_t workersBusy;
+    bool workersExit;
+
+    std::vector<EventQueue *> activeQueues;
+    std::vector<ncycle_t> activeTargets;
+    std::vector<ncycle_t> activeSyncCycles;
 
     void Sync( );
 
+    bool FastForward( ncycle_t target );
+    ncycle_t GetLocalTarget( double frequencyMultiplier, ncycle_t target );
+    bool IsChannelQueue( EventQueue *queue );
+    bool PrepareParallelCycle( ncycle_t target );
+    void CycleParallel( ncycle_t steps );
+    void CycleSystems( ncycle_t steps );
+    void RunActiveQueues( );
+    void AdvanceQueue( EventQueue *queue, ncycle_t localTarget, ncycle_t syncCycle );
+    void AdvanceActiveQueues( ncounter_t worker );
+    void WorkerLoop( ncounter_t worker );
 };
 
 };
@@ -60,8 +60,10 @@
 #include <cassert>
 #include <cstdlib>
 #include <csignal>
+#include <cstring>
 #include <limits>
 #include <algorithm>
+#include <new>
 
 using namespace NVM;
 
@@ -71,6 +73,7 @@ bool WasIssued( NVMainRequest *request ) { return (request->flags & NVMainReques
 
 MemoryController::MemoryController( )
 {
+    memory = NULL;
     transactionQueues = NULL;
     transactionQueueCount = 0;
     commandQueues = NULL;
@@ -80,6 +83,32 @@ MemoryController::MemoryController( )
     wakeupCount = 0;
     lastIssueCycle = 0;
 
+    convertedRowActivates = 0;
+
+    pim_broadcasts = 0;
+
+    bulk_rows = 0;
+    bulk_AAPs = 0;
+    bulk_APs = 0;
+    bulk_verify_rows = 0;
+    bulk_verify_failures = 0;
+
+    rowclone_psm_copies = 0;
+    rowclone_lisa_copies = 0;
+
+    transpose_lines = 0;
+    transpose_groups = 0;
+    transpose_partial_groups = 0;
+    transpose_reads = 0;
+    transpose_writes = 0;
+    transpose_busy_cycles = 0;
+    transpose_overhead_cycles = 0;
+    transpose_energy = 0.0;
+
+    transposer = NULL;
+    transposeFree = 0;
+    transposeFlushes = 0;
+
     starvationThreshold = 4;
     subArrayNum = 1;
     starvationCounter = NULL;
@@ -137,6 +166,21 @@ MemoryController::~MemoryController( )
     }
 
     delete [] delayedRefreshCounter;
+
+    std::vector<NVMainRequest *>::iterator it;
+
+    for( it = freeRequests.begin( ); it != freeRequests.end( ); it++ )
+        delete (*it);
+
+    for( it = retiredRequests.begin( ); it != retiredRequests.end( ); it++ )
+        delete (*it);
+
+    std::map<std::pair<BulkBitwiseOp, ncounter_t>, PIMMicroprogram *>::iterator pit;
+
+    for( pit = microprograms.begin( ); pit != microprograms.end( ); pit++ )
+        delete pit->second;
+
+    delete transposer;
 }
 
 void MemoryController::InitQueues( unsigned int numQueues )
@@ -162,7 +206,7 @@ void MemoryController::Cycle( ncycle_t /*steps*/ )
     ncycle_t nextWakeup = GetEventQueue( )->GetCurrentCycle( ) + 1;
 
     /* Skip this if another transaction is scheduled this cycle. */
-    if( GetEventQueue( )->FindEvent( EventCycle, this, NULL, nextWakeup ) )
+    if( GetEventQueue( )->IsEventScheduled( EventCycle, this, NULL, nextWakeup ) )
         return;
 
     for( ncounter_t queueIdx = 0; queueIdx < commandQueueCount; queueIdx++ )
@@ -191,15 +235,35 @@ void MemoryController::Prequeue( ncounter_t queueNum, NVMainRequest *request )
     transactionQueues[queueNum].push_front( request );
 }
 
+/* Controllers with a single transaction queue keep every request there. */
+ncounter_t MemoryController::GetTransactionQueueId( NVMainRequest * /*request*/ )
+{
+    return 0;
+}
+
 void MemoryController::Enqueue( ncounter_t queueNum, NVMainRequest *request )
 {
-    /* Retranslate once for this channel, but leave channel the same */
+    /* 
+     *  Retranslate once for this channel, but leave channel the same. This
+     *  is skipped if the address was translated with the same layout.
+     */
     ncounter_t channel, rank, bank, row, col, subarray;
 
-    GetDecoder( )->Translate( request->address.GetPhysicalAddress( ), 
-                               &row, &col, &bank, &rank, &channel, &subarray );
     channel = request->address.GetChannel( );
-    request->address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
+
+    if( GetDecoder( )->TranslateAddress( request->address ) 
+        && request->address.GetChannel( ) != channel )
+    {
+        request->address.GetTranslatedAddress( &row, &col, &bank, &rank, NULL, &subarray );
+        request->address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
+    }
+
+    if( request->type == BBOP )
+    {
+        std::cout << "NVMain Error: " << StatName( ) << " can not schedule bulk "
+            << "bitwise operations. Use `MEM_CTL FRFCFS'." << std::endl;
+        exit(1);
+    }
 
     /* Enqueue the request. */
     assert( queueNum < transactionQueueCount );
@@ -213,10 +277,7 @@ void MemoryController::Enqueue( ncounter_t queueNum, NVMainRequest *request )
     {
         ncycle_t nextWakeup = GetEventQueue( )->GetCurrentCycle( );
 
-        if( GetEventQueue( )->FindEvent( EventCycle, this, NULL, nextWakeup ) == NULL )
-        {
-            GetEventQueue( )->InsertEvent( EventCycle, this, nextWakeup, NULL, transactionQueuePriority );
-        }
+        GetEventQueue( )->InsertUniqueEvent( EventCycle, this, nextWakeup, NULL, transactionQueuePriority );
     }
 }
 
@@ -240,6 +301,9 @@ bool MemoryController::TransactionAvailable( ncounter_t queueId )
         }
     }
 
+    if( !rv && !bulkSequences.empty( ) )
+        rv = BulkRowAvailable( queueId );
+
     return rv;
 }
 
@@ -249,16 +313,9 @@ void MemoryController::ScheduleCommandWake( )
     ncycle_t nextWakeup = NextIssuable( NULL );
 
     /* Avoid scheduling multiple duplicate events. */
-    bool nextWakeupScheduled = GetEventQueue()->FindCallback( this, 
-                                (CallbackPtr)&MemoryController::CommandQueueCallback,
-                                nextWakeup, NULL, commandQueuePriority );
-
-    if( !nextWakeupScheduled )
-    {
-        GetEventQueue( )->InsertCallback( this, 
-                          (CallbackPtr)&MemoryController::CommandQueueCallback,
-                          nextWakeup, NULL, commandQueuePriority );
-    }
+    GetEventQueue( )->InsertUniqueCallback( this, 
+                      (CallbackPtr)&MemoryController::CommandQueueCallback,
+                      nextWakeup, NULL, commandQueuePriority );
 }
 
 void MemoryController::CommandQueueCallback( void * /*data*/ )
@@ -272,14 +329,9 @@ void MemoryController::CommandQueueCallback( void * /*data*/ )
     wakeupCount++;
 
     /* Avoid scheduling multiple duplicate events. */
-    bool nextWakeupScheduled = GetEventQueue()->FindCallback( this, 
-                                (CallbackPtr)&MemoryController::CommandQueueCallback,
-                                nextWakeup, NULL, commandQueuePriority );
-
-    if( !nextWakeupScheduled 
-        && nextWakeup != std::numeric_limits<ncycle_t>::max( ) )
+    if( nextWakeup != std::numeric_limits<ncycle_t>::max( ) )
     {
-        GetEventQueue( )->InsertCallback( this, 
+        GetEventQueue( )->InsertUniqueCallback( this, 
                           (CallbackPtr)&MemoryController::CommandQueueCallback,
                           nextWakeup, NULL, commandQueuePriority );
     }
@@ -304,6 +356,66 @@ void MemoryController::RefreshCallback( void *data )
     GetChild( )->Cycle( realSteps );
 }
 
+/* 
+ *  The controller is idle when no transactions or commands are queued and
+ *  the commands issued so far have finished.
+ */
+bool MemoryController::Idle( )
+{
+    if( !bulkSequences.empty( ) || transposeFlushes != 0 )
+        return false;
+
+    for( ncounter_t queueIdx = 0; queueIdx < transactionQueueCount; queueIdx++ )
+    {
+        if( !transactionQueues[queueIdx].empty( ) )
+            return false;
+    }
+
+    for( ncounter_t queueIdx = 0; queueIdx < commandQueueCount; queueIdx++ )
+    {
+        if( !commandQueues[queueIdx].empty( ) )
+            return false;
+    }
+
+    if( memory != NULL )
+    {
+        std::vector<NVMObject_hook *>& ranks = memory->GetChildren( );
+
+        for( size_t rankIdx = 0; rankIdx < ranks.size( ); rankIdx++ )
+        {
+            if( !ranks[rankIdx]->Idle( ) )
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/* Each refresh pulse repeats after this many cycles, or 0 without refresh. */
+ncycle_t MemoryController::GetRefreshPeriod( )
+{
+    return ( p->UseRefresh ) ? m_tREFI : 0;
+}
+
+/*
+ *  Number of cycles curQueue goes through. Refreshes issued while idle
+ *  rotate it, so idle time is only skipped in multiples of this many
+ *  refresh periods.
+ */
+ncounter_t MemoryController::GetRoundRobinLength( )
+{
+    return ( p->ScheduleScheme != 0 ) ? commandQueueCount + 1 : 1;
+}
+
+/*
+ *  Called after the event queue was shifted over an idle period whose
+ *  energy has already been accounted for.
+ */
+void MemoryController::FastForward( ncycle_t cycles )
+{
+    lastCommandWake += cycles;
+}
+
 void MemoryController::CleanupCallback( void * /*data*/ )
 {
     for( ncycle_t queueId = 0; queueId < commandQueueCount; queueId++ )
@@ -316,6 +428,11 @@ void MemoryController::CleanupCallback( void * /*data*/ )
             commandQueues[queueId].end()
         );        
     }
+
+    /* Issued requests are no longer referenced, recycle completed ones. */
+    freeRequests.insert( freeRequests.end( ), retiredRequests.begin( ),
+                         retiredRequests.end( ) );
+    retiredRequests.clear( );
 }
 
 bool MemoryController::RequestComplete( NVMainRequest *request )
@@ -325,11 +442,73 @@ bool MemoryController::RequestComplete( NVMainRequest *request )
     //else if( request->owner == this )
     if( request->owner == this )
     {
+        /* The last command of a bulk row's microprogram finishes the row. */
+        if( !bulkRowCommands.empty( ) )
+        {
+            std::map<NVMainRequest *, BulkSequence *>::iterator it;
+
+            it = bulkRowCommands.find( request );
+
+            if( it != bulkRowCommands.end( ) )
+            {
+                it->second->outstanding--;
+                bulkRowCommands.erase( it );
+
+                RetireBulkSequences( );
+            }
+        }
+
+        if( !transposeReads.empty( ) || !transposeWrites.empty( ) )
+            TransposeRequestComplete( request );
+
+        if( !bulkVerifyStarts.empty( ) || !bulkVerifyEnds.empty( ) )
+        {
+            std::map<NVMainRequest *, BulkVerify *>::iterator it;
+
+            it = bulkVerifyStarts.find( request );
+
+            if( it != bulkVerifyStarts.end( ) )
+            {
+                PredictBulkRow( request, it->second );
+                bulkVerifyStarts.erase( it );
+            }
+
+            it = bulkVerifyEnds.find( request );
+
+            if( it != bulkVerifyEnds.end( ) )
+            {
+                CheckBulkRow( request, it->second );
+                delete it->second;
+                bulkVerifyEnds.erase( it );
+            }
+        }
+
+        /* The last command of a row copy finishes the copy. */
+        if( !rowCloneCommands.empty( ) )
+        {
+            std::map<NVMainRequest *, NVMainRequest *>::iterator it;
+
+            it = rowCloneCommands.find( request );
+
+            if( it != rowCloneCommands.end( ) )
+            {
+                NVMainRequest *copyRequest = it->second;
+
+                rowCloneCommands.erase( it );
+
+                copyRequest->status = MEM_REQUEST_COMPLETE;
+                copyRequest->completionCycle = GetEventQueue( )->GetCurrentCycle( );
+
+                GetParent( )->RequestComplete( copyRequest );
+            }
+        }
+
         /* 
          *  Any activate/precharge/etc commands belong to the memory controller
-         *  and we are in charge of deleting them!
+         *  and we are in charge of deleting them! They may still be in a 
+         *  command queue, so hold them until the next cleanup.
          */
-        delete request;
+        retiredRequests.push_back( request );
     }
     else
     {
@@ -397,6 +576,10 @@ void MemoryController::SetConfig( Config *conf, bool createChildren )
                     NVM::mlog2( subarrays )
                     );
         method->SetCount( rows, cols, banks, ranks, channels, subarrays );
+
+        if( p->ReservedRows( ) > 0 )
+            method->SetDataRows( rows - p->ReservedRows( ) );
+
         mcAT->SetTranslationMethod( method );
 
         /* Initialize interconnect */
@@ -423,7 +606,7 @@ void MemoryController::SetConfig( Config *conf, bool createChildren )
      *  number of devices = bus width / device width
      *  Total channel size is: loglcal bank size * BANKS * RANKS
      */
-    std::cout << StatName( ) << " capacity is " << ((p->ROWS * p->COLS * p->tBURST * p->RATE * p->BusWidth * p->BANKS * p->RANKS) / (8*1024)) << " KB." << std::endl;
+    std::cout << StatName( ) << " capacity is " << (((p->ROWS - p->ReservedRows( ) * (p->ROWS / p->SubArrayRows( ))) * p->COLS * p->tBURST * p->RATE * p->BusWidth * p->BANKS * p->RANKS) / (8*1024)) << " KB." << std::endl;
 
     if( conf->KeyExists( "MATHeight" ) )
     {
@@ -437,6 +620,14 @@ void MemoryController::SetConfig( Config *conf, bool createChildren )
     /* Determine number of command queues. Assume per-bank queues as this was the default for older nvmain versions. */
     queueModel = PerBankQueues;
     commandQueueCount = p->RANKS * p->BANKS;
+
+    /* Activated subarrays of a bank can only be used in parallel with their own queues. */
+    if( p->MASA )
+    {
+        queueModel = PerSubArrayQueues;
+        commandQueueCount = p->RANKS * p->BANKS * subArrayNum;
+    }
+
     if( conf->KeyExists( "QueueModel" ) )
     {
         if( conf->GetString( "QueueModel" ) == "PerRank" )
@@ -565,6 +756,9 @@ void MemoryController::SetConfig( Config *conf, bool createChildren )
         }
     }
 
+    if( p->TransposeSize > 0 )
+        transposer = new TransposeUnit( p );
+
     if( p->PrintConfig )
         config->Print();
 
@@ -575,6 +769,45 @@ void MemoryController::RegisterStats( )
 {
     AddStat(simulation_cycles);
     AddStat(wakeupCount);
+
+    if( p->ReservedRows( ) > 0 )
+    {
+        AddStat(bulk_rows);
+        AddStat(bulk_AAPs);
+        AddStat(bulk_APs);
+    }
+
+    if( p->ReservedRows( ) > 0 && p->PIMVerify )
+    {
+        AddStat(bulk_verify_rows);
+        AddStat(bulk_verify_failures);
+    }
+
+    if( p->RowClone )
+    {
+        AddStat(rowclone_psm_copies);
+        AddStat(rowclone_lisa_copies);
+    }
+
+    if( transposer != NULL )
+    {
+        AddStat(transpose_lines);
+        AddStat(transpose_groups);
+        AddStat(transpose_partial_groups);
+        AddStat(transpose_reads);
+        AddStat(transpose_writes);
+        AddStat(transpose_busy_cycles);
+        AddStat(transpose_overhead_cycles);
+        AddUnitStat(transpose_energy, "nJ");
+    }
+
+    if( p->ReservedRows( ) > 0 )
+    {
+        AddStat(convertedRowActivates);
+    }
+
+    if( p->PIMBatching )
+        AddStat(pim_broadcasts);
 }
 
 /* 
@@ -674,7 +907,12 @@ bool MemoryController::HandleRefresh( )
             ncounter_t j = (nextRefreshBank + bankIdx * p->BanksPerRefresh) % p->BANKS;
             FailReason fail;
 
-            if( NeedRefresh( j, i ) /*&& IsRefreshBankQueueEmpty( j , i )*/ )
+            /* 
+             *  PRECHARGE_ALL closes every subarray, so with per-subarray
+             *  queues it has to wait until the other queues are drained.
+             */
+            if( NeedRefresh( j, i ) /*&& IsRefreshBankQueueEmpty( j , i )*/ 
+                && ( queueModel != PerSubArrayQueues || IsRefreshBankQueueEmpty( j, i ) ) )
             {
                 /* create a refresh command that will be sent to ranks */
                 NVMainRequest* cmdRefresh = MakeRefreshRequest( 0, 0, j, i, 0 );
@@ -787,12 +1025,17 @@ bool MemoryController::IsRefreshBankQueueEmpty( const ncounter_t bank, const uin
     /* align to the head of bank group */
     ncounter_t bankHead = ( bank / p->BanksPerRefresh ) * p->BanksPerRefresh;
 
+    ncounter_t queueSubArrays = (queueModel == PerSubArrayQueues) ? subArrayNum : 1;
+
     for( ncounter_t i = 0; i < p->BanksPerRefresh; i++ )
     {
-        ncounter_t queueId = GetCommandQueueId( NVMAddress( 0, 0, bankHead + i, rank, 0, 0 ) );
-        if( !EffectivelyEmpty( queueId ) )
+        for( ncounter_t sa = 0; sa < queueSubArrays; sa++ )
         {
-            return false;
+            ncounter_t queueId = GetCommandQueueId( NVMAddress( 0, 0, bankHead + i, rank, 0, sa ) );
+            if( !EffectivelyEmpty( queueId ) )
+            {
+                return false;
+            }
         }
     }
 
@@ -819,7 +1062,7 @@ void MemoryController::PowerDown( const ncounter_t& rankId )
     if( pdRank->Idle( ) == false )
     {
         /* Remake request as PDA. */
-        delete powerdownRequest;
+        FreeRequest( powerdownRequest );
 
         pdOp = POWERDOWN_PDA;
         powerdownRequest = MakePowerdownRequest( pdOp, rankId );
@@ -832,7 +1075,7 @@ void MemoryController::PowerDown( const ncounter_t& rankId )
     }
     else
     {
-        delete powerdownRequest;
+        FreeRequest( powerdownRequest );
     }
 }
 
@@ -849,7 +1092,7 @@ void MemoryController::PowerUp( const ncounter_t& rankId )
     }
     else
     {
-        delete powerupRequest;
+        FreeRequest( powerupRequest );
     }
 }
 
@@ -885,7 +1128,7 @@ void MemoryController::HandleLowPower( )
             }
             else
             {
-                delete powerupRequest;
+                FreeRequest( powerupRequest );
             }
         }
         /* else, check whether the rank can be powered down or up */
@@ -914,12 +1157,44 @@ unsigned int MemoryController::GetID( )
     return this->id;
 }
 
+NVMainRequest *MemoryController::AllocateRequest( )
+{
+    NVMainRequest *request;
+
+    if( freeRequests.empty( ) )
+        return new NVMainRequest( );
+
+    static const NVMainRequest defaultRequest;
+
+    request = freeRequests.back( );
+    freeRequests.pop_back( );
+
+    /* 
+     *  Return the request to its default state. The data blocks keep their
+     *  buffers, so copying a request into it does not allocate again.
+     */
+    request->data.Clear( );
+    request->oldData.Clear( );
+    *request = defaultRequest;
+    request->flags = defaultRequest.flags;
+    request->burstCount = defaultRequest.burstCount;
+    request->writeProgress = defaultRequest.writeProgress;
+    request->cancellations = defaultRequest.cancellations;
+
+    return request;
+}
+
+void MemoryController::FreeRequest( NVMainRequest *request )
+{
+    freeRequests.push_back( request );
+}
+
 NVMainRequest *MemoryController::MakeCachedRequest( NVMainRequest *triggerRequest )
 {
     /* This method should be called on *transaction* queue requests, thus only READ/WRITE possible. */
     assert( triggerRequest->type == READ || triggerRequest->type == WRITE );
 
-    NVMainRequest *cachedRequest = new NVMainRequest( );
+    NVMainRequest *cachedRequest = AllocateRequest( );
 
     *cachedRequest = *triggerRequest;
     switch(cachedRequest->type) {
@@ -940,7 +1215,7 @@ NVMainRequest *MemoryController::MakeCachedRequest( NVMainRequest *triggerReques
 
 NVMainRequest *MemoryController::MakeActivateRequest( NVMainRequest *triggerRequest )
 {
-    NVMainRequest *activateRequest = new NVMainRequest( );
+    NVMainRequest *activateRequest = AllocateRequest( );
 
     activateRequest->type = ACTIVATE;
     activateRequest->issueCycle = GetEventQueue()->GetCurrentCycle();
@@ -956,7 +1231,7 @@ NVMainRequest *MemoryController::MakeActivateRequest( const ncounter_t row,
                                                       const ncounter_t rank,
                                                       const ncounter_t subarray )
 {
-    NVMainRequest *activateRequest = new NVMainRequest( );
+    NVMainRequest *activateRequest = AllocateRequest( );
 
     activateRequest->type = ACTIVATE;
     ncounter_t actAddr = GetDecoder( )->ReverseTranslate( row, col, bank, rank, id, subarray );
@@ -970,7 +1245,7 @@ NVMainRequest *MemoryController::MakeActivateRequest( const ncounter_t row,
 
 NVMainRequest *MemoryController::MakeShiftRequest( NVMainRequest *triggerRequest )
 {
-    NVMainRequest *shiftRequest = new NVMainRequest( );
+    NVMainRequest *shiftRequest = AllocateRequest( );
 
     shiftRequest->type = SHIFT;
     shiftRequest->issueCycle = GetEventQueue()->GetCurrentCycle();
@@ -986,7 +1261,7 @@ NVMainRequest *MemoryController::MakeShiftRequest( const ncounter_t row,
                                                       const ncounter_t rank,
                                                       const ncounter_t subarray )
 {
-    NVMainRequest *shiftRequest = new NVMainRequest( );
+    NVMainRequest *shiftRequest = AllocateRequest( );
 
     shiftRequest->type = SHIFT;
     ncounter_t actAddr = GetDecoder( )->ReverseTranslate( row, col, bank, rank, id, subarray );
@@ -1001,7 +1276,7 @@ NVMainRequest *MemoryController::MakeShiftRequest( const ncounter_t row,
 
 NVMainRequest *MemoryController::MakePrechargeRequest( NVMainRequest *triggerRequest )
 {
-    NVMainRequest *prechargeRequest = new NVMainRequest( );
+    NVMainRequest *prechargeRequest = AllocateRequest( );
 
     prechargeRequest->type = PRECHARGE;
     prechargeRequest->issueCycle = GetEventQueue()->GetCurrentCycle();
@@ -1017,7 +1292,7 @@ NVMainRequest *MemoryController::MakePrechargeRequest( const ncounter_t row,
                                                        const ncounter_t rank,
                                                        const ncounter_t subarray )
 {
-    NVMainRequest *prechargeRequest = new NVMainRequest( );
+    NVMainRequest *prechargeRequest = AllocateRequest( );
 
     prechargeRequest->type = PRECHARGE;
     ncounter_t preAddr = GetDecoder( )->ReverseTranslate( row, col, bank, rank, id, subarray );
@@ -1031,7 +1306,7 @@ NVMainRequest *MemoryController::MakePrechargeRequest( const ncounter_t row,
 
 NVMainRequest *MemoryController::MakePrechargeAllRequest( NVMainRequest *triggerRequest )
 {
-    NVMainRequest *prechargeAllRequest = new NVMainRequest( );
+    NVMainRequest *prechargeAllRequest = AllocateRequest( );
 
     prechargeAllRequest->type = PRECHARGE_ALL;
     prechargeAllRequest->issueCycle = GetEventQueue()->GetCurrentCycle();
@@ -1047,7 +1322,7 @@ NVMainRequest *MemoryController::MakePrechargeAllRequest( const ncounter_t row,
                                                           const ncounter_t rank,
                                                           const ncounter_t subarray )
 {
-    NVMainRequest *prechargeAllRequest = new NVMainRequest( );
+    NVMainRequest *prechargeAllRequest = AllocateRequest( );
 
     prechargeAllRequest->type = PRECHARGE_ALL;
     ncounter_t preAddr = GetDecoder( )->ReverseTranslate( row, col, bank, rank, id, subarray );
@@ -1059,6 +1334,25 @@ NVMainRequest *MemoryController::MakePrechargeAllRequest( const ncounter_t row,
     return prechargeAllRequest;
 }
 
+NVMainRequest *MemoryController::MakePIMRequest( OpType pimOp,
+                                                 NVMAddress& location,
+                                                 const ncounter_t row )
+{
+    NVMainRequest *pimRequest = AllocateRequest( );
+    ncounter_t col, bank, rank, subarray;
+
+    location.GetTranslatedAddress( NULL, &col, &bank, &rank, NULL, &subarray );
+
+    pimRequest->type = pimOp;
+    ncounter_t pimAddr = GetDecoder( )->ReverseTranslate( row, col, bank, rank, id, subarray );
+    pimRequest->address.SetPhysicalAddress( pimAddr );
+    pimRequest->address.SetTranslatedAddress( row, col, bank, rank, id, subarray );
+    pimRequest->issueCycle = GetEventQueue()->GetCurrentCycle();
+    pimRequest->owner = this;
+
+    return pimRequest;
+}
+
 NVMainRequest *MemoryController::MakeImplicitPrechargeRequest( NVMainRequest *triggerRequest )
 {
     if( triggerRequest->type == READ )
@@ -1077,7 +1371,7 @@ NVMainRequest *MemoryController::MakeRefreshRequest( const ncounter_t row,
                                                      const ncounter_t rank,
                                                      const ncounter_t subarray )
 {
-    NVMainRequest *refreshRequest = new NVMainRequest( );
+    NVMainRequest *refreshRequest = AllocateRequest( );
 
     refreshRequest->type = REFRESH;
     ncounter_t preAddr = GetDecoder( )->ReverseTranslate( row, col, bank, rank, id, subarray );
@@ -1092,7 +1386,7 @@ NVMainRequest *MemoryController::MakeRefreshRequest( const ncounter_t row,
 NVMainRequest *MemoryController::MakePowerdownRequest( OpType pdOp,
                                                        const ncounter_t rank )
 {
-    NVMainRequest *powerdownRequest = new NVMainRequest( );
+    NVMainRequest *powerdownRequest = AllocateRequest( );
 
     powerdownRequest->type = pdOp;
     ncounter_t pdAddr = GetDecoder( )->ReverseTranslate( 0, 0, 0, rank, id, 0 );
@@ -1106,7 +1400,7 @@ NVMainRequest *MemoryController::MakePowerdownRequest( OpType pdOp,
 
 NVMainRequest *MemoryController::MakePowerupRequest( const ncounter_t rank )
 {
-    NVMainRequest *powerupRequest = new NVMainRequest( );
+    NVMainRequest *powerupRequest = AllocateRequest( );
 
     powerupRequest->type = POWERUP;
     ncounter_t puAddr = GetDecoder( )->ReverseTranslate( 0, 0, 0, rank, id, 0 );
@@ -1240,8 +1534,10 @@ bool MemoryController::FindCachedAddress( std::list<NVMainRequest *>& transactio
     for( it = transactionQueue.begin(); it != transactionQueue.end(); it++ )
     {   
         // Skip transaction requests that are not READ or WRITE (PIM requests)
-        if((*it)->type == TRA || (*it)->type == OA || (*it)->type == DRA || (*it)->type == SRA
-            || (*it)->type == ODRA || (*it)->type == OTRA)
+        if(PIMCostModel::IsMultiRowActivate((*it)->type) 
+            || PIMCostModel::IsOverlappedActivate((*it)->type)
+            || (*it)->type == ROWCLONE_PSM || (*it)->type == ROWCLONE_LISA
+            || (*it)->type == LW)
             continue;
             
         ncounter_t queueId = GetCommandQueueId( (*it)->address );
@@ -1255,13 +1551,13 @@ bool MemoryController::FindCachedAddress( std::list<NVMainRequest *>& transactio
             *accessibleRequest = (*it);
             transactionQueue.erase( it );
 
-            delete cachedRequest;
+            FreeRequest( cachedRequest );
 
             rv = true;
             break;
         }
 
-        delete cachedRequest;
+        FreeRequest( cachedRequest );
     }
 
     return rv;
@@ -1319,7 +1615,7 @@ bool MemoryController::FindWriteStalledRead( std::list<NVMainRequest *>& transac
         {
             if( !writingArray->BetweenWriteIterations( ) && p->pauseMode == PauseMode_Normal )
             {
-                delete testActivate;
+                FreeRequest( testActivate );
 
                 /* Stall the scheduler by returning true. */
                 rv = true;
@@ -1329,7 +1625,7 @@ bool MemoryController::FindWriteStalledRead( std::list<NVMainRequest *>& transac
             *hitRequest = (*it);
             transactionQueue.erase( it );
 
-            delete testActivate;
+            FreeRequest( testActivate );
 
             /* Different row buffer management policy has different behavior */ 
 
@@ -1347,7 +1643,7 @@ bool MemoryController::FindWriteStalledRead( std::list<NVMainRequest *>& transac
             break;
         }
 
-        delete testActivate;
+        FreeRequest( testActivate );
     }
 
     return rv;
@@ -1374,8 +1670,9 @@ bool MemoryController::FindRowBufferHit( std::list<NVMainRequest *>& transaction
     {
 
         // Skip transaction requests that are not READ or WRITE (PIM requests)
-        if((*it)->type == TRA || (*it)->type == OA || (*it)->type == DRA || (*it)->type == SRA
-            || (*it)->type == ODRA || (*it)->type == OTRA)
+        if(PIMCostModel::IsMultiRowActivate((*it)->type) 
+            || PIMCostModel::IsOverlappedActivate((*it)->type)
+            || (*it)->type == ROWCLONE_PSM || (*it)->type == ROWCLONE_LISA)
             continue;
 
         ncounter_t rank, bank, row, subarray, col;
@@ -1558,14 +1855,18 @@ bool MemoryController::FindClosedBankRequest( std::list<NVMainRequest *>& transa
 
     for( it = transactionQueue.begin(); it != transactionQueue.end(); it++ )
     {
-        ncounter_t rank, bank;
+        ncounter_t rank, bank, subarray;
         ncounter_t queueId = GetCommandQueueId( (*it)->address );
 
         if( !commandQueues[queueId].empty() ) continue;
 
-        (*it)->address.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, NULL );
+        (*it)->address.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, &subarray );
+
+        /* With MASA, a closed subarray can be opened next to the active ones. */
+        bool closed = p->MASA ? !activeSubArray[rank][bank][subarray] 
+                              : !activateQueued[rank][bank];
 
-        if( !activateQueued[rank][bank]         /* This bank is inactive */
+        if( closed                              /* This bank (subarray) is inactive */
             && !bankNeedRefresh[rank][bank]     /* The bank is not waiting for a refresh */
             && !refreshQueued[rank][bank]       /* Don't interrupt refreshes queued on bank group head. */
             && commandQueues[queueId].empty()   /* The request queue is empty */
@@ -1599,6 +1900,24 @@ bool MemoryController::DummyPredicate::operator() ( NVMainRequest* /*request*/ )
     return true;
 }
 
+/*
+ *  The bank stays active as long as any of its subarrays is, since other
+ *  subarrays keep their rows open while one of them is precharged.
+ */
+void MemoryController::UpdateActivateQueued( ncounter_t rank, ncounter_t bank )
+{
+    activateQueued[rank][bank] = false;
+
+    for( ncounter_t i = 0; i < subArrayNum; i++ )
+    {
+        if( activeSubArray[rank][bank][i] == true )
+        {
+            activateQueued[rank][bank] = true;
+            break;
+        }
+    }
+}
+
 /**Issue PIM Commands 
  * if bank is open then precharge
  * then add to command queue
@@ -1609,6 +1928,17 @@ bool MemoryController::IssuePIMCommands( NVMainRequest *req )
 {
     bool rv = false;
     ncounter_t rank, bank, row, subarray, col;
+    PIMPrimitive primitive = PIMCostModel::GetPrimitive( req->type );
+
+    if( !p->pimCosts.IsEnabled( primitive ) )
+    {
+        std::cout << "NVMain Error: " << PIMCostModel::GetInfo( primitive ).name 
+            << " activates are disabled. Give them PIM_" << PIMCostModel::GetInfo( primitive ).name
+            << "_ costs (or a PIMProfile) or use `PIMMode Pinatubo'." << std::endl;
+        GetStats( )->PrintAll( std::cerr );
+        exit(1);
+    }
+
     req->address.GetTranslatedAddress(&row, &col, &bank, &rank, NULL, &subarray);
 
     ncounter_t rank2, bank2, row2, subarray2, col2;
@@ -1618,6 +1948,7 @@ bool MemoryController::IssuePIMCommands( NVMainRequest *req )
         std::cout << "Physical Addresses: " << req->address.GetPhysicalAddress() << " | " << req->address2.GetPhysicalAddress() << "\n";
         std::cout << "Translated Addresses: Ranks " << rank << " | " << rank2 << "\nBanks " << bank << " | " << bank2 << "\nSubarrays " << subarray << " | " << subarray2 << "\n";
         std::cout << "PIM command Src/Dst not in same subarray! - throwing exception in src/MemoryController.cpp" << std::endl;
+        std::cout << "Use `Decoder PIMDecoder' and its region addresses to keep operands in one subarray." << std::endl;
         //Give the opportunity to attach a debugger here.
         #ifndef NDEBUG
             raise( SIGSTOP );
@@ -1626,16 +1957,23 @@ bool MemoryController::IssuePIMCommands( NVMainRequest *req )
             exit(1);
     }
 
+    if( p->ReservedRows( ) > 0 && !CheckReservedRows( req ) )
+    {
+        GetStats( )->PrintAll( std::cerr );
+        exit(1);
+    }
+    req->address.GetTranslatedAddress(&row, NULL, NULL, NULL, NULL, NULL);
+
     ncounter_t muxLevel = static_cast<ncounter_t>(col/p->RBSize);
     ncounter_t queueId = GetCommandQueueId(req->address);
 
     //If not overlap, the subarray should not be active
-    if(activeSubArray[rank][bank][subarray] && (req->type == SRA || req->type == DRA ||  req->type == TRA)){
+    if(activeSubArray[rank][bank][subarray] && PIMCostModel::IsMultiRowActivate(req->type)){
         commandQueues[queueId].push_back( MakePrechargeRequest( req ) );
     }
 
     //If overlap, the subarray should be active
-    if((req->type == OA || req->type == ODRA || req->type == OTRA) && !activeSubArray[rank][bank][subarray]){
+    if(PIMCostModel::IsOverlappedActivate(req->type) && !activeSubArray[rank][bank][subarray]){
         commandQueues[queueId].push_back( MakeActivateRequest( req ) );
     }
 
@@ -1652,10 +1990,10 @@ bool MemoryController::IssuePIMCommands( NVMainRequest *req )
     effectiveMuxedRow[rank][bank][subarray] = muxLevel;
 
     // add precharge after overlap activates to close subarray
-    if(req->type == OA || req->type == ODRA || req->type == OTRA){
+    if(PIMCostModel::IsOverlappedActivate(req->type)){
         commandQueues[queueId].push_back( MakePrechargeRequest( req ) );
         activeSubArray[rank][bank][subarray] = false;
-        activateQueued[rank][bank] = false;
+        UpdateActivateQueued( rank, bank );
     }
 
     //INTER_BANK ROWCLONE
@@ -1677,82 +2015,1346 @@ bool MemoryController::IssuePIMCommands( NVMainRequest *req )
 
 
 /*
- *  NOTE: This function assumes the memory controller uses any predicates when
- *  scheduling. They will not be re-checked here.
+ *  A local write (LW) stores a value produced inside the bank into the open
+ *  row, e.g., the write-back of a PIM result. Like a WRITE it needs its row
+ *  open, but the command itself carries no data burst.
  */
-bool MemoryController::IssueMemoryCommands( NVMainRequest *req )
+bool MemoryController::IssueLocalWriteCommands( NVMainRequest *req )
 {
-    bool rv = false;
     ncounter_t rank, bank, row, subarray, col;
 
-    req->address.GetTranslatedAddress( &row, &col, &bank, &rank, NULL, &subarray );
+    if( !p->LocalWrite )
+    {
+        std::cout << "NVMain Error: Local writes are disabled. Set `LocalWrite true' "
+            << "to use them." << std::endl;
+        GetStats( )->PrintAll( std::cerr );
+        exit(1);
+    }
 
-    SubArray *writingArray = FindChild( req, SubArray );
+    req->address.GetTranslatedAddress( &row, &col, &bank, &rank, NULL, &subarray );
 
     ncounter_t muxLevel = static_cast<ncounter_t>(col / p->RBSize);
     ncounter_t queueId = GetCommandQueueId( req->address );
 
-    /*
-     *  If the request is somehow accessible (e.g., via caching, etc), but the
-     *  bank state does not match the memory controller, just issue the request
-     *  without updating any internal states.
-     */
-    FailReason reason;
-    NVMainRequest *cachedRequest = MakeCachedRequest( req );
+    req->issueCycle = GetEventQueue()->GetCurrentCycle();
 
-    if( GetChild( )->IsIssuable( cachedRequest, &reason ) )
+    if( activateQueued[rank][bank]
+        && activeSubArray[rank][bank][subarray]
+        && effectiveRow[rank][bank][subarray] == row )
     {
-        /* Differentiate from row-buffer hits. */
-        if ( !activateQueued[rank][bank] 
-             || !activeSubArray[rank][bank][subarray]
-             || effectiveRow[rank][bank][subarray] != row 
-             || effectiveMuxedRow[rank][bank][subarray] != muxLevel ) 
-        {
-            req->issueCycle = GetEventQueue()->GetCurrentCycle();
-
-            // Update starvation ??
-            commandQueues[queueId].push_back( req );
-
-            delete cachedRequest;
+        starvationCounter[rank][bank][subarray]++;
+    }
+    else
+    {
+        /* Any activate will reset the starvation counter */
+        starvationCounter[rank][bank][subarray] = 0;
 
-            return true;
-        }
-        else
+        if( activeSubArray[rank][bank][subarray] && p->UsePrecharge )
         {
-            delete cachedRequest;
+            commandQueues[queueId].push_back( 
+                    MakePrechargeRequest( effectiveRow[rank][bank][subarray], 0, bank, rank, subarray ) );
         }
+
+        commandQueues[queueId].push_back( MakeActivateRequest( req ) );
     }
-    else
+
+    commandQueues[queueId].push_back( req );
+
+    activateQueued[rank][bank] = true;
+    activeSubArray[rank][bank][subarray] = true;
+    effectiveRow[rank][bank][subarray] = row;
+    effectiveMuxedRow[rank][bank][subarray] = muxLevel;
+
+    /* There is no LW with implicit precharge, so close the row explicitly. */
+    if( req->flags & NVMainRequest::FLAG_LAST_REQUEST && p->UsePrecharge )
     {
-        delete cachedRequest;
+        commandQueues[queueId].push_back( MakePrechargeRequest( req ) );
+        activeSubArray[rank][bank][subarray] = false;
+        effectiveRow[rank][bank][subarray] = p->ROWS;
+        effectiveMuxedRow[rank][bank][subarray] = p->ROWS;
+
+        UpdateActivateQueued( rank, bank );
     }
 
-    if( !activateQueued[rank][bank] && commandQueues[queueId].empty() )
-    {
-        /* Any activate will reset the starvation counter */
-        activateQueued[rank][bank] = true;
-        activeSubArray[rank][bank][subarray] = true;
-        effectiveRow[rank][bank][subarray] = row;
-        effectiveMuxedRow[rank][bank][subarray] = muxLevel;
-        starvationCounter[rank][bank][subarray] = 0;
+    ScheduleCommandWake( );
 
-        req->issueCycle = GetEventQueue()->GetCurrentCycle();
+    return true;
+}
 
-        NVMainRequest *actRequest = MakeActivateRequest( req );
-        actRequest->flags |= (writingArray != NULL && writingArray->IsWriting( )) ? NVMainRequest::FLAG_PRIORITY : 0;
-        commandQueues[queueId].push_back( actRequest );
+/*
+ *  PIM batching: after a PIM transaction was scheduled, also schedule the
+ *  oldest transaction of the same type for every other command queue that
+ *  is empty, so the operations on different banks/subarrays start together.
+ */
+ncounter_t MemoryController::IssuePIMBatch( std::list<NVMainRequest *>& transactionQueue,
+                                            NVMainRequest *leader )
+{
+    ncounter_t batched = 0;
+    std::vector<bool> queueSeen( commandQueueCount, false );
+    std::list<NVMainRequest *>::iterator it = transactionQueue.begin( );
 
-        /* Different row buffer management policy has different behavior */ 
-        /*
-         * There are two possibilities that the request is the last request:
-         * 1) ClosePage == 1 and there is no other request having row
-         * buffer hit
-         * or 2) ClosePage == 2, the request is always the last request
-         */
-        if( req->flags & NVMainRequest::FLAG_LAST_REQUEST && p->UsePrecharge )
+    queueSeen[GetCommandQueueId( leader->address )] = true;
+
+    while( it != transactionQueue.end( ) )
+    {
+        ncounter_t rank, bank;
+        ncounter_t queueId = GetCommandQueueId( (*it)->address );
+
+        /* Only the oldest transaction of a queue may go, to keep their order. */
+        if( queueSeen[queueId] )
         {
-            commandQueues[queueId].push_back( MakeImplicitPrechargeRequest( req ) );
-            activeSubArray[rank][bank][subarray] = false;
+            it++;
+            continue;
+        }
+
+        queueSeen[queueId] = true;
+
+        (*it)->address.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, NULL );
+
+        if( (*it)->type == leader->type
+            && commandQueues[queueId].empty( )
+            && !bankNeedRefresh[rank][bank]
+            && !refreshQueued[rank][bank]
+            && (*it)->arrivalCycle != GetEventQueue()->GetCurrentCycle() )
+        {
+            NVMainRequest *batchRequest = (*it);
+
+            it = transactionQueue.erase( it );
+            IssuePIMCommands( batchRequest );
+            batched++;
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    return batched;
+}
+
+/*
+ *  Issues the multi-row activates of the same type waiting at the head of
+ *  other command queues in the same cycle as one broadcast command. Only the
+ *  rank's PIMActivationBudget limits how many go at once.
+ */
+void MemoryController::IssuePIMBroadcasts( NVMainRequest *leader, ncounter_t leaderQueue )
+{
+    for( ncounter_t queueId = 0; queueId < commandQueueCount; queueId++ )
+    {
+        if( queueId == leaderQueue || commandQueues[queueId].empty( ) )
+            continue;
+
+        NVMainRequest *queueHead = commandQueues[queueId].at( 0 );
+
+        if( queueHead->type != leader->type || WasIssued( queueHead ) )
+            continue;
+
+        queueHead->flags |= NVMainRequest::FLAG_BROADCAST;
+
+        if( !GetChild( )->IsIssuable( queueHead, NULL ) )
+        {
+            queueHead->flags &= ~NVMainRequest::FLAG_BROADCAST;
+            continue;
+        }
+
+        *debugStream << GetEventQueue()->GetCurrentCycle() << " MemoryController: Broadcast request type "
+                     << queueHead->type << " for address 0x" << std::hex 
+                     << queueHead->address.GetPhysicalAddress()
+                     << std::dec << " for queue " << queueId << std::endl;
+
+        GetChild( )->IssueCommand( queueHead );
+
+        queueHead->flags |= NVMainRequest::FLAG_ISSUED;
+        pim_broadcasts++;
+
+        if( commandQueues[queueId].size( ) == 1 && TransactionAvailable( queueId ) )
+        {
+            ncycle_t nextWakeup = GetEventQueue( )->GetCurrentCycle( ) + 1;
+
+            GetEventQueue( )->InsertUniqueEvent( EventCycle, this, nextWakeup, NULL, transactionQueuePriority );
+        }
+    }
+}
+
+/*
+ *  Triple-row activates only work on the B-group rows and double-row 
+ *  activates on the B-group or DCC rows. Depending on the policy, other
+ *  targets are rejected or retargeted to the first wired row (or issued as
+ *  single-row activates if no such rows are configured).
+ */
+bool MemoryController::CheckReservedRows( NVMainRequest *req )
+{
+    ncounter_t rank, bank, row, subarray, col, channel;
+    ReservedRowGroup group;
+    bool tripleRow, doubleRow;
+
+    req->address.GetTranslatedAddress( &row, &col, &bank, &rank, &channel, &subarray );
+    group = p->GetReservedRowGroup( row );
+
+    /* Activates of three or more rows need the B-group rows. */
+    tripleRow = (PIMCostModel::GetRows( req->type ) >= 3);
+    doubleRow = (PIMCostModel::GetRows( req->type ) == 2);
+
+    if( (!tripleRow && !doubleRow) || group == ReservedRow_BGroup
+        || (doubleRow && group == ReservedRow_DCC) )
+    {
+        return true;
+    }
+
+    if( p->reservedRowPolicy == ReservedRowPolicy_Reject )
+    {
+        std::cout << "NVMain Error: " << PIMCostModel::GetInfo( 
+            PIMCostModel::GetPrimitive( req->type ) ).name << " multi-row activate at 0x" << std::hex << req->address.GetPhysicalAddress( ) 
+            << std::dec << " targets row " << row << ", which is not wired for it." 
+            << " B-group rows start at row " << p->GetReservedRowBase( ReservedRow_BGroup )
+            << "." << std::endl;
+        return false;
+    }
+
+    if( p->ReservedBGroupRows > 0 )
+        row = p->GetReservedRowBase( ReservedRow_BGroup );
+    else if( doubleRow && p->ReservedDCCRows > 0 )
+        row = p->GetReservedRowBase( ReservedRow_DCC );
+    else if( PIMCostModel::IsMultiRowActivate( req->type ) )
+        req->type = SRA;
+    else
+        req->type = OA;
+
+    req->address.SetTranslatedAddress( row, col, bank, rank, channel, subarray );
+    convertedRowActivates++;
+
+    return true;
+}
+
+/*
+ *  Rows needed by each bulk bitwise operation, indexed by BulkBitwiseOp:
+ *  B-group, DCC, zero and one rows per subarray.
+ */
+static const ncounter_t bulkRowNeeds[7][4] = {
+    { 3, 0, 1, 0 },  /* AND */
+    { 3, 0, 0, 1 },  /* OR */
+    { 4, 2, 1, 1 },  /* XOR */
+    { 0, 1, 0, 0 },  /* NOT */
+    { 3, 1, 1, 0 },  /* NAND */
+    { 3, 1, 0, 1 },  /* NOR */
+    { 0, 0, 0, 0 }   /* COPY */
+};
+
+static const char *bulkOpNames[12] = {
+    "BBOP_AND", "BBOP_OR", "BBOP_XOR", "BBOP_NOT", "BBOP_NAND", "BBOP_NOR", "BBOP_COPY",
+    "BBOP_ADD", "BBOP_SUB", "BBOP_LT", "BBOP_MUL", "BBOP_POPCOUNT"
+};
+
+/*
+ *  Arithmetic microprograms are compiled once per operation and width. The
+ *  first channel reports what to expect from them with this configuration.
+ */
+PIMMicroprogram *MemoryController::GetMicroprogram( BulkBitwiseOp op, ncounter_t width )
+{
+    std::pair<BulkBitwiseOp, ncounter_t> key( op, width );
+    std::map<std::pair<BulkBitwiseOp, ncounter_t>, PIMMicroprogram *>::iterator it;
+
+    it = microprograms.find( key );
+
+    if( it != microprograms.end( ) )
+        return it->second;
+
+    PIMMicroprogram *program = new PIMMicroprogram( op, width, p );
+
+    microprograms[key] = program;
+
+    if( id == 0 )
+    {
+        ncounter_t rowSize = p->COLS * p->tBURST * p->RATE * p->BusWidth / 8;
+        double elements = static_cast<double>(rowSize * 8);
+        double seconds = static_cast<double>(program->EstimateCycles( )) 
+                       / (static_cast<double>(p->CLK) * 1000000.0);
+        ncounter_t banks = p->CHANNELS * p->RANKS * p->BANKS;
+
+        std::cout << "NVMain: " << bulkOpNames[op] << " of " << width << "-bit elements: "
+            << program->GetAAPs( ) << " AAPs and " << program->GetAPs( ) << " APs per row ("
+            << program->GetMajorities( ) << " majority gates, " << program->GetScratchRows( )
+            << " scratch rows). Expected " << elements / seconds << " elements/s per bank, "
+            << elements / seconds * static_cast<double>(banks) << " with all " << banks
+            << " banks (ignoring tRAW), " << program->EstimateEnergy( ) / elements * 1000.0
+            << " pJ per element." << std::endl;
+    }
+
+    return program;
+}
+
+void MemoryController::CheckBulkRequirements( NVMainRequest *request, PIMMicroprogram *program )
+{
+    ncounter_t needs[4];
+
+    /* The sequencer and its stats are only set up with the compute rows. */
+    if( p->ReservedRows( ) == 0 )
+    {
+        std::cout << "NVMain Error: " << bulkOpNames[request->bulkOp] << " needs the "
+            << "reserved compute rows. Set ReservedBGroupRows, ReservedDCCRows, "
+            << "ReservedZeroRows and ReservedOneRows." << std::endl;
+        GetStats( )->PrintAll( std::cerr );
+        exit(1);
+    }
+
+    if( program != NULL )
+    {
+        needs[0] = program->GetBGroupRows( );
+        needs[1] = program->GetDCCRows( );
+        needs[2] = program->GetZeroRows( );
+        needs[3] = program->GetOneRows( );
+    }
+    else
+    {
+        std::copy( bulkRowNeeds[request->bulkOp], bulkRowNeeds[request->bulkOp] + 4, needs );
+    }
+
+    if( p->ReservedBGroupRows < needs[0] || p->ReservedDCCRows < needs[1]
+        || p->ReservedZeroRows < needs[2] || p->ReservedOneRows < needs[3] )
+    {
+        std::cout << "NVMain Error: " << bulkOpNames[request->bulkOp] << " needs "
+            << needs[0] << " B-group, " << needs[1] << " DCC, " << needs[2] 
+            << " zero and " << needs[3] << " one rows in each subarray. Set "
+            << "ReservedBGroupRows, ReservedDCCRows, ReservedZeroRows and "
+            << "ReservedOneRows." << std::endl;
+        GetStats( )->PrintAll( std::cerr );
+        exit(1);
+    }
+}
+
+void MemoryController::EnqueueBulkOperation( NVMainRequest *request )
+{
+    ncounter_t rowSize = p->COLS * p->tBURST * p->RATE * p->BusWidth / 8;
+    PIMMicroprogram *program = NULL;
+
+    /* Operands may still be in the transposition buffer. */
+    if( transposer != NULL )
+        FlushTransposeBuffer( );
+
+    if( PIMMicroprogram::IsArithmetic( request->bulkOp ) )
+    {
+        if( request->bulkWidth == 0 )
+        {
+            std::cout << "NVMain Error: " << bulkOpNames[request->bulkOp] 
+                << " needs the element width in bits." << std::endl;
+            GetStats( )->PrintAll( std::cerr );
+            exit(1);
+        }
+
+        program = GetMicroprogram( request->bulkOp, request->bulkWidth );
+    }
+
+    CheckBulkRequirements( request, program );
+
+    BulkSequence *sequence = new BulkSequence;
+
+    sequence->request = request;
+    sequence->program = program;
+    sequence->nextRow = 0;
+    sequence->rows = (request->bulkSize + rowSize - 1) / rowSize;
+    sequence->staged = 0;
+    sequence->outstanding = 0;
+
+    /* Results are written bit by bit, so they must not overwrite a source. */
+    if( program != NULL )
+    {
+        uint64_t dstBegin = request->address.GetPhysicalAddress( );
+        uint64_t dstEnd = dstBegin + sequence->rows * program->GetResultWidth( ) * rowSize;
+        uint64_t srcSize = sequence->rows * program->GetSourceWidth( ) * rowSize;
+        uint64_t src1 = request->address2.GetPhysicalAddress( );
+        uint64_t src2 = request->address3.GetPhysicalAddress( );
+
+        if( (src1 < dstEnd && dstBegin < src1 + srcSize) 
+            || (src2 < dstEnd && dstBegin < src2 + srcSize) )
+        {
+            std::cout << "NVMain Error: The result of " << bulkOpNames[request->bulkOp]
+                << " 0x" << std::hex << dstBegin << std::dec << " overlaps a source." 
+                << std::endl;
+            GetStats( )->PrintAll( std::cerr );
+            exit(1);
+        }
+    }
+
+    bulkSequences.push_back( sequence );
+
+    GetEventQueue( )->InsertUniqueEvent( EventCycle, this, GetEventQueue( )->GetCurrentCycle( ),
+                                         NULL, transactionQueuePriority );
+}
+
+/* 
+ *  Rows of a bulk operation are located like any other request: the system
+ *  decoder selects the channel and this channel's decoder the rest. Returns
+ *  false if the row belongs to another channel.
+ */
+bool MemoryController::TranslateBulkAddress( uint64_t physicalAddress, NVMAddress& address )
+{
+    ncounter_t row, col, bank, rank, channel, subarray;
+
+    GetParent( )->GetTrampoline( )->GetDecoder( )->Translate( physicalAddress, 
+                  &row, &col, &bank, &rank, &channel, &subarray );
+
+    if( channel != id )
+        return false;
+
+    GetDecoder( )->Translate( physicalAddress, &row, &col, &bank, &rank, &channel, &subarray );
+
+    address.SetPhysicalAddress( physicalAddress );
+    address.SetTranslatedAddress( row, col, bank, rank, id, subarray );
+
+    return true;
+}
+
+/*
+ *  Translates the consecutive bit rows of one operand. Returns false if any
+ *  of them is not in the subarray of dst.
+ */
+bool MemoryController::TranslateBulkRows( uint64_t physicalAddress, ncounter_t bits, 
+                                          NVMAddress& dst, NVMAddress& first,
+                                          std::vector<ncounter_t>& rows )
+{
+    ncounter_t rowSize = p->COLS * p->tBURST * p->RATE * p->BusWidth / 8;
+
+    rows.resize( bits );
+
+    for( ncounter_t bit = 0; bit < bits; bit++ )
+    {
+        NVMAddress location;
+
+        if( !TranslateBulkAddress( physicalAddress + bit * rowSize, location )
+            || location.GetRank( ) != dst.GetRank( )
+            || location.GetBank( ) != dst.GetBank( )
+            || location.GetSubArray( ) != dst.GetSubArray( ) )
+        {
+            return false;
+        }
+
+        if( bit == 0 )
+            first = location;
+
+        rows[bit] = location.GetRow( );
+    }
+
+    return true;
+}
+
+bool MemoryController::BulkRowAvailable( ncounter_t queueId )
+{
+    std::list<BulkRow>::iterator it;
+
+    for( it = bulkRows.begin( ); it != bulkRows.end( ); it++ )
+    {
+        if( it->queueId == queueId )
+            return true;
+    }
+
+    /* More rows can be staged next cycle. */
+    if( bulkRows.size( ) < commandQueueCount && transposeFlushes == 0 )
+    {
+        std::list<BulkSequence *>::iterator sit;
+
+        for( sit = bulkSequences.begin( ); sit != bulkSequences.end( ); sit++ )
+        {
+            if( (*sit)->nextRow < (*sit)->rows )
+                return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ *  Stages the next rows of the oldest bulk operations and starts the
+ *  microprogram of each staged row as soon as its command queue drains.
+ */
+void MemoryController::CycleBulkSequencer( )
+{
+    ncounter_t rowSize = p->COLS * p->tBURST * p->RATE * p->BusWidth / 8;
+    std::list<BulkSequence *>::iterator sit;
+
+    /* No rows are staged until the transposed lines are written. */
+    for( sit = bulkSequences.begin( ); sit != bulkSequences.end( ) 
+         && bulkRows.size( ) < commandQueueCount && transposeFlushes == 0; sit++ )
+    {
+        BulkSequence *sequence = *sit;
+        NVMainRequest *request = sequence->request;
+
+        /* Logical operations have one bit row per operand. */
+        ncounter_t srcBits = 1, dstBits = 1;
+
+        if( sequence->program != NULL )
+        {
+            srcBits = sequence->program->GetSourceWidth( );
+            dstBits = sequence->program->GetResultWidth( );
+        }
+
+        while( sequence->nextRow < sequence->rows && bulkRows.size( ) < commandQueueCount )
+        {
+            uint64_t dstAddress = request->address.GetPhysicalAddress( ) 
+                                + sequence->nextRow * dstBits * rowSize;
+            uint64_t srcOffset = sequence->nextRow * srcBits * rowSize;
+            BulkRow bulkRow;
+
+            sequence->nextRow++;
+
+            if( !TranslateBulkAddress( dstAddress, bulkRow.dst ) )
+                continue;
+
+            if( !TranslateBulkRows( dstAddress, dstBits, bulkRow.dst, bulkRow.dst, bulkRow.dstRows )
+                || !TranslateBulkRows( request->address2.GetPhysicalAddress( ) + srcOffset, srcBits,
+                                       bulkRow.dst, bulkRow.src1, bulkRow.src1Rows )
+                || !TranslateBulkRows( request->address3.GetPhysicalAddress( ) + srcOffset, srcBits,
+                                       bulkRow.dst, bulkRow.src2, bulkRow.src2Rows ) )
+            {
+                std::cout << "NVMain Error: Row " << (sequence->nextRow - 1) << " of "
+                    << bulkOpNames[request->bulkOp] << " 0x" << std::hex 
+                    << request->address.GetPhysicalAddress( ) << ", 0x"
+                    << request->address2.GetPhysicalAddress( ) << ", 0x"
+                    << request->address3.GetPhysicalAddress( ) << std::dec
+                    << " is not in one subarray." << std::endl;
+                std::cout << "Use `Decoder PIMDecoder' and its region addresses to keep operands in one subarray." << std::endl;
+                GetStats( )->PrintAll( std::cerr );
+                exit(1);
+            }
+
+            bulkRow.sequence = sequence;
+            bulkRow.queueId = GetCommandQueueId( bulkRow.dst );
+
+            sequence->staged++;
+            bulkRows.push_back( bulkRow );
+        }
+    }
+
+    std::list<BulkRow>::iterator it = bulkRows.begin( );
+
+    while( it != bulkRows.end( ) )
+    {
+        if( EffectivelyEmpty( it->queueId ) )
+        {
+            IssueBulkRow( *it );
+
+            it->sequence->staged--;
+            it = bulkRows.erase( it );
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    RetireBulkSequences( );
+}
+
+/*
+ *  Pushes the Ambit microprogram for one row. T0-T3 are the B-group rows,
+ *  DCC0/DCC1 the dual-contact rows and C0/C1 the constant rows. The DCC
+ *  rows provide the negation for NOT, NAND, NOR and XOR. The triple-row
+ *  addresses T0+1 and T0+3 raise {T1, T2, DCC0} and {T3, T0, DCC1}.
+ */
+void MemoryController::IssueBulkRow( BulkRow& bulkRow )
+{
+    NVMAddress& dst = bulkRow.dst;
+    NVMAddress& src1 = bulkRow.src1;
+    NVMAddress& src2 = bulkRow.src2;
+    NVMainRequest *request = bulkRow.sequence->request;
+    NVMainRequest *lastCommand = NULL;
+    ncounter_t queueId = bulkRow.queueId;
+    ncounter_t rank, bank, subarray;
+
+    ncounter_t T0 = p->GetReservedRowBase( ReservedRow_BGroup );
+    ncounter_t DCC0 = p->GetReservedRowBase( ReservedRow_DCC );
+    ncounter_t C0 = p->GetReservedRowBase( ReservedRow_Zero );
+    ncounter_t C1 = p->GetReservedRowBase( ReservedRow_One );
+
+    dst.GetTranslatedAddress( NULL, NULL, &bank, &rank, NULL, &subarray );
+
+    if( activeSubArray[rank][bank][subarray] && p->UsePrecharge )
+    {
+        commandQueues[queueId].push_back( 
+                MakePrechargeRequest( effectiveRow[rank][bank][subarray], 0, bank, rank, subarray ) );
+    }
+
+    NVMainRequest *firstCommand = NULL;
+
+    if( bulkRow.sequence->program == NULL )
+        firstCommand = MakePIMRequest( SRA, src1, src1.GetRow( ) );
+
+    switch( request->bulkOp )
+    {
+        case BBOP_COPY:
+            lastCommand = MakePIMRequest( OA, dst, dst.GetRow( ) );
+            EnqueueAAP( queueId, firstCommand, lastCommand );
+            break;
+
+        case BBOP_NOT:
+            EnqueueAAP( queueId, firstCommand,
+                        MakePIMRequest( OA, dst, DCC0 ) );
+            lastCommand = MakePIMRequest( OA, dst, dst.GetRow( ) );
+            EnqueueAAP( queueId, MakePIMRequest( SRA, dst, DCC0 ), lastCommand );
+            break;
+
+        case BBOP_AND:
+        case BBOP_OR:
+        case BBOP_NAND:
+        case BBOP_NOR:
+        {
+            bool useZero = (request->bulkOp == BBOP_AND || request->bulkOp == BBOP_NAND);
+
+            EnqueueAAP( queueId, firstCommand,
+                        MakePIMRequest( OA, dst, T0 ) );
+            EnqueueAAP( queueId, MakePIMRequest( SRA, src2, src2.GetRow( ) ),
+                        MakePIMRequest( OA, dst, T0 + 1 ) );
+            EnqueueAAP( queueId, MakePIMRequest( SRA, dst, useZero ? C0 : C1 ),
+                        MakePIMRequest( OA, dst, T0 + 2 ) );
+
+            if( request->bulkOp == BBOP_AND || request->bulkOp == BBOP_OR )
+            {
+                lastCommand = MakePIMRequest( OA, dst, dst.GetRow( ) );
+                EnqueueAAP( queueId, MakePIMRequest( TRA, dst, T0 ), lastCommand );
+            }
+            else
+            {
+                EnqueueAAP( queueId, MakePIMRequest( TRA, dst, T0 ),
+                            MakePIMRequest( OA, dst, DCC0 ) );
+                lastCommand = MakePIMRequest( OA, dst, dst.GetRow( ) );
+                EnqueueAAP( queueId, MakePIMRequest( SRA, dst, DCC0 ), lastCommand );
+            }
+            break;
+        }
+
+        case BBOP_XOR:
+            EnqueueAAP( queueId, firstCommand,
+                        MakePIMRequest( ODRA, dst, DCC0 ) );
+            EnqueueAAP( queueId, MakePIMRequest( SRA, src2, src2.GetRow( ) ),
+                        MakePIMRequest( ODRA, dst, DCC0 + 1 ) );
+            EnqueueAAP( queueId, MakePIMRequest( SRA, dst, C0 ),
+                        MakePIMRequest( ODRA, dst, T0 + 2 ) );
+            EnqueueAP( queueId, MakePIMRequest( TRA, dst, T0 + 1 ) );
+            EnqueueAP( queueId, MakePIMRequest( TRA, dst, T0 + 3 ) );
+            EnqueueAAP( queueId, MakePIMRequest( SRA, dst, C1 ),
+                        MakePIMRequest( OA, dst, T0 + 2 ) );
+            lastCommand = MakePIMRequest( OA, dst, dst.GetRow( ) );
+            EnqueueAAP( queueId, MakePIMRequest( TRA, dst, T0 ), lastCommand );
+            break;
+
+        default:
+            lastCommand = EnqueueMicroprogram( queueId, bulkRow, &firstCommand );
+            break;
+    }
+
+    /* Every microprogram ends with the subarray precharged. */
+    starvationCounter[rank][bank][subarray] = 0;
+    activeSubArray[rank][bank][subarray] = false;
+    effectiveRow[rank][bank][subarray] = p->ROWS;
+    effectiveMuxedRow[rank][bank][subarray] = p->ROWS;
+
+    UpdateActivateQueued( rank, bank );
+
+    bulkRowCommands[lastCommand] = bulkRow.sequence;
+    bulkRow.sequence->outstanding++;
+    bulk_rows++;
+
+    if( p->PIMVerify )
+    {
+        BulkVerify *verify = new BulkVerify;
+
+        verify->op = request->bulkOp;
+        verify->program = bulkRow.sequence->program;
+        verify->dstRows = bulkRow.dstRows;
+        verify->src1Rows = bulkRow.src1Rows;
+        verify->src2Rows = bulkRow.src2Rows;
+
+        bulkVerifyStarts[firstCommand] = verify;
+        bulkVerifyEnds[lastCommand] = verify;
+    }
+
+    ScheduleCommandWake( );
+}
+
+/*
+ *  Pushes a compiled arithmetic microprogram for one row of elements and
+ *  returns its last command.
+ */
+NVMainRequest *MemoryController::EnqueueMicroprogram( ncounter_t queueId, BulkRow& bulkRow,
+                                                      NVMainRequest **firstCommand )
+{
+    const std::vector<PIMMicroOp>& ops = bulkRow.sequence->program->GetOps( );
+    NVMainRequest *lastCommand = NULL;
+
+    for( ncounter_t i = 0; i < ops.size( ); i++ )
+    {
+        NVMainRequest *activate = MakePIMRequest( ops[i].activate, bulkRow.dst, 
+                                      GetBulkOperandRow( bulkRow, ops[i].source ) );
+
+        if( i == 0 )
+            *firstCommand = activate;
+
+        if( ops[i].fused )
+        {
+            lastCommand = MakePIMRequest( ops[i].overlapped, bulkRow.dst,
+                                          GetBulkOperandRow( bulkRow, ops[i].target ) );
+            EnqueueAAP( queueId, activate, lastCommand );
+        }
+        else
+        {
+            lastCommand = activate;
+            EnqueueAP( queueId, activate );
+        }
+    }
+
+    return lastCommand;
+}
+
+ncounter_t MemoryController::GetBulkOperandRow( BulkRow& bulkRow, const PIMRowRef& ref )
+{
+    ncounter_t row = ref.index;
+
+    switch( ref.operand )
+    {
+        case PIMOperand_Dst:
+            row = bulkRow.dstRows[ref.index];
+            break;
+        case PIMOperand_Src1:
+            row = bulkRow.src1Rows[ref.index];
+            break;
+        case PIMOperand_Src2:
+            row = bulkRow.src2Rows[ref.index];
+            break;
+        case PIMOperand_Reserved:
+            break;
+    }
+
+    return row;
+}
+
+/*
+ *  Computes the expected result of a bulk row from its source rows. The
+ *  first activate of the microprogram has completed, so every earlier
+ *  operation on the subarray is visible and the sources are not yet
+ *  overwritten by this row.
+ */
+void MemoryController::PredictBulkRow( NVMainRequest *request, BulkVerify *verify )
+{
+    RowStore *rowStore = FindChild( request, SubArray )->GetRowStore( );
+    ncounter_t words = rowStore->GetRowWords( );
+    uint64_t *expected;
+
+    verify->expected.resize( words * verify->dstRows.size( ) );
+    expected = &verify->expected[0];
+
+    if( verify->program != NULL )
+    {
+        std::vector<const uint64_t *> src1, src2;
+        std::vector<uint64_t *> dst;
+
+        for( ncounter_t bit = 0; bit < verify->src1Rows.size( ); bit++ )
+        {
+            src1.push_back( rowStore->GetRow( verify->src1Rows[bit] ) );
+            src2.push_back( rowStore->GetRow( verify->src2Rows[bit] ) );
+        }
+
+        for( ncounter_t bit = 0; bit < verify->dstRows.size( ); bit++ )
+            dst.push_back( expected + bit * words );
+
+        verify->program->Evaluate( src1, src2, dst, words );
+
+        return;
+    }
+
+    const uint64_t *src1 = rowStore->GetRow( verify->src1Rows[0] );
+    const uint64_t *src2 = rowStore->GetRow( verify->src2Rows[0] );
+
+    switch( verify->op )
+    {
+        case BBOP_COPY:
+            RowStore::Copy( expected, src1, words );
+            break;
+
+        case BBOP_NOT:
+            RowStore::Not( expected, src1, words );
+            break;
+
+        case BBOP_AND:
+        case BBOP_NAND:
+            RowStore::Majority( expected, src1, src2, 
+                rowStore->GetRow( p->GetReservedRowBase( ReservedRow_Zero ) ), words );
+            break;
+
+        case BBOP_OR:
+        case BBOP_NOR:
+            RowStore::Majority( expected, src1, src2, 
+                rowStore->GetRow( p->GetReservedRowBase( ReservedRow_One ) ), words );
+            break;
+
+        case BBOP_XOR:
+            RowStore::Xor( expected, src1, src2, words );
+            break;
+
+        default:
+            break;
+    }
+
+    if( verify->op == BBOP_NAND || verify->op == BBOP_NOR )
+        RowStore::Not( expected, expected, words );
+}
+
+/* Compares the destination rows with the expected result of a bulk row. */
+void MemoryController::CheckBulkRow( NVMainRequest *request, BulkVerify *verify )
+{
+    RowStore *rowStore = FindChild( request, SubArray )->GetRowStore( );
+    ncounter_t words = rowStore->GetRowWords( );
+    bool match = (verify->expected.size( ) == words * verify->dstRows.size( ));
+
+    bulk_verify_rows++;
+
+    for( ncounter_t bit = 0; match && bit < verify->dstRows.size( ); bit++ )
+    {
+        const uint64_t *actual = rowStore->GetRow( verify->dstRows[bit] );
+
+        match = std::equal( actual, actual + words, verify->expected.begin( ) + bit * words );
+    }
+
+    if( !match )
+    {
+        std::cerr << "NVMain Error: " << StatName( ) << " bulk " << bulkOpNames[verify->op]
+            << " into 0x" << std::hex << request->address.GetPhysicalAddress( ) << std::dec
+            << " does not match the expected row." << std::endl;
+
+        bulk_verify_failures++;
+    }
+}
+
+/* Completes the bulk operations whose rows have all finished. */
+void MemoryController::RetireBulkSequences( )
+{
+    std::list<BulkSequence *>::iterator it = bulkSequences.begin( );
+
+    while( it != bulkSequences.end( ) )
+    {
+        BulkSequence *sequence = *it;
+
+        if( sequence->nextRow == sequence->rows && sequence->staged == 0 
+            && sequence->outstanding == 0 )
+        {
+            NVMainRequest *request = sequence->request;
+
+            it = bulkSequences.erase( it );
+            delete sequence;
+
+            request->status = MEM_REQUEST_COMPLETE;
+            request->completionCycle = GetEventQueue( )->GetCurrentCycle( );
+
+            GetParent( )->RequestComplete( request );
+        }
+        else
+        {
+            it++;
+        }
+    }
+}
+
+/*
+ *  Fused Activate-Activate-Precharge. The first activate opens the source
+ *  row(s), the overlapped activate copies the row buffer into the target row
+ *  and the precharge closes the subarray again.
+ */
+void MemoryController::EnqueueAAP( ncounter_t queueId, NVMainRequest *activate, 
+                                   NVMainRequest *overlapped )
+{
+    commandQueues[queueId].push_back( activate );
+    commandQueues[queueId].push_back( overlapped );
+    commandQueues[queueId].push_back( MakePrechargeRequest( overlapped ) );
+
+    bulk_AAPs++;
+}
+
+/* Activate-Precharge, used to compute in place in the B-group rows. */
+void MemoryController::EnqueueAP( ncounter_t queueId, NVMainRequest *activate )
+{
+    commandQueues[queueId].push_back( activate );
+    commandQueues[queueId].push_back( MakePrechargeRequest( activate ) );
+
+    bulk_APs++;
+}
+
+bool MemoryController::IsTransposeWrite( NVMainRequest *request )
+{
+    return (transposer != NULL && request->type == WRITE 
+            && transposer->Contains( request->address.GetPhysicalAddress( ) ));
+}
+
+/* The host write is done once its line is in the buffer. */
+void MemoryController::EnqueueTransposeWrite( NVMainRequest *request )
+{
+    ncycle_t now = GetEventQueue( )->GetCurrentCycle( );
+    const uint8_t *data = request->data.IsValid( ) ? request->data.rawData : NULL;
+    TransposeGroup *group;
+
+    group = transposer->Insert( request->address.GetPhysicalAddress( ), data, 
+                                request->data.GetSize( ) );
+
+    transpose_lines++;
+    transpose_energy += p->TransposeLineEnergy;
+
+    if( transposer->IsComplete( group ) )
+    {
+        transposer->Remove( group );
+        FlushTransposeGroup( group );
+    }
+
+    while( transposer->Overflows( ) )
+    {
+        group = transposer->GetOldest( );
+
+        transposer->Remove( group );
+        FlushTransposeGroup( group );
+    }
+
+    request->issueCycle = now;
+
+    GetEventQueue( )->InsertEvent( EventResponse, this, request, now + p->TransposeLineCycles );
+}
+
+void MemoryController::FlushTransposeGroup( TransposeGroup *group )
+{
+    ncycle_t now = GetEventQueue( )->GetCurrentCycle( );
+    ncounter_t width = transposer->GetWidth( );
+    TransposeFlush *flush = new TransposeFlush;
+
+    flush->group = group;
+    flush->start = now;
+    flush->pending = 0;
+    flush->lines.resize( width, std::vector<uint8_t>( transposer->GetLineSize( ), 0 ) );
+
+    /* The transposition stage handles one group at a time. */
+    transposeFree = std::max( now, transposeFree ) + width * p->TransposeLineCycles;
+
+    transpose_groups++;
+    transpose_busy_cycles += width * p->TransposeLineCycles;
+
+    if( !transposer->IsComplete( group ) )
+        transpose_partial_groups++;
+
+    transposeFlushes++;
+
+    GetEventQueue( )->InsertCallback( this, (CallbackPtr)&MemoryController::TransposeCallback,
+                                      transposeFree + p->TransposeLatency, flush );
+}
+
+void MemoryController::FlushTransposeBuffer( )
+{
+    TransposeGroup *group;
+
+    while( (group = transposer->GetOldest( )) != NULL )
+    {
+        transposer->Remove( group );
+        FlushTransposeGroup( group );
+    }
+}
+
+/* Incomplete groups read the vertical lines before writing them. */
+void MemoryController::TransposeCallback( void *data )
+{
+    TransposeFlush *flush = reinterpret_cast<TransposeFlush *>(data);
+
+    if( transposer->IsComplete( flush->group ) )
+    {
+        IssueTransposeWrites( flush );
+        return;
+    }
+
+    for( ncounter_t bit = 0; bit < transposer->GetWidth( ); bit++ )
+    {
+        NVMainRequest *read = MakeTransposeRequest( READ, 
+                                  transposer->GetVerticalAddress( flush->group, bit ) );
+
+        transposeReads[read] = std::make_pair( flush, bit );
+        flush->pending++;
+        transpose_reads++;
+
+        Enqueue( GetTransactionQueueId( read ), read );
+    }
+}
+
+NVMainRequest *MemoryController::MakeTransposeRequest( OpType type, uint64_t address )
+{
+    NVMainRequest *request = AllocateRequest( );
+
+    if( !TranslateBulkAddress( address, request->address ) )
+    {
+        std::cout << "NVMain Error: Transposed line 0x" << std::hex << address << std::dec
+            << " is not in " << StatName( ) << "." << std::endl;
+        std::cout << "Use `Decoder PIMDecoder' and its region addresses to keep the transpose region in one channel." << std::endl;
+        GetStats( )->PrintAll( std::cerr );
+        exit(1);
+    }
+
+    request->type = type;
+    request->owner = this;
+    request->arrivalCycle = GetEventQueue( )->GetCurrentCycle( );
+
+    return request;
+}
+
+void MemoryController::IssueTransposeWrites( TransposeFlush *flush )
+{
+    ncounter_t lineSize = transposer->GetLineSize( );
+
+    for( ncounter_t bit = 0; bit < transposer->GetWidth( ); bit++ )
+    {
+        NVMainRequest *write = MakeTransposeRequest( WRITE, 
+                                   transposer->GetVerticalAddress( flush->group, bit ) );
+
+        transposer->Transpose( flush->group, bit, &flush->lines[bit][0] );
+
+        write->data.SetSize( lineSize );
+        memcpy( write->data.rawData, &flush->lines[bit][0], lineSize );
+
+        transposeWrites[write] = flush;
+        flush->pending++;
+        transpose_writes++;
+        transpose_energy += p->TransposeLineEnergy;
+
+        Enqueue( GetTransactionQueueId( write ), write );
+    }
+}
+
+void MemoryController::TransposeRequestComplete( NVMainRequest *request )
+{
+    std::map<NVMainRequest *, std::pair<TransposeFlush *, ncounter_t> >::iterator rit;
+    std::map<NVMainRequest *, TransposeFlush *>::iterator wit;
+
+    rit = transposeReads.find( request );
+
+    if( rit != transposeReads.end( ) )
+    {
+        TransposeFlush *flush = rit->second.first;
+        RowStore *rowStore = FindChild( request, SubArray )->GetRowStore( );
+
+        /* Without functional rows, the old lines read as zero. */
+        if( rowStore != NULL )
+        {
+            ncounter_t lineSize = transposer->GetLineSize( );
+
+            rowStore->ReadBytes( rowStore->GetRow( request->address.GetRow( ) ),
+                                 request->address.GetCol( ) * lineSize,
+                                 &flush->lines[rit->second.second][0], lineSize );
+        }
+
+        transposeReads.erase( rit );
+
+        if( --flush->pending == 0 )
+            IssueTransposeWrites( flush );
+    }
+
+    wit = transposeWrites.find( request );
+
+    if( wit != transposeWrites.end( ) )
+    {
+        TransposeFlush *flush = wit->second;
+
+        transposeWrites.erase( wit );
+
+        if( --flush->pending == 0 )
+        {
+            transpose_overhead_cycles += GetEventQueue( )->GetCurrentCycle( ) - flush->start;
+
+            delete flush->group;
+            delete flush;
+
+            /* Bulk operations waiting for the lines can go on. */
+            if( --transposeFlushes == 0 && !bulkSequences.empty( ) )
+            {
+                GetEventQueue( )->InsertUniqueEvent( EventCycle, this, 
+                                  GetEventQueue( )->GetCurrentCycle( ),
+                                  NULL, transactionQueuePriority );
+            }
+        }
+    }
+}
+
+/*
+ *  Row copies. RowClone PSM copies a row into another bank of the same rank
+ *  over the internal bus:
+ *
+ *    source:      [PRE] ACT src  (hold)  PRE src
+ *    destination: [PRE] ACT dst  PSM     PRE dst
+ *
+ *  LISA copies a row into another subarray of the same bank by moving the
+ *  row buffer over linked bitlines and writing it with an overlapped
+ *  activate:
+ *
+ *    source:      [PRE] ACT src  (hold)  PRE src
+ *    destination: [PRE] LISA     OA dst  PRE dst
+ *
+ *  The destination queue is empty when the copy is scheduled. The source
+ *  side is appended to its queue and the hold keeps the source row open
+ *  until the copy command is issued.
+ */
+bool MemoryController::IssueRowCloneCommands( NVMainRequest *req )
+{
+    ncounter_t rank, bank, row, subarray, channel;
+    ncounter_t rank2, bank2, subarray2, channel2;
+
+    req->address.GetTranslatedAddress( &row, NULL, &bank, &rank, &channel, &subarray );
+    req->address2.GetTranslatedAddress( NULL, NULL, &bank2, &rank2, &channel2, &subarray2 );
+
+    bool psm = (req->type == ROWCLONE_PSM);
+
+    if( !p->RowClone )
+    {
+        std::cout << "NVMain Error: " << (psm ? "RowClone PSM" : "LISA") << " copies "
+            << "are disabled. Set `RowClone true' to use them." << std::endl;
+        GetStats( )->PrintAll( std::cerr );
+        exit(1);
+    }
+
+    bool misplaced = (channel != channel2 || rank != rank2);
+
+    if( psm )
+        misplaced = misplaced || bank == bank2;
+    else
+        misplaced = misplaced || bank != bank2 || subarray == subarray2;
+
+    if( misplaced )
+    {
+        std::cout << "NVMain Error: " << (psm ? "RowClone PSM" : "LISA") << " copy 0x" 
+            << std::hex << req->address2.GetPhysicalAddress( ) << " -> 0x"
+            << req->address.GetPhysicalAddress( ) << std::dec << " must stay in "
+            << (psm ? "one rank and change the bank." : "one bank and change the subarray.")
+            << std::endl;
+        GetStats( )->PrintAll( std::cerr );
+        exit(1);
+    }
+
+    NVMAddress& dst = req->address;
+    NVMAddress& src = req->address2;
+    ncounter_t dstQueue = GetCommandQueueId( dst );
+    ncounter_t srcQueue = GetCommandQueueId( src );
+
+    NVMainRequest *copyCommand = AllocateRequest( );
+    *copyCommand = *req;
+    copyCommand->burstCount = p->COLS;
+    copyCommand->issueCycle = GetEventQueue()->GetCurrentCycle();
+    copyCommand->owner = this;
+
+    req->issueCycle = GetEventQueue()->GetCurrentCycle();
+
+    EnqueueCopyActivate( srcQueue, src );
+
+    if( srcQueue != dstQueue )
+    {
+        NVMainRequest *hold = AllocateRequest( );
+
+        hold->type = NOP;
+        hold->address = src;
+        hold->issueCycle = GetEventQueue()->GetCurrentCycle();
+        hold->owner = this;
+
+        commandQueues[srcQueue].push_back( hold );
+        rowCloneHolds[copyCommand] = hold;
+
+        EnqueueCopyPrecharge( srcQueue, src );
+    }
+
+    NVMainRequest *lastCommand = copyCommand;
+
+    if( psm )
+    {
+        EnqueueCopyActivate( dstQueue, dst );
+        commandQueues[dstQueue].push_back( copyCommand );
+
+        rowclone_psm_copies++;
+    }
+    else
+    {
+        /* The row buffer is moved into a precharged subarray. */
+        if( activeSubArray[rank][bank][subarray] && p->UsePrecharge )
+        {
+            commandQueues[dstQueue].push_back( 
+                    MakePrechargeRequest( effectiveRow[rank][bank][subarray], 0, bank, rank, subarray ) );
+        }
+
+        lastCommand = MakePIMRequest( OA, dst, row );
+
+        commandQueues[dstQueue].push_back( copyCommand );
+        commandQueues[dstQueue].push_back( lastCommand );
+
+        rowclone_lisa_copies++;
+    }
+
+    EnqueueCopyPrecharge( dstQueue, dst );
+
+    if( srcQueue == dstQueue )
+        EnqueueCopyPrecharge( srcQueue, src );
+
+    rowCloneCommands[lastCommand] = req;
+
+    ScheduleCommandWake( );
+
+    return true;
+}
+
+/* Opens a copy operand, unless its row is open already. */
+void MemoryController::EnqueueCopyActivate( ncounter_t queueId, NVMAddress& location )
+{
+    ncounter_t rank, bank, row, subarray, col;
+
+    location.GetTranslatedAddress( &row, &col, &bank, &rank, NULL, &subarray );
+
+    if( activeSubArray[rank][bank][subarray] && effectiveRow[rank][bank][subarray] == row )
+        return;
+
+    if( activeSubArray[rank][bank][subarray] && p->UsePrecharge )
+    {
+        commandQueues[queueId].push_back( 
+                MakePrechargeRequest( effectiveRow[rank][bank][subarray], 0, bank, rank, subarray ) );
+    }
+
+    commandQueues[queueId].push_back( MakeActivateRequest( row, col, bank, rank, subarray ) );
+
+    starvationCounter[rank][bank][subarray] = 0;
+    activateQueued[rank][bank] = true;
+    activeSubArray[rank][bank][subarray] = true;
+    effectiveRow[rank][bank][subarray] = row;
+    effectiveMuxedRow[rank][bank][subarray] = static_cast<ncounter_t>(col / p->RBSize);
+}
+
+/* Closes a copy operand once the copy is done with it. */
+void MemoryController::EnqueueCopyPrecharge( ncounter_t queueId, NVMAddress& location )
+{
+    ncounter_t rank, bank, row, subarray;
+
+    location.GetTranslatedAddress( &row, NULL, &bank, &rank, NULL, &subarray );
+
+    commandQueues[queueId].push_back( MakePrechargeRequest( row, 0, bank, rank, subarray ) );
+
+    activeSubArray[rank][bank][subarray] = false;
+    effectiveRow[rank][bank][subarray] = p->ROWS;
+    effectiveMuxedRow[rank][bank][subarray] = p->ROWS;
+
+    UpdateActivateQueued( rank, bank );
+}
+
+/* 
+ *  Holds are never issued, and a copy command waits until its hold reached
+ *  the head of the source queue, i.e., the source row is open.
+ */
+bool MemoryController::RowCloneReady( NVMainRequest *command )
+{
+    if( command->type == NOP )
+        return false;
+
+    if( rowCloneHolds.empty( ) )
+        return true;
+
+    std::map<NVMainRequest *, NVMainRequest *>::iterator it;
+
+    it = rowCloneHolds.find( command );
+
+    if( it == rowCloneHolds.end( ) )
+        return true;
+
+    NVMainRequest *hold = it->second;
+
+    return ( commandQueues[GetCommandQueueId( hold->address )].at( 0 ) == hold );
+}
+
+/* Lets the source queue continue once its copy command was issued. */
+void MemoryController::ReleaseRowCloneHold( NVMainRequest *command )
+{
+    if( rowCloneHolds.empty( ) )
+        return;
+
+    std::map<NVMainRequest *, NVMainRequest *>::iterator it;
+
+    it = rowCloneHolds.find( command );
+
+    if( it != rowCloneHolds.end( ) )
+    {
+        it->second->flags |= NVMainRequest::FLAG_ISSUED;
+        retiredRequests.push_back( it->second );
+
+        rowCloneHolds.erase( it );
+    }
+}
+
+/*
+ *  NOTE: This function assumes the memory controller uses any predicates when
+ *  scheduling. They will not be re-checked here.
+ */
+bool MemoryController::IssueMemoryCommands( NVMainRequest *req )
+{
+    bool rv = false;
+    ncounter_t rank, bank, row, subarray, col;
+
+    req->address.GetTranslatedAddress( &row, &col, &bank, &rank, NULL, &subarray );
+
+    SubArray *writingArray = FindChild( req, SubArray );
+
+    ncounter_t muxLevel = static_cast<ncounter_t>(col / p->RBSize);
+    ncounter_t queueId = GetCommandQueueId( req->address );
+
+    /*
+     *  If the request is somehow accessible (e.g., via caching, etc), but the
+     *  bank state does not match the memory controller, just issue the request
+     *  without updating any internal states.
+     */
+    FailReason reason;
+    NVMainRequest *cachedRequest = MakeCachedRequest( req );
+
+    if( GetChild( )->IsIssuable( cachedRequest, &reason ) )
+    {
+        /* Differentiate from row-buffer hits. */
+        if ( !activateQueued[rank][bank] 
+             || !activeSubArray[rank][bank][subarray]
+             || effectiveRow[rank][bank][subarray] != row 
+             || effectiveMuxedRow[rank][bank][subarray] != muxLevel ) 
+        {
+            req->issueCycle = GetEventQueue()->GetCurrentCycle();
+
+            // Update starvation ??
+            commandQueues[queueId].push_back( req );
+
+            FreeRequest( cachedRequest );
+
+            return true;
+        }
+        else
+        {
+            FreeRequest( cachedRequest );
+        }
+    }
+    else
+    {
+        FreeRequest( cachedRequest );
+    }
+
+    if( !activateQueued[rank][bank] && commandQueues[queueId].empty() )
+    {
+        /* Any activate will reset the starvation counter */
+        activateQueued[rank][bank] = true;
+        activeSubArray[rank][bank][subarray] = true;
+        effectiveRow[rank][bank][subarray] = row;
+        effectiveMuxedRow[rank][bank][subarray] = muxLevel;
+        starvationCounter[rank][bank][subarray] = 0;
+
+        req->issueCycle = GetEventQueue()->GetCurrentCycle();
+
+        NVMainRequest *actRequest = MakeActivateRequest( req );
+        actRequest->flags |= (writingArray != NULL && writingArray->IsWriting( )) ? NVMainRequest::FLAG_PRIORITY : 0;
+        commandQueues[queueId].push_back( actRequest );
+
+        /* Different row buffer management policy has different behavior */ 
+        /*
+         * There are two possibilities that the request is the last request:
+         * 1) ClosePage == 1 and there is no other request having row
+         * buffer hit
+         * or 2) ClosePage == 2, the request is always the last request
+         */
+        if( req->flags & NVMainRequest::FLAG_LAST_REQUEST && p->UsePrecharge )
+        {
+            commandQueues[queueId].push_back( MakeImplicitPrechargeRequest( req ) );
+            activeSubArray[rank][bank][subarray] = false;
             effectiveRow[rank][bank][subarray] = p->ROWS;
             effectiveMuxedRow[rank][bank][subarray] = p->ROWS;
             activateQueued[rank][bank] = false;
@@ -1839,18 +3441,7 @@ bool MemoryController::IssueMemoryCommands( NVMainRequest *req )
             effectiveRow[rank][bank][subarray] = p->ROWS;
             effectiveMuxedRow[rank][bank][subarray] = p->ROWS;
 
-            bool idle = true;
-            for( ncounter_t i = 0; i < subArrayNum; i++ )
-            {
-                if( activeSubArray[rank][bank][i] == true )
-                {
-                    idle = false;
-                    break;
-                }
-            }
-
-            if( idle )
-                activateQueued[rank][bank] = false;
+            UpdateActivateQueued( rank, bank );
         }
         else
         {
@@ -1901,6 +3492,7 @@ void MemoryController::CycleCommandQueues( )
 
         if( !commandQueues[queueId].empty( )
             && lastIssueCycle != GetEventQueue()->GetCurrentCycle()
+            && RowCloneReady( commandQueues[queueId].at( 0 ) )
             && GetChild( )->IsIssuable( commandQueues[queueId].at( 0 ), &fail ) )
         {
             NVMainRequest *queueHead = commandQueues[queueId].at( 0 );
@@ -1914,6 +3506,8 @@ void MemoryController::CycleCommandQueues( )
 
             queueHead->flags |= NVMainRequest::FLAG_ISSUED;
 
+            ReleaseRowCloneHold( queueHead );
+
             if( queueHead->type == REFRESH )
                 ResetRefreshQueued( queueHead->address.GetBank(),
                                     queueHead->address.GetRank() );
@@ -1923,14 +3517,9 @@ void MemoryController::CycleCommandQueues( )
 
             /* Get this cleaned this up. */
             ncycle_t cleanupCycle = GetEventQueue()->GetCurrentCycle() + 1;
-            bool cleanupScheduled = GetEventQueue()->FindCallback( this, 
-                                        (CallbackPtr)&MemoryController::CleanupCallback,
-                                        cleanupCycle, NULL, cleanupPriority );
-
-            if( !cleanupScheduled )
-                GetEventQueue( )->InsertCallback( this, 
-                                  (CallbackPtr)&MemoryController::CleanupCallback,
-                                  cleanupCycle, NULL, cleanupPriority );
+            GetEventQueue( )->InsertUniqueCallback( this, 
+                              (CallbackPtr)&MemoryController::CleanupCallback,
+                              cleanupCycle, NULL, cleanupPriority );
 
             /* If the bank queue will be empty, we can issue another transaction, so wakeup the system. */
             if( commandQueues[queueId].size( ) == 1 )
@@ -1944,6 +3533,12 @@ void MemoryController::CycleCommandQueues( )
                 }
             }
 
+            if( p->PIMBatching && p->PIMActivationBudget != 0 
+                && PIMCostModel::IsMultiRowActivate( queueHead->type ) )
+            {
+                IssuePIMBroadcasts( queueHead, queueId );
+            }
+
             MoveCurrentQueue( );
 
             /* we should return since one time only one command can be issued */
@@ -1986,7 +3581,7 @@ void MemoryController::CycleCommandQueues( )
  * 1 -- Rank-first round-robin
  * 2 -- Bank-first round-robin
  */
-ncounter_t MemoryController::GetCommandQueueId( NVMAddress addr )
+ncounter_t MemoryController::GetCommandQueueId( const NVMAddress& addr )
 {
     ncounter_t queueId = std::numeric_limits<ncounter_t>::max( );
 
@@ -2024,14 +3619,13 @@ ncycle_t MemoryController::NextIssuable( NVMainRequest * /*request*/ )
 {
     /* Determine the next time we need to wakeup. */
     ncycle_t nextWakeup = std::numeric_limits<ncycle_t>::max( );
+    ncounter_t queueSubArrays = (queueModel == PerSubArrayQueues) ? subArrayNum : 1;
 
     /* Check for memory commands to issue. */
     for( ncounter_t rankIdx = 0; rankIdx < p->RANKS; rankIdx++ )
     {
         for( ncounter_t bankIdx = 0; bankIdx < p->BANKS; bankIdx++ )
         {
-            ncounter_t queueIdx = GetCommandQueueId( NVMAddress( 0, 0, bankIdx, rankIdx, 0, 0 ) );
-
             /* Give refresh priority. */
             if( NeedRefresh( bankIdx, rankIdx )
                 && IsRefreshBankQueueEmpty( bankIdx, rankIdx ) )
@@ -2042,12 +3636,21 @@ ncycle_t MemoryController::NextIssuable( NVMainRequest * /*request*/ )
                      nextWakeup = GetEventQueue()->GetCurrentCycle() + 1;
             }
 
-            if( commandQueues[queueIdx].empty( ) )
-                continue;
+            for( ncounter_t saIdx = 0; saIdx < queueSubArrays; saIdx++ )
+            {
+                ncounter_t queueIdx = GetCommandQueueId( NVMAddress( 0, 0, bankIdx, rankIdx, 0, saIdx ) );
 
-            NVMainRequest *queueHead = commandQueues[queueIdx].at( 0 );
+                if( commandQueues[queueIdx].empty( ) )
+                    continue;
 
-            nextWakeup = MIN( nextWakeup, GetChild( )->NextIssuable( queueHead ) );
+                NVMainRequest *queueHead = commandQueues[queueIdx].at( 0 );
+
+                /* Row copy holds are released by their copy command. */
+                if( queueHead->type == NOP )
+                    continue;
+
+                nextWakeup = MIN( nextWakeup, GetChild( )->NextIssuable( queueHead ) );
+            }
         }
     }
 
@@ -2064,14 +3667,18 @@ ncycle_t MemoryController::NextIssuable( NVMainRequest * /*request*/ )
 bool MemoryController::RankQueueEmpty( const ncounter_t& rankId )
 {
     bool rv = true;
+    ncounter_t queueSubArrays = (queueModel == PerSubArrayQueues) ? subArrayNum : 1;
 
-    for( ncounter_t i = 0; i < p->BANKS; i++ )
+    for( ncounter_t i = 0; i < p->BANKS && rv; i++ )
     {
-        ncounter_t queueId = GetCommandQueueId( NVMAddress( 0, 0, i, rankId, 0, 0 ) );
-        if( commandQueues[queueId].empty( ) == false )
+        for( ncounter_t sa = 0; sa < queueSubArrays; sa++ )
         {
-            rv = false;
-            break;
+            ncounter_t queueId = GetCommandQueueId( NVMAddress( 0, 0, i, rankId, 0, sa ) );
+            if( commandQueues[queueId].empty( ) == false )
+            {
+                rv = false;
+                break;
+            }
         }
     }
 
@@ -48,10 +48,13 @@
 #include "src/Config.h"
 #include "src/Interconnect.h"
 #include "src/AddressTranslator.h"
+#include "src/PIMMicroprogram.h"
+#include "src/TransposeUnit.h"
 #include "include/NVMainRequest.h"
 #include <deque>
 #include <iostream>
 #include <list>
+#include <map>
 
 
 namespace NVM {
@@ -125,6 +128,11 @@ class MemoryController : public NVMObject
     void RefreshCallback( void *data );
     virtual void Cycle( ncycle_t steps ); 
 
+    bool Idle( );
+    ncycle_t GetRefreshPeriod( );
+    ncounter_t GetRoundRobinLength( );
+    void FastForward( ncycle_t cycles );
+
     virtual void SetConfig( Config *conf, bool createChildren = true );
     void SetMappingScheme( );
     Config *GetConfig( );
@@ -140,13 +148,35 @@ class MemoryController : public NVMObject
     ncounter_t wakeupCount;
     ncycle_t lastIssueCycle;
 
+    ncounter_t convertedRowActivates;
+
+    ncounter_t pim_broadcasts;
+
+    ncounter_t bulk_rows;
+    ncounter_t bulk_AAPs;
+    ncounter_t bulk_APs;
+    ncounter_t bulk_verify_rows;
+    ncounter_t bulk_verify_failures;
+
+    ncounter_t rowclone_psm_copies;
+    ncounter_t rowclone_lisa_copies;
+
+    ncounter_t transpose_lines;
+    ncounter_t transpose_groups;
+    ncounter_t transpose_partial_groups;
+    ncounter_t transpose_reads;
+    ncounter_t transpose_writes;
+    ncounter_t transpose_busy_cycles;
+    ncounter_t transpose_overhead_cycles;
+    double transpose_energy;
+
     std::list<NVMainRequest *> *transactionQueues;
     std::deque<NVMainRequest *> *commandQueues;
     ncounter_t commandQueueCount;
     ncounter_t transactionQueueCount;
     QueueModel queueModel;
 
-    ncounter_t GetCommandQueueId( NVMAddress addr );
+    ncounter_t GetCommandQueueId( const NVMAddress& addr );
 
     bool **activateQueued;
     bool **refreshQueued;
@@ -160,11 +190,140 @@ class MemoryController : public NVMObject
     bool *rankPowerDown;
 
     bool TransactionAvailable( ncounter_t queueId );
+    void UpdateActivateQueued( ncounter_t rank, ncounter_t bank );
     void ScheduleCommandWake( );
     void Prequeue( ncounter_t queueNum, NVMainRequest *request );
     void Enqueue( ncounter_t queueNum, NVMainRequest *request );
-    void EnqueueAAP( ncounter_t queueNum, NVMainRequest *request );
+    /* Transaction queue the scheduler would put this request in. */
+    virtual ncounter_t GetTransactionQueueId( NVMainRequest *request );
+    void EnqueueAAP( ncounter_t queueId, NVMainRequest *activate, NVMainRequest *overlapped );
+    void EnqueueAP( ncounter_t queueId, NVMainRequest *activate );
+
+    /* 
+     *  Bulk bitwise operations are expanded one DRAM row at a time into
+     *  AAP/AP microprograms. Up to one row per command queue is staged, so
+     *  rows in different banks and subarrays are processed in parallel.
+     *  Arithmetic operations run a compiled microprogram on each row of
+     *  elements, whose bits are consecutive rows of every operand.
+     */
+    struct BulkSequence
+    {
+        NVMainRequest *request;
+        PIMMicroprogram *program;
+        ncounter_t nextRow;
+        ncounter_t rows;
+        ncounter_t staged;
+        ncounter_t outstanding;
+    };
+
+    struct BulkRow
+    {
+        BulkSequence *sequence;
+        NVMAddress dst;
+        NVMAddress src1;
+        NVMAddress src2;
+        std::vector<ncounter_t> dstRows;
+        std::vector<ncounter_t> src1Rows;
+        std::vector<ncounter_t> src2Rows;
+        ncounter_t queueId;
+    };
+
+    std::list<BulkSequence *> bulkSequences;
+    std::list<BulkRow> bulkRows;
+    std::map<NVMainRequest *, BulkSequence *> bulkRowCommands;
+    std::map<std::pair<BulkBitwiseOp, ncounter_t>, PIMMicroprogram *> microprograms;
+
+    void EnqueueBulkOperation( NVMainRequest *request );
+    void CycleBulkSequencer( );
+    bool BulkRowAvailable( ncounter_t queueId );
+    bool TranslateBulkAddress( uint64_t physicalAddress, NVMAddress& address );
+    bool TranslateBulkRows( uint64_t physicalAddress, ncounter_t bits, NVMAddress& dst,
+                            NVMAddress& first, std::vector<ncounter_t>& rows );
+    PIMMicroprogram *GetMicroprogram( BulkBitwiseOp op, ncounter_t width );
+    void CheckBulkRequirements( NVMainRequest *request, PIMMicroprogram *program );
+    void IssueBulkRow( BulkRow& bulkRow );
+    NVMainRequest *EnqueueMicroprogram( ncounter_t queueId, BulkRow& bulkRow, 
+                                        NVMainRequest **firstCommand );
+    ncounter_t GetBulkOperandRow( BulkRow& bulkRow, const PIMRowRef& ref );
+    void RetireBulkSequences( );
+
+    /*
+     *  With PIMVerify, the result of each bulk row is predicted with the row
+     *  kernels once its first activate completes and is checked against the
+     *  destination row when its microprogram finishes.
+     */
+    struct BulkVerify
+    {
+        BulkBitwiseOp op;
+        PIMMicroprogram *program;
+        std::vector<ncounter_t> dstRows;
+        std::vector<ncounter_t> src1Rows;
+        std::vector<ncounter_t> src2Rows;
+        std::vector<uint64_t> expected;
+    };
+
+    std::map<NVMainRequest *, BulkVerify *> bulkVerifyStarts;
+    std::map<NVMainRequest *, BulkVerify *> bulkVerifyEnds;
+
+    void PredictBulkRow( NVMainRequest *request, BulkVerify *verify );
+    void CheckBulkRow( NVMainRequest *request, BulkVerify *verify );
+
+    /*
+     *  Host writes to the transpose region are gathered by the transposition
+     *  unit. A group that leaves its buffer goes through the transposition
+     *  stage, which takes TransposeLineCycles per line plus TransposeLatency,
+     *  and is then written back as one vertical line per bit. Groups taken
+     *  out incomplete first read the vertical lines they are merged into.
+     *  Bulk operations flush the buffer and wait for the vertical lines.
+     */
+    struct TransposeFlush
+    {
+        TransposeGroup *group;
+        ncycle_t start;
+        ncounter_t pending;
+        std::vector<std::vector<uint8_t> > lines;
+    };
 
+    TransposeUnit *transposer;
+    ncycle_t transposeFree;
+    ncounter_t transposeFlushes;
+    std::map<NVMainRequest *, std::pair<TransposeFlush *, ncounter_t> > transposeReads;
+    std::map<NVMainRequest *, TransposeFlush *> transposeWrites;
+
+    bool IsTransposeWrite( NVMainRequest *request );
+    void EnqueueTransposeWrite( NVMainRequest *request );
+    void FlushTransposeGroup( TransposeGroup *group );
+    void FlushTransposeBuffer( );
+    void TransposeCallback( void *data );
+    NVMainRequest *MakeTransposeRequest( OpType type, uint64_t address );
+    void IssueTransposeWrites( TransposeFlush *flush );
+    void TransposeRequestComplete( NVMainRequest *request );
+
+    /*
+     *  Row copies use a source and a destination command queue. When these
+     *  differ, the source queue is held after opening its row until the
+     *  copy command at the head of the destination queue is issued.
+     */
+    std::map<NVMainRequest *, NVMainRequest *> rowCloneHolds;
+    std::map<NVMainRequest *, NVMainRequest *> rowCloneCommands;
+
+    bool IssueRowCloneCommands( NVMainRequest *req );
+    void EnqueueCopyActivate( ncounter_t queueId, NVMAddress& location );
+    void EnqueueCopyPrecharge( ncounter_t queueId, NVMAddress& location );
+    bool RowCloneReady( NVMainRequest *command );
+    void ReleaseRowCloneHold( NVMainRequest *command );
+
+
+    /* 
+     *  Requests generated by the memory controller are recycled rather than
+     *  freed. Completed requests are retired first and are only reused after
+     *  the next command queue cleanup drops any remaining references.
+     */
+    std::vector<NVMainRequest *> freeRequests;
+    std::vector<NVMainRequest *> retiredRequests;
+
+    NVMainRequest *AllocateRequest( );
+    void FreeRequest( NVMainRequest *request );
 
     NVMainRequest *MakeCachedRequest( NVMainRequest *triggerRequest );
     NVMainRequest *MakeActivateRequest( NVMainRequest *triggerRequest );
@@ -175,6 +334,8 @@ class MemoryController : public NVMObject
     NVMainRequest *MakeShiftRequest( const ncounter_t, const ncounter_t, 
                                         const ncounter_t, const ncounter_t, 
                                         const ncounter_t );
+    NVMainRequest *MakePIMRequest( OpType pimOp, NVMAddress& location, 
+                                   const ncounter_t row );
     NVMainRequest *MakeImplicitPrechargeRequest( NVMainRequest *triggerRequest );
     NVMainRequest *MakePrechargeRequest( NVMainRequest *triggerRequest );
     NVMainRequest *MakePrechargeRequest( const ncounter_t, const ncounter_t, 
@@ -206,6 +367,10 @@ class MemoryController : public NVMObject
 
     bool IssueMemoryCommands( NVMainRequest *req );
     bool IssuePIMCommands( NVMainRequest *req );
+    bool IssueLocalWriteCommands( NVMainRequest *req );
+    ncounter_t IssuePIMBatch( std::list<NVMainRequest *>& transactionQueue, NVMainRequest *leader );
+    void IssuePIMBroadcasts( NVMainRequest *leader, ncounter_t leaderQueue );
+    bool CheckReservedRows( NVMainRequest *req );
 
     void CycleCommandQueues( );
 
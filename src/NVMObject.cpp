@@ -270,6 +270,7 @@ NVMObject *NVMObject_hook::GetTrampoline( )
 NVMObject::NVMObject( )
 {
     parent = NULL;
+    selfHook = NULL;
     decoder = NULL;
     children.clear( );
     eventQueue = NULL;
@@ -402,6 +403,7 @@ void NVMObject::SetParent( NVMObject *p )
     NVMObject_hook *hook = new NVMObject_hook( p );
 
     parent = hook;
+    selfHook = NULL;
     SetEventQueue( p->GetEventQueue( ) );
     SetGlobalEventQueue( p->GetGlobalEventQueue( ) );
     SetStats( p->GetStats( ) );
@@ -414,6 +416,7 @@ void NVMObject::UnsetParent( )
     {
         delete parent;
         parent = NULL;
+        selfHook = NULL;
     }
 }
 
@@ -434,6 +437,13 @@ void NVMObject::AddChild( NVMObject *c )
     }
 
     children.push_back( hook );
+
+    /* Otherwise the hook is looked up once the parent is set. */
+    if( c->GetParent( ) != NULL && c->GetParent( )->GetTrampoline( ) == this 
+        && c->selfHook == NULL )
+    {
+        c->selfHook = hook;
+    }
 }
 
 NVMObject *NVMObject::_FindChild( NVMainRequest *req, const char *childClass )
@@ -484,6 +494,27 @@ NVMObject_hook* NVMObject::GetParent( )
     return parent;
 }
 
+NVMObject_hook *NVMObject::GetSelfHook( )
+{
+    /* Find our hook in the parent's children list once and remember it. */
+    if( selfHook == NULL && parent != NULL )
+    {
+        std::vector<NVMObject_hook *>& siblings = parent->GetTrampoline( )->GetChildren( );
+        std::vector<NVMObject_hook *>::iterator it;
+
+        for( it = siblings.begin( ); it != siblings.end( ); it++ )
+        {
+            if( (*it)->GetTrampoline( ) == this )
+            {
+                selfHook = (*it);
+                break;
+            }
+        }
+    }
+
+    return selfHook;
+}
+
 std::vector<NVMObject_hook *>& NVMObject::GetChildren( )
 {
     return children;
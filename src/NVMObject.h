@@ -182,6 +182,7 @@ class NVMObject
     virtual GlobalEventQueue *GetGlobalEventQueue( );
 
     NVMObject_hook *GetParent( );
+    NVMObject_hook *GetSelfHook( );
     std::vector<NVMObject_hook *>& GetChildren( );
     NVMObject_hook *GetChild( NVMainRequest *req );  
     NVMObject_hook *GetChild( ncounter_t child );
@@ -227,6 +228,7 @@ class NVMObject
   protected:
     
     NVMObject_hook *parent;
+    NVMObject_hook *selfHook; /* Our hook in the parent's children list. */
     AddressTranslator *decoder;
     Stats *stats;
     Params *p;
@@ -0,0 +1,301 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+*
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+*
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* Author list:
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+
+
+#include "src/PIMCostModel.h"
+#include "src/Config.h"
+#include "src/Params.h"
+#include "include/NVMHelpers.h"
+
+#include <algorithm>
+
+using namespace NVM;
+
+const ncounter_t PIMCostModel::MaxRows;
+
+/* Each extra row adds 0.22 activates of energy, as measured for Ambit. */
+static const PIMPrimitiveInfo primitiveInfo[PIMPrimitives + 1] = 
+{
+    { OA,       "OA",   "overlapped_activates",            1, true,  1.0  },
+    { ODRA,     "ODRA", "overlapped_double_row_activates", 2, true,  1.22 },
+    { OTRA,     "OTRA", "overlapped_triple_row_activates", 3, true,  1.44 },
+    { SRA,      "SRA",  "single_row_activates",            1, false, 1.0  },
+    { DRA,      "DRA",  "double_row_activates",            2, false, 1.22 },
+    { TRA,      "TRA",  "triple_row_activates",            3, false, 1.44 },
+    { QRA,      "QRA",  "quadruple_row_activates",         4, false, 1.66 },
+    { FRA,      "FRA",  "five_row_activates",              5, false, 1.88 },
+    { ACTIVATE, "ACT",  "activates",                       1, false, 1.0  }
+};
+
+PIMCostModel::PIMCostModel( )
+{
+    p = NULL;
+
+    for( ncounter_t i = 0; i <= PIMPrimitives; i++ )
+    {
+        costs[i].tRCD = 0;
+        costs[i].tRAS = 0;
+        costs[i].tRP = 0;
+        costs[i].tCS = 0;
+        costs[i].IDD = 0.0;
+        costs[i].scale = primitiveInfo[i].scale;
+    }
+
+    for( ncounter_t i = 0; i < PIMPrimitives; i++ )
+        enabled[i] = ( primitiveInfo[i].rows <= 3 );
+}
+
+void PIMCostModel::SetParams( Config *c, Params *p )
+{
+    Config *profile = NULL;
+
+    this->p = p;
+
+    if( c->KeyExists( "PIMProfile" ) )
+    {
+        std::string profileFile = c->GetString( "PIMProfile" );
+
+        if( profileFile[0] != '/' )
+            profileFile = NVM::GetFilePath( c->GetFileName( ) ) + profileFile;
+
+        profile = new Config( );
+        profile->Read( profileFile );
+
+        /* Timings given in ns are converted with the clock of the memory. */
+        profile->SetValue( "CLK", c->GetString( "CLK" ) );
+    }
+
+    /* The last entry is a regular activate and keeps the base costs. */
+    costs[PIMPrimitives].IDD = p->EIDD0;
+
+    for( ncounter_t i = 0; i < PIMPrimitives; i++ )
+        ReadCost( c, profile, static_cast<PIMPrimitive>(i) );
+
+    delete profile;
+}
+
+Config *PIMCostModel::GetKeyConfig( Config *c, Config *profile, std::string key )
+{
+    if( profile == NULL || c->KeyExists( key ) )
+        return c;
+
+    return profile;
+}
+
+void PIMCostModel::ReadCost( Config *c, Config *profile, PIMPrimitive primitive )
+{
+    PIMActivateCost& cost = costs[primitive];
+    std::string prefix = std::string( "PIM_" ) + primitiveInfo[primitive].name + "_";
+    std::string key;
+    const char *keys[] = { "tRCD", "tRAS", "tRP", "tCS", "IDD", "Scale" };
+
+    if( p->pimMode == PIMMode_Pinatubo )
+        enabled[primitive] = true;
+
+    for( ncounter_t i = 0; i < 6; i++ )
+    {
+        key = prefix + keys[i];
+        if( GetKeyConfig( c, profile, key )->KeyExists( key ) )
+            enabled[primitive] = true;
+    }
+
+    key = prefix + "tRCD";
+    p->ConvertTiming( GetKeyConfig( c, profile, key ), key, cost.tRCD );
+    key = prefix + "tRAS";
+    p->ConvertTiming( GetKeyConfig( c, profile, key ), key, cost.tRAS );
+    key = prefix + "tRP";
+    p->ConvertTiming( GetKeyConfig( c, profile, key ), key, cost.tRP );
+    key = prefix + "tCS";
+    p->ConvertTiming( GetKeyConfig( c, profile, key ), key, cost.tCS );
+
+    key = prefix + "Scale";
+    if( GetKeyConfig( c, profile, key )->KeyExists( key ) )
+        GetKeyConfig( c, profile, key )->GetEnergy( key, cost.scale );
+
+    /* 
+     *  Without an IDD, the activate draws `scale' times the energy of a
+     *  regular activate above the standby current.
+     */
+    if( primitiveInfo[primitive].overlapped )
+    {
+        cost.IDD = p->EIDD3N + cost.scale * (p->EIDD0 - p->EIDD3N);
+    }
+    else if( p->tRAS + p->tRP > 0 )
+    {
+        double tRC = static_cast<double>(p->tRAS + p->tRP);
+        double activate = p->EIDD0 * tRC - ( p->EIDD3N * static_cast<double>(p->tRAS) 
+                                           + p->EIDD2N * static_cast<double>(p->tRP) );
+
+        cost.IDD = p->EIDD0 + (cost.scale - 1.0) * activate / tRC;
+    }
+    else
+    {
+        cost.IDD = cost.scale * p->EIDD0;
+    }
+
+    key = prefix + "IDD";
+    if( GetKeyConfig( c, profile, key )->KeyExists( key ) )
+        GetKeyConfig( c, profile, key )->GetEnergy( key, cost.IDD );
+}
+
+PIMPrimitive PIMCostModel::GetPrimitive( OpType type )
+{
+    for( ncounter_t i = 0; i < PIMPrimitives; i++ )
+    {
+        if( primitiveInfo[i].type == type )
+            return static_cast<PIMPrimitive>(i);
+    }
+
+    return PIMPrimitives;
+}
+
+PIMPrimitive PIMCostModel::GetPrimitive( const std::string& name )
+{
+    for( ncounter_t i = 0; i < PIMPrimitives; i++ )
+    {
+        if( name == primitiveInfo[i].name )
+            return static_cast<PIMPrimitive>(i);
+    }
+
+    return PIMPrimitives;
+}
+
+/* 
+ *  The multi-row activate that raises this many rows. Other row counts map
+ *  to the widest primitive, which Pinatubo stretches to the requested rows.
+ */
+OpType PIMCostModel::GetMultiRowActivate( ncounter_t rows )
+{
+    OpType type = SRA;
+    ncounter_t widest = 0;
+
+    for( ncounter_t i = 0; i < PIMPrimitives; i++ )
+    {
+        if( primitiveInfo[i].overlapped )
+            continue;
+
+        if( primitiveInfo[i].rows == rows )
+            return primitiveInfo[i].type;
+
+        if( primitiveInfo[i].rows > widest )
+        {
+            type = primitiveInfo[i].type;
+            widest = primitiveInfo[i].rows;
+        }
+    }
+
+    return type;
+}
+
+const PIMPrimitiveInfo& PIMCostModel::GetInfo( PIMPrimitive primitive )
+{
+    return primitiveInfo[primitive];
+}
+
+/* Primitives that raise their rows from a precharged subarray. */
+bool PIMCostModel::IsMultiRowActivate( OpType type )
+{
+    PIMPrimitive primitive = GetPrimitive( type );
+
+    return primitive != PIMPrimitives && !primitiveInfo[primitive].overlapped;
+}
+
+/* Primitives that raise their rows into an open row buffer. */
+bool PIMCostModel::IsOverlappedActivate( OpType type )
+{
+    PIMPrimitive primitive = GetPrimitive( type );
+
+    return primitive != PIMPrimitives && primitiveInfo[primitive].overlapped;
+}
+
+ncounter_t PIMCostModel::GetRows( OpType type )
+{
+    return primitiveInfo[GetPrimitive( type )].rows;
+}
+
+bool PIMCostModel::IsEnabled( PIMPrimitive primitive )
+{
+    return enabled[primitive];
+}
+
+const PIMActivateCost& PIMCostModel::GetCost( OpType type )
+{
+    return costs[GetPrimitive( type )];
+}
+
+ncycle_t PIMCostModel::GetActivateCycles( OpType type )
+{
+    const PIMActivateCost& cost = GetCost( type );
+
+    return p->tRCD + cost.tRCD + cost.tCS;
+}
+
+/* Overlapped activates can be precharged once the row buffer is copied. */
+ncycle_t PIMCostModel::GetRestoreCycles( OpType type )
+{
+    const PIMActivateCost& cost = GetCost( type );
+    ncycle_t restore = cost.tRAS + cost.tCS;
+
+    if( !IsOverlappedActivate( type ) )
+        restore += p->tRAS;
+
+    return std::max( GetActivateCycles( type ), restore );
+}
+
+ncycle_t PIMCostModel::GetPrechargeDelay( OpType type )
+{
+    return GetCost( type ).tRP;
+}
+
+double PIMCostModel::GetEnergy( OpType type )
+{
+    const PIMActivateCost& cost = GetCost( type );
+
+    if( p->EnergyModel != "current" )
+        return cost.scale * p->Erd;
+
+    if( IsOverlappedActivate( type ) )
+    {
+        /* Active energy above standby while the row buffer drives the rows. */
+        double tActivate = static_cast<double>(GetActivateCycles( type ));
+
+        return ( cost.IDD - p->EIDD3N ) * tActivate / static_cast<double>(p->BANKS);
+    }
+
+    double tRAS = static_cast<double>(p->tRAS + cost.tRAS + cost.tCS);
+    double tRP = static_cast<double>(p->tRP + cost.tRP);
+
+    return ( cost.IDD * (tRAS + tRP) - ( p->EIDD3N * tRAS + p->EIDD2N * tRP ) ) 
+           / static_cast<double>(p->BANKS);
+}
@@ -0,0 +1,139 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+*
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+*
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* Author list:
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+
+
+#ifndef __NVMAIN_PIMCOSTMODEL_H__
+#define __NVMAIN_PIMCOSTMODEL_H__
+
+#include <string>
+
+#include "include/NVMTypes.h"
+#include "include/NVMainRequest.h"
+
+namespace NVM {
+
+class Config;
+class Params;
+
+/* Activate primitives of the PIM command set, in the order of their stats. */
+enum PIMPrimitive
+{
+    PIM_OA,
+    PIM_ODRA,
+    PIM_OTRA,
+    PIM_SRA,
+    PIM_DRA,
+    PIM_TRA,
+    PIM_QRA,
+    PIM_FRA,
+    PIMPrimitives               ///< Number of primitives, or not a primitive
+};
+
+struct PIMPrimitiveInfo
+{
+    OpType type;
+    const char *name;           ///< Name in traces and cost keys
+    const char *statName;       ///< Activate count of ranks, banks and subarrays
+    ncounter_t rows;            ///< Rows raised by the command
+    bool overlapped;            ///< Issued while the row buffer is open
+    double scale;               ///< Default energy relative to an activate
+};
+
+/*
+ *  Cost of a primitive on top of a regular activate. Charge sharing delays
+ *  sensing, so tCS adds to the activate and the restore time.
+ */
+struct PIMActivateCost
+{
+    ncycle_t tRCD;
+    ncycle_t tRAS;
+    ncycle_t tRP;               ///< Added to the precharge that closes the rows
+    ncycle_t tCS;
+    double IDD;                 ///< Activate current (mA) of the current energy model
+    double scale;               ///< Energy relative to an activate, flat energy model
+};
+
+/*
+ *  Table-driven timing and energy of the PIM activate primitives, shared by
+ *  the rank, bank and subarray. Each primitive reads PIM_<name>_tRCD,
+ *  _tRAS, _tRP, _tCS, _IDD and _Scale from the config, or from the file
+ *  given by PIMProfile; keys in the config take precedence.
+ */
+class PIMCostModel
+{
+  public:
+    PIMCostModel( );
+    ~PIMCostModel( ) { }
+
+    void SetParams( Config *c, Params *p );
+
+    static const ncounter_t MaxRows = 5;
+
+    static PIMPrimitive GetPrimitive( OpType type );
+    static PIMPrimitive GetPrimitive( const std::string& name );
+    static OpType GetMultiRowActivate( ncounter_t rows );
+    static const PIMPrimitiveInfo& GetInfo( PIMPrimitive primitive );
+    static bool IsMultiRowActivate( OpType type );
+    static bool IsOverlappedActivate( OpType type );
+    static ncounter_t GetRows( OpType type );
+
+    /* 
+     *  Activates of more than three rows are only enabled by costs of their
+     *  own or by Pinatubo's multi-row sensing.
+     */
+    bool IsEnabled( PIMPrimitive primitive );
+
+    const PIMActivateCost& GetCost( OpType type );
+
+    /* Cycles until the row buffer holds the result. */
+    ncycle_t GetActivateCycles( OpType type );
+    /* Cycles until the raised rows may be precharged. */
+    ncycle_t GetRestoreCycles( OpType type );
+    /* Cycles the primitive adds to the following precharge. */
+    ncycle_t GetPrechargeDelay( OpType type );
+    /* Energy in the units of the subarray's energy model. */
+    double GetEnergy( OpType type );
+
+  private:
+    Params *p;
+    PIMActivateCost costs[PIMPrimitives + 1];
+    bool enabled[PIMPrimitives];
+
+    void ReadCost( Config *c, Config *profile, PIMPrimitive primitive );
+    Config *GetKeyConfig( Config *c, Config *profile, std::string key );
+};
+
+};
+
+#endif
@@ -0,0 +1,758 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+*
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+*
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* Author list:
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+
+#include "src/PIMMicroprogram.h"
+#include "src/RowStore.h"
+
+#include <algorithm>
+
+using namespace NVM;
+
+/* Marks a compute row whose contents are unknown. */
+static const ncounter_t noLiteral = static_cast<ncounter_t>(-1);
+
+/* Load cost of a value that is only held in other compute rows. */
+static const ncounter_t unreachableCost = 1000;
+
+PIMMicroprogram::PIMMicroprogram( BulkBitwiseOp op, ncounter_t width, Params *p )
+{
+    this->op = op;
+    this->width = width;
+    this->p = p;
+
+    aaps = aps = majorities = scratchRows = 0;
+    usesZero = usesOne = false;
+
+    /* Node 0 is the constant zero, followed by the source bits. */
+    Node zero;
+
+    zero.kind = Node_Zero;
+    zero.bit = 0;
+    nodes.push_back( zero );
+
+    for( ncounter_t bit = 0; bit < 2 * width; bit++ )
+    {
+        Node input;
+
+        input.kind = (bit < width) ? Node_Src1 : Node_Src2;
+        input.bit = bit % width;
+        nodes.push_back( input );
+    }
+
+    switch( op )
+    {
+        case BBOP_ADD:
+            BuildAdd( false );
+            break;
+
+        case BBOP_SUB:
+            BuildAdd( true );
+            break;
+
+        case BBOP_LT:
+            BuildLessThan( );
+            break;
+
+        case BBOP_MUL:
+            BuildMultiply( );
+            break;
+
+        case BBOP_POPCOUNT:
+            BuildPopcount( );
+            break;
+
+        default:
+            break;
+    }
+
+    Map( );
+}
+
+ncounter_t PIMMicroprogram::GetResultWidth( BulkBitwiseOp op, ncounter_t width )
+{
+    ncounter_t bits = 0;
+
+    switch( op )
+    {
+        case BBOP_ADD:
+        case BBOP_SUB:
+        case BBOP_MUL:
+            bits = width;
+            break;
+
+        case BBOP_POPCOUNT:
+            /* Enough bits to count up to width. */
+            while( (width >> bits) != 0 )
+                bits++;
+            break;
+
+        default:
+            bits = 1;
+            break;
+    }
+
+    return bits;
+}
+
+/* T0-T2 are always used, scratch rows follow from T3. */
+ncounter_t PIMMicroprogram::GetBGroupRows( )
+{
+    return std::max( (ncounter_t)4, 3 + scratchRows );
+}
+
+PIMMicroprogram::Literal PIMMicroprogram::Input( NodeKind kind, ncounter_t bit )
+{
+    return (1 + bit + ((kind == Node_Src2) ? width : 0)) << 1;
+}
+
+/*
+ *  Creates a majority gate. Gates are folded when two inputs are equal or
+ *  complements, are stored with at most one complemented input and are
+ *  shared between identical inputs.
+ */
+PIMMicroprogram::Literal PIMMicroprogram::Majority( Literal a, Literal b, Literal c )
+{
+    if( a == b || a == c )
+        return a;
+    if( b == c )
+        return b;
+    if( a == (b ^ 1) )
+        return c;
+    if( a == (c ^ 1) )
+        return b;
+    if( b == (c ^ 1) )
+        return a;
+
+    Literal complement = 0;
+
+    if( (a & 1) + (b & 1) + (c & 1) >= 2 )
+    {
+        a ^= 1;
+        b ^= 1;
+        c ^= 1;
+        complement = 1;
+    }
+
+    std::vector<Literal> key( 3 );
+
+    key[0] = a;
+    key[1] = b;
+    key[2] = c;
+    std::sort( key.begin( ), key.end( ) );
+
+    std::map<std::vector<Literal>, Literal>::iterator it = majorityNodes.find( key );
+
+    if( it != majorityNodes.end( ) )
+        return it->second ^ complement;
+
+    Node node;
+
+    node.kind = Node_Majority;
+    node.bit = 0;
+    node.in[0] = key[0];
+    node.in[1] = key[1];
+    node.in[2] = key[2];
+    nodes.push_back( node );
+
+    Literal result = (nodes.size( ) - 1) << 1;
+
+    majorityNodes[key] = result;
+
+    return result ^ complement;
+}
+
+/*
+ *  SIMDRAM full adder: carry = MAJ(a, b, c) and
+ *  sum = MAJ(!carry, c, MAJ(a, b, !c)).
+ */
+PIMMicroprogram::Literal PIMMicroprogram::Sum( Literal a, Literal b, Literal c, Literal *carry )
+{
+    Literal carryOut = Majority( a, b, c );
+    Literal sum = Majority( carryOut ^ 1, c, Majority( a, b, c ^ 1 ) );
+
+    *carry = carryOut;
+
+    return sum;
+}
+
+/* Ripple-carry src1 + src2, or src1 + !src2 + 1 for subtraction. */
+void PIMMicroprogram::BuildAdd( bool subtract )
+{
+    Literal carry = subtract ? One( ) : Zero( );
+
+    for( ncounter_t bit = 0; bit < width; bit++ )
+    {
+        Literal b = Input( Node_Src2, bit ) ^ (subtract ? 1 : 0);
+
+        resultBits.push_back( Sum( Input( Node_Src1, bit ), b, carry, &carry ) );
+    }
+}
+
+/* src1 < src2 exactly when src1 - src2 borrows, so only carries are needed. */
+void PIMMicroprogram::BuildLessThan( )
+{
+    Literal carry = One( );
+
+    for( ncounter_t bit = 0; bit < width; bit++ )
+        carry = Majority( Input( Node_Src1, bit ), Input( Node_Src2, bit ) ^ 1, carry );
+
+    resultBits.push_back( carry ^ 1 );
+}
+
+/* Shift-and-add of the partial products, truncated to width bits. */
+void PIMMicroprogram::BuildMultiply( )
+{
+    std::vector<Literal> product( width, Zero( ) );
+
+    for( ncounter_t i = 0; i < width; i++ )
+    {
+        Literal carry = Zero( );
+
+        for( ncounter_t j = 0; i + j < width; j++ )
+        {
+            Literal partial = And( Input( Node_Src1, j ), Input( Node_Src2, i ) );
+
+            product[i + j] = Sum( product[i + j], partial, carry, &carry );
+        }
+    }
+
+    resultBits = product;
+}
+
+/* Adds the bits of src1 into a counter one at a time. */
+void PIMMicroprogram::BuildPopcount( )
+{
+    std::vector<Literal> count( GetResultWidth( op, width ), Zero( ) );
+
+    for( ncounter_t bit = 0; bit < width; bit++ )
+    {
+        Literal carry = Input( Node_Src1, bit );
+
+        for( ncounter_t k = 0; k < count.size( ); k++ )
+            count[k] = Sum( count[k], carry, Zero( ), &carry );
+    }
+
+    resultBits = count;
+}
+
+PIMRowRef PIMMicroprogram::ComputeRowRef( ComputeRow row )
+{
+    PIMRowRef ref;
+
+    ref.operand = PIMOperand_Reserved;
+
+    if( row == Row_DCC0 || row == Row_DCC1 )
+        ref.index = p->GetReservedRowBase( ReservedRow_DCC ) + (row - Row_DCC0);
+    else
+        ref.index = p->GetReservedRowBase( ReservedRow_BGroup ) + row;
+
+    return ref;
+}
+
+bool PIMMicroprogram::HasHome( Literal value )
+{
+    return (value >> 1) == 0 || homed[value >> 1];
+}
+
+/* The row that reads as the value, which must not be complemented. */
+PIMRowRef PIMMicroprogram::Home( Literal value )
+{
+    ncounter_t node = value >> 1;
+
+    if( node != 0 )
+        return homes[node];
+
+    PIMRowRef ref;
+
+    ref.operand = PIMOperand_Reserved;
+
+    if( value == Zero( ) )
+    {
+        ref.index = p->GetReservedRowBase( ReservedRow_Zero );
+        usesZero = true;
+    }
+    else
+    {
+        ref.index = p->GetReservedRowBase( ReservedRow_One );
+        usesOne = true;
+    }
+
+    return ref;
+}
+
+/*
+ *  AAPs needed to make a compute row read as the value. DCC0 stores the
+ *  complement of what is copied into it, so it takes a complemented value
+ *  in one AAP. Other complements are made in DCC1 first.
+ */
+ncounter_t PIMMicroprogram::LoadCost( Literal value, ComputeRow row )
+{
+    if( holds[row] == value )
+        return 0;
+
+    Literal positive = value & ~static_cast<Literal>(1);
+
+    if( positive == Zero( ) )
+        return 1;
+
+    if( !HasHome( positive ) )
+        return unreachableCost;
+
+    if( row == Row_DCC0 )
+    {
+        if( value & 1 )
+            return 1;
+
+        return (holds[Row_DCC1] == (value ^ 1)) ? 1 : 2;
+    }
+
+    if( !(value & 1) )
+        return 1;
+
+    return (holds[Row_DCC1] == value) ? 1 : 2;
+}
+
+/* Makes DCC1 read as the complement of the value. */
+void PIMMicroprogram::Negate( Literal value )
+{
+    if( holds[Row_DCC1] == (value ^ 1) )
+        return;
+
+    Emit( true, SRA, Home( value ), OA, ComputeRowRef( Row_DCC1 ) );
+    holds[Row_DCC1] = value ^ 1;
+}
+
+void PIMMicroprogram::Load( Literal value, ComputeRow row )
+{
+    if( holds[row] == value )
+        return;
+
+    Literal positive = value & ~static_cast<Literal>(1);
+
+    if( positive == Zero( ) )
+    {
+        /* Constants come from C0 and C1; DCC0 takes the other one. */
+        Emit( true, SRA, Home( (row == Row_DCC0) ? (value ^ 1) : value ),
+              OA, ComputeRowRef( row ) );
+    }
+    else if( row == Row_DCC0 && (value & 1) )
+    {
+        Emit( true, SRA, Home( positive ), OA, ComputeRowRef( row ) );
+    }
+    else if( row == Row_DCC0 )
+    {
+        Negate( value );
+        Emit( true, SRA, ComputeRowRef( Row_DCC1 ), OA, ComputeRowRef( row ) );
+    }
+    else if( value & 1 )
+    {
+        Negate( positive );
+        Emit( true, SRA, ComputeRowRef( Row_DCC1 ), OA, ComputeRowRef( row ) );
+    }
+    else
+    {
+        Emit( true, SRA, Home( value ), OA, ComputeRowRef( row ) );
+    }
+
+    holds[row] = value;
+}
+
+/* Copies a value, which has a home, into a result row. */
+void PIMMicroprogram::WriteResult( Literal value, PIMRowRef target )
+{
+    Literal positive = value & ~static_cast<Literal>(1);
+
+    if( positive == Zero( ) || !(value & 1) )
+    {
+        Emit( true, SRA, Home( value ), OA, target );
+    }
+    else
+    {
+        Negate( positive );
+        Emit( true, SRA, ComputeRowRef( Row_DCC1 ), OA, target );
+    }
+}
+
+void PIMMicroprogram::Emit( bool fused, OpType activate, PIMRowRef source,
+                            OpType overlapped, PIMRowRef target )
+{
+    PIMMicroOp microOp;
+
+    microOp.fused = fused;
+    microOp.activate = activate;
+    microOp.source = source;
+    microOp.overlapped = overlapped;
+    microOp.target = target;
+
+    ops.push_back( microOp );
+
+    if( fused )
+        aaps++;
+    else
+        aps++;
+}
+
+/*
+ *  Maps the gates onto the reserved rows in creation order, which is a
+ *  topological order. A gate result stays only in the B-group rows when
+ *  the next gate is its single user; otherwise it is written to its result
+ *  row or to a scratch row that is reused once the value is dead.
+ */
+void PIMMicroprogram::Map( )
+{
+    ncounter_t nodeCount = nodes.size( );
+    std::vector<bool> reachable( nodeCount, false );
+    std::vector<ncounter_t> position( nodeCount, 0 );
+    std::vector<ncounter_t> lastUse( nodeCount, 0 );
+    std::vector<bool> laterUse( nodeCount, false );
+    std::vector<bool> positiveResult( nodeCount, false );
+    std::vector<ncounter_t> schedule;
+
+    for( ncounter_t k = 0; k < resultBits.size( ); k++ )
+    {
+        reachable[resultBits[k] >> 1] = true;
+
+        if( !(resultBits[k] & 1) )
+            positiveResult[resultBits[k] >> 1] = true;
+    }
+
+    for( ncounter_t node = nodeCount; node-- > 0; )
+    {
+        if( reachable[node] && nodes[node].kind == Node_Majority )
+        {
+            for( int i = 0; i < 3; i++ )
+                reachable[nodes[node].in[i] >> 1] = true;
+        }
+    }
+
+    for( ncounter_t node = 0; node < nodeCount; node++ )
+    {
+        if( reachable[node] && nodes[node].kind == Node_Majority )
+        {
+            position[node] = schedule.size( );
+            schedule.push_back( node );
+        }
+    }
+
+    for( ncounter_t pos = 0; pos < schedule.size( ); pos++ )
+    {
+        Node& node = nodes[schedule[pos]];
+
+        for( int i = 0; i < 3; i++ )
+        {
+            ncounter_t in = node.in[i] >> 1;
+
+            lastUse[in] = pos;
+
+            if( nodes[in].kind == Node_Majority
+                && ( position[in] + 1 != pos || (node.in[i] & 1) ) )
+            {
+                laterUse[in] = true;
+            }
+        }
+    }
+
+    homes.resize( nodeCount );
+    homed.assign( nodeCount, false );
+
+    for( ncounter_t node = 1; node < nodeCount; node++ )
+    {
+        if( nodes[node].kind == Node_Src1 || nodes[node].kind == Node_Src2 )
+        {
+            homes[node].operand = (nodes[node].kind == Node_Src1) ? PIMOperand_Src1
+                                                                  : PIMOperand_Src2;
+            homes[node].index = nodes[node].bit;
+            homed[node] = true;
+        }
+    }
+
+    for( int row = 0; row < ComputeRows; row++ )
+        holds[row] = noLiteral;
+
+    std::vector<ncounter_t> freeScratch;
+    std::vector<bool> scratch( nodeCount, false );
+
+    ncounter_t T0 = p->GetReservedRowBase( ReservedRow_BGroup );
+
+    for( ncounter_t pos = 0; pos < schedule.size( ); pos++ )
+    {
+        ncounter_t id = schedule[pos];
+        Node& node = nodes[id];
+        Literal result = id << 1;
+
+        /* Pick the triple-row address and operand order with fewest copies. */
+        static const ComputeRow forms[2][3] = {
+            { Row_T0, Row_T1, Row_T2 },     /* TRA T0:   T0, T1, T2 */
+            { Row_T1, Row_T2, Row_DCC0 }    /* TRA T0+1: T1, T2, DCC0 */
+        };
+        static const int orders[6][3] = {
+            { 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 }
+        };
+
+        ncounter_t bestCost = unreachableCost * 3 + 1;
+        int bestForm = 0, bestOrder = 0;
+
+        for( int form = 0; form < 2; form++ )
+        {
+            for( int order = 0; order < 6; order++ )
+            {
+                ncounter_t cost = 0;
+
+                for( int i = 0; i < 3; i++ )
+                    cost += LoadCost( node.in[orders[order][i]], forms[form][i] );
+
+                if( cost < bestCost )
+                {
+                    bestCost = cost;
+                    bestForm = form;
+                    bestOrder = order;
+                }
+            }
+        }
+
+        for( int i = 0; i < 3; i++ )
+            Load( node.in[orders[bestOrder][i]], forms[bestForm][i] );
+
+        for( int i = 0; i < 3; i++ )
+        {
+            ncounter_t in = node.in[i] >> 1;
+
+            if( scratch[in] && lastUse[in] == pos )
+            {
+                freeScratch.push_back( homes[in].index - T0 - 3 );
+                scratch[in] = false;
+            }
+        }
+
+        PIMRowRef tra;
+
+        tra.operand = PIMOperand_Reserved;
+        tra.index = T0 + bestForm;
+
+        majorities++;
+
+        /* Write the result to the first result row that takes it as is. */
+        if( positiveResult[id] || laterUse[id] )
+        {
+            homed[id] = true;
+
+            if( positiveResult[id] )
+            {
+                homes[id].operand = PIMOperand_Dst;
+                homes[id].index = std::find( resultBits.begin( ), resultBits.end( ), result )
+                                - resultBits.begin( );
+            }
+            else
+            {
+                homes[id].operand = PIMOperand_Reserved;
+
+                if( freeScratch.empty( ) )
+                {
+                    homes[id].index = T0 + 3 + scratchRows++;
+                }
+                else
+                {
+                    homes[id].index = T0 + 3 + freeScratch.back( );
+                    freeScratch.pop_back( );
+                }
+
+                scratch[id] = true;
+            }
+
+            Emit( true, TRA, tra, OA, homes[id] );
+        }
+        else if( reachable[id] && std::find( resultBits.begin( ), resultBits.end( ),
+                                             result ^ 1 ) != resultBits.end( ) )
+        {
+            /* Only complemented results: negate straight into DCC1. */
+            Emit( true, TRA, tra, OA, ComputeRowRef( Row_DCC1 ) );
+            holds[Row_DCC1] = result ^ 1;
+        }
+        else
+        {
+            Emit( false, TRA, tra, NOP, tra );
+        }
+
+        for( int i = 0; i < 3; i++ )
+            holds[forms[bestForm][i]] = result;
+
+        for( ncounter_t k = 0; k < resultBits.size( ); k++ )
+        {
+            if( (resultBits[k] >> 1) != id )
+                continue;
+
+            PIMRowRef target;
+
+            target.operand = PIMOperand_Dst;
+            target.index = k;
+
+            if( homes[id].operand == PIMOperand_Dst && homes[id].index == k && homed[id] )
+                continue;
+
+            if( holds[Row_DCC1] == resultBits[k] )
+                Emit( true, SRA, ComputeRowRef( Row_DCC1 ), OA, target );
+            else
+                WriteResult( resultBits[k], target );
+        }
+    }
+
+    /* Result bits that are constants or source bits. */
+    for( ncounter_t k = 0; k < resultBits.size( ); k++ )
+    {
+        if( nodes[resultBits[k] >> 1].kind == Node_Majority )
+            continue;
+
+        PIMRowRef target;
+
+        target.operand = PIMOperand_Dst;
+        target.index = k;
+
+        WriteResult( resultBits[k], target );
+    }
+}
+
+/*
+ *  Expected time and energy of one pass of the microprogram. An AAP takes
+ *  the activate-to-precharge time of its source activate (or of the
+ *  overlapped activate) plus tRP. Both come from the PIM cost table, the
+ *  same one SubArray charges its activates with.
+ */
+ncycle_t PIMMicroprogram::EstimateCycles( )
+{
+    PIMCostModel& costs = p->pimCosts;
+    ncycle_t cycles = 0;
+
+    for( ncounter_t i = 0; i < ops.size( ); i++ )
+    {
+        ncycle_t restore = costs.GetRestoreCycles( ops[i].activate );
+        ncycle_t prechargeDelay = costs.GetPrechargeDelay( ops[i].activate );
+
+        if( ops[i].fused )
+        {
+            restore = std::max( restore, p->tCMD + costs.GetActivateCycles( ops[i].overlapped ) );
+            prechargeDelay = std::max( prechargeDelay, 
+                                       costs.GetPrechargeDelay( ops[i].overlapped ) );
+        }
+
+        cycles += restore + p->tRP + prechargeDelay;
+    }
+
+    return cycles;
+}
+
+double PIMMicroprogram::EstimateEnergy( )
+{
+    double energy = 0.0;
+
+    for( ncounter_t i = 0; i < ops.size( ); i++ )
+    {
+        energy += p->pimCosts.GetEnergy( ops[i].activate );
+
+        if( ops[i].fused )
+            energy += p->pimCosts.GetEnergy( ops[i].overlapped );
+    }
+
+    if( p->EnergyModel == "current" )
+    {
+        double devices = (double)(p->BusWidth / p->DeviceWidth);
+
+        /* mA * cycles to nJ for every device of the rank. */
+        return energy * p->Voltage / (double)p->CLK * devices;
+    }
+
+    return energy;
+}
+
+void PIMMicroprogram::Evaluate( const std::vector<const uint64_t *>& src1,
+                                const std::vector<const uint64_t *>& src2,
+                                const std::vector<uint64_t *>& dst, ncounter_t words )
+{
+    std::vector<std::vector<uint64_t> > values( nodes.size( ) );
+    std::vector<const uint64_t *> rows( nodes.size( ), (const uint64_t *)NULL );
+    std::vector<uint64_t> inputs[3];
+
+    values[0].assign( words, 0 );
+    rows[0] = &values[0][0];
+
+    for( ncounter_t node = 1; node < nodes.size( ); node++ )
+    {
+        if( nodes[node].kind == Node_Src1 && nodes[node].bit < src1.size( ) )
+            rows[node] = src1[nodes[node].bit];
+        else if( nodes[node].kind == Node_Src2 && nodes[node].bit < src2.size( ) )
+            rows[node] = src2[nodes[node].bit];
+    }
+
+    for( int i = 0; i < 3; i++ )
+        inputs[i].resize( words );
+
+    for( ncounter_t node = 1; node < nodes.size( ); node++ )
+    {
+        if( nodes[node].kind != Node_Majority )
+            continue;
+
+        const uint64_t *in[3] = { NULL, NULL, NULL };
+
+        for( int i = 0; i < 3; i++ )
+        {
+            in[i] = rows[nodes[node].in[i] >> 1];
+
+            if( in[i] == NULL )
+                break;
+
+            if( nodes[node].in[i] & 1 )
+            {
+                RowStore::Not( &inputs[i][0], in[i], words );
+                in[i] = &inputs[i][0];
+            }
+        }
+
+        /* Gates of unused sources, such as src2 of POPCOUNT. */
+        if( in[0] == NULL || in[1] == NULL || in[2] == NULL )
+            continue;
+
+        values[node].resize( words );
+        RowStore::Majority( &values[node][0], in[0], in[1], in[2], words );
+        rows[node] = &values[node][0];
+    }
+
+    for( ncounter_t k = 0; k < resultBits.size( ) && k < dst.size( ); k++ )
+    {
+        const uint64_t *result = rows[resultBits[k] >> 1];
+
+        if( resultBits[k] & 1 )
+            RowStore::Not( dst[k], result, words );
+        else
+            RowStore::Copy( dst[k], result, words );
+    }
+}
@@ -0,0 +1,184 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+*
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+*
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* Author list:
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+
+#ifndef __NVMAIN_PIMMICROPROGRAM_H__
+#define __NVMAIN_PIMMICROPROGRAM_H__
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+#include "include/NVMTypes.h"
+#include "include/NVMainRequest.h"
+#include "src/Params.h"
+
+namespace NVM {
+
+/* Rows a microprogram operation refers to. */
+enum PIMRowOperand
+{
+    PIMOperand_Dst,             ///< Bit row of the result
+    PIMOperand_Src1,            ///< Bit row of the first source
+    PIMOperand_Src2,            ///< Bit row of the second source
+    PIMOperand_Reserved         ///< Reserved compute or scratch row
+};
+
+struct PIMRowRef
+{
+    PIMRowOperand operand;
+    ncounter_t index;           ///< Bit of the operand, or subarray row
+};
+
+/*
+ *  One step of a microprogram: a fused AAP (activate, overlapped activate,
+ *  precharge) or an AP (activate, precharge).
+ */
+struct PIMMicroOp
+{
+    bool fused;
+    OpType activate;
+    PIMRowRef source;
+    OpType overlapped;
+    PIMRowRef target;
+};
+
+/*
+ *  SIMDRAM-style arithmetic over bit-serial vertical operands. Bit i of
+ *  every element of an n-bit operand is stored in row i of the operand, so
+ *  one row operation processes a whole row of elements.
+ *
+ *  The operation is built as a majority-inverter graph (majority gates with
+ *  complemented inputs) and mapped onto the reserved rows of the subarray:
+ *  operands are copied into T0-T2 (or T1, T2 and DCC0, which provides one
+ *  complemented input) and resolved with a triple-row activate. Values that
+ *  are still in the B-group rows are not copied again, and intermediate
+ *  values that are used later are kept in scratch rows, which are the
+ *  B-group rows from T3 up.
+ *
+ *  ADD, SUB and MUL keep the low n bits of the result, LT gives one bit
+ *  (unsigned src1 < src2) and POPCOUNT counts the set bits of src1.
+ */
+class PIMMicroprogram
+{
+  public:
+    PIMMicroprogram( BulkBitwiseOp op, ncounter_t width, Params *p );
+    ~PIMMicroprogram( ) { }
+
+    static bool IsArithmetic( BulkBitwiseOp op ) { return op >= BBOP_ADD; }
+    static ncounter_t GetResultWidth( BulkBitwiseOp op, ncounter_t width );
+
+    BulkBitwiseOp GetOperation( ) { return op; }
+    ncounter_t GetSourceWidth( ) { return width; }
+    ncounter_t GetResultWidth( ) { return resultBits.size( ); }
+
+    const std::vector<PIMMicroOp>& GetOps( ) { return ops; }
+    ncounter_t GetAAPs( ) { return aaps; }
+    ncounter_t GetAPs( ) { return aps; }
+    ncounter_t GetMajorities( ) { return majorities; }
+    ncounter_t GetScratchRows( ) { return scratchRows; }
+
+    /* Reserved rows needed in each subarray. */
+    ncounter_t GetBGroupRows( );
+    ncounter_t GetDCCRows( ) { return 2; }
+    ncounter_t GetZeroRows( ) { return usesZero ? 1 : 0; }
+    ncounter_t GetOneRows( ) { return usesOne ? 1 : 0; }
+
+    /* Expected latency (cycles) and energy (nJ) of one row of elements. */
+    ncycle_t EstimateCycles( );
+    double EstimateEnergy( );
+
+    /* Evaluates the graph with the row kernels, for verification. */
+    void Evaluate( const std::vector<const uint64_t *>& src1,
+                   const std::vector<const uint64_t *>& src2,
+                   const std::vector<uint64_t *>& dst, ncounter_t words );
+
+  private:
+    /* A literal is a node index with the complement in the lowest bit. */
+    typedef ncounter_t Literal;
+
+    enum NodeKind { Node_Zero, Node_Src1, Node_Src2, Node_Majority };
+
+    struct Node
+    {
+        NodeKind kind;
+        ncounter_t bit;
+        Literal in[3];
+    };
+
+    BulkBitwiseOp op;
+    ncounter_t width;
+    Params *p;
+
+    std::vector<Node> nodes;
+    std::map<std::vector<Literal>, Literal> majorityNodes;
+    std::vector<Literal> resultBits;
+
+    std::vector<PIMMicroOp> ops;
+    ncounter_t aaps, aps, majorities, scratchRows;
+    bool usesZero, usesOne;
+
+    Literal Zero( ) { return 0; }
+    Literal One( ) { return 1; }
+    Literal Input( NodeKind kind, ncounter_t bit );
+    Literal Majority( Literal a, Literal b, Literal c );
+    Literal And( Literal a, Literal b ) { return Majority( a, b, Zero( ) ); }
+    Literal Sum( Literal a, Literal b, Literal c, Literal *carry );
+
+    void BuildAdd( bool subtract );
+    void BuildLessThan( );
+    void BuildMultiply( );
+    void BuildPopcount( );
+
+    /* Mapping onto the reserved rows. */
+    enum ComputeRow { Row_T0, Row_T1, Row_T2, Row_DCC0, Row_DCC1, ComputeRows };
+
+    Literal holds[ComputeRows];
+    std::vector<PIMRowRef> homes;
+    std::vector<bool> homed;
+
+    PIMRowRef ComputeRowRef( ComputeRow row );
+    PIMRowRef Home( Literal value );
+    bool HasHome( Literal value );
+    ncounter_t LoadCost( Literal value, ComputeRow row );
+    void Load( Literal value, ComputeRow row );
+    void Negate( Literal value );
+    void WriteResult( Literal value, PIMRowRef target );
+    void Emit( bool fused, OpType activate, PIMRowRef source,
+               OpType overlapped, PIMRowRef target );
+    void Map( );
+};
+
+};
+
+#endif
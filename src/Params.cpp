@@ -78,6 +78,7 @@ Params::Params( )
     Erd = 3.405401;
     Esh = 0.0195;
     Eopenrd = 1.081080;
+    Erbm = Erd / 2.0; // Estimated value, senses half the bitline load
     Ewr = 1.023750;
     Ewrpb = Ewr / 512.0; // Estimated value
     Eref = 38.558533;
@@ -151,6 +152,9 @@ Params::Params( )
     BANKS = 8;
     RAW = 4;
     MATHeight = ROWS;
+    MASA = false;
+    RowClone = false;
+    LocalWrite = false;
     RBSize = COLS;
 
     tAL = 0;
@@ -171,6 +175,8 @@ Params::Params( )
     tRP = 9;
     tRRDR = 5;
     tRRDW = 5;
+    tSAS = tRRDR;
+    tRBM = 4;
     tPPD = 0;
     tRTP = 5;
     tRTRS = 1;
@@ -219,6 +225,30 @@ Params::Params( )
     MaxCancellations = 4;
     pauseMode = PauseMode_Normal;
 
+    ReservedBGroupRows = 0;
+    ReservedDCCRows = 0;
+    ReservedZeroRows = 0;
+    ReservedOneRows = 0;
+    reservedRowPolicy = ReservedRowPolicy_Convert;
+
+    PIMActivationBudget = 0;
+    PIMBatching = false;
+    pimMode = PIMMode_Ambit;
+    PinatuboMaxRows = 128;
+    tPinatuboWL = 0;
+    tPinatuboSense = 0;
+    PinatuboRowScale = 0.22;
+    PIMFunctional = false;
+    PIMVerify = false;
+
+    TransposeBase = 0;
+    TransposeSize = 0;
+    TransposeWidth = 8;
+    TransposeBufferLines = 64;
+    TransposeLineCycles = 1;
+    TransposeLatency = 4;
+    TransposeLineEnergy = 0.0;
+
     DeadlockTimer = 10000000;
 
     debugOn = false;
@@ -293,6 +323,11 @@ void Params::SetParams( Config *c )
     c->GetEnergy( "EIDD6", EIDD6 );
     c->GetEnergy( "Eopenrd", Eopenrd );
     c->GetEnergy( "Erd", Erd );
+    /* Follows the configured Erd unless it is set itself. */
+    if( c->KeyExists( "Erbm" ) )
+        c->GetEnergy( "Erbm", Erbm );
+    else
+        Erbm = Erd / 2.0;
     c->GetEnergy( "Esh", Esh );
     c->GetEnergy( "Eref", Eref );
     c->GetEnergy( "Ewr", Ewr );
@@ -345,6 +380,12 @@ void Params::SetParams( Config *c )
     c->GetValueUL( "BANKS", BANKS );
     c->GetValueUL( "RAW", RAW );
     c->GetValueUL( "MATHeight", MATHeight );
+    if( c->KeyExists( "MASA" ) )
+        c->GetBool( "MASA", MASA );
+    if( c->KeyExists( "RowClone" ) )
+        c->GetBool( "RowClone", RowClone );
+    if( c->KeyExists( "LocalWrite" ) )
+        c->GetBool( "LocalWrite", LocalWrite );
     c->GetValueUL( "RBSize", RBSize );
     c->GetValueUL( "nPorts", nPorts );
 
@@ -366,6 +407,9 @@ void Params::SetParams( Config *c )
     ConvertTiming( c, "tRP", tRP );
     ConvertTiming( c, "tRRDR", tRRDR );
     ConvertTiming( c, "tRRDW", tRRDW );
+    tSAS = tRRDR;
+    ConvertTiming( c, "tSAS", tSAS );
+    ConvertTiming( c, "tRBM", tRBM );
     ConvertTiming( c, "tPPD", tPPD );
     ConvertTiming( c, "tRTP", tRTP );
     ConvertTiming( c, "tRTRS", tRTRS );
@@ -477,5 +521,148 @@ void Params::SetParams( Config *c )
             std::cout << "Unknown PauseMode: " << c->GetString( "PauseMode" )
                       << ". Defaulting to Normal" << std::endl;
     }
+
+    if( c->KeyExists( "ReservedBGroupRows" ) )
+        c->GetValueUL( "ReservedBGroupRows", ReservedBGroupRows );
+    if( c->KeyExists( "ReservedDCCRows" ) )
+        c->GetValueUL( "ReservedDCCRows", ReservedDCCRows );
+    if( c->KeyExists( "ReservedZeroRows" ) )
+        c->GetValueUL( "ReservedZeroRows", ReservedZeroRows );
+    if( c->KeyExists( "ReservedOneRows" ) )
+        c->GetValueUL( "ReservedOneRows", ReservedOneRows );
+    if( c->KeyExists( "ReservedRowPolicy" ) )
+    {
+        if( c->GetString( "ReservedRowPolicy" ) == "reject" )
+            reservedRowPolicy = ReservedRowPolicy_Reject;
+        else if( c->GetString( "ReservedRowPolicy" ) == "convert" )
+            reservedRowPolicy = ReservedRowPolicy_Convert;
+        else
+            std::cout << "Unknown ReservedRowPolicy: " << c->GetString( "ReservedRowPolicy" )
+                      << ". Defaulting to convert" << std::endl;
+    }
+
+    if( c->KeyExists( "PIMActivationBudget" ) )
+        c->GetValueUL( "PIMActivationBudget", PIMActivationBudget );
+    if( c->KeyExists( "PIMBatching" ) )
+        c->GetBool( "PIMBatching", PIMBatching );
+    if( c->KeyExists( "PIMMode" ) )
+    {
+        if( c->GetString( "PIMMode" ) == "Ambit" )
+            pimMode = PIMMode_Ambit;
+        else if( c->GetString( "PIMMode" ) == "Pinatubo" )
+            pimMode = PIMMode_Pinatubo;
+        else
+            std::cout << "Unknown PIMMode: " << c->GetString( "PIMMode" )
+                      << ". Defaulting to Ambit" << std::endl;
+    }
+
+    /* By default, every wordline and sensing step takes a full tRCD. */
+    tPinatuboWL = tRCD;
+    tPinatuboSense = tRCD;
+
+    if( c->KeyExists( "PinatuboMaxRows" ) )
+        c->GetValueUL( "PinatuboMaxRows", PinatuboMaxRows );
+    ConvertTiming( c, "tPinatuboWL", tPinatuboWL );
+    ConvertTiming( c, "tPinatuboSense", tPinatuboSense );
+    if( c->KeyExists( "PinatuboRowScale" ) )
+        c->GetEnergy( "PinatuboRowScale", PinatuboRowScale );
+
+    pimCosts.SetParams( c, this );
+
+    if( c->KeyExists( "PIMFunctional" ) )
+        c->GetBool( "PIMFunctional", PIMFunctional );
+    if( c->KeyExists( "PIMVerify" ) )
+        c->GetBool( "PIMVerify", PIMVerify );
+
+    if( c->KeyExists( "TransposeBase" ) )
+        TransposeBase = strtoull( c->GetString( "TransposeBase" ).c_str( ), NULL, 0 );
+    if( c->KeyExists( "TransposeSize" ) )
+        TransposeSize = strtoull( c->GetString( "TransposeSize" ).c_str( ), NULL, 0 );
+    if( c->KeyExists( "TransposeWidth" ) )
+        c->GetValueUL( "TransposeWidth", TransposeWidth );
+    if( c->KeyExists( "TransposeBufferLines" ) )
+        c->GetValueUL( "TransposeBufferLines", TransposeBufferLines );
+    if( c->KeyExists( "TransposeLineCycles" ) )
+        c->GetValueUL( "TransposeLineCycles", TransposeLineCycles );
+    if( c->KeyExists( "TransposeLatency" ) )
+        c->GetValueUL( "TransposeLatency", TransposeLatency );
+    if( c->KeyExists( "TransposeLineEnergy" ) )
+        c->GetEnergy( "TransposeLineEnergy", TransposeLineEnergy );
+
+    /* Verification needs the row contents. */
+    if( PIMVerify )
+        PIMFunctional = true;
+
+    /* 
+     *  A triple-row activate has to fit in the window. Wider activates are
+     *  checked against the budget when they are scheduled.
+     */
+    if( PIMActivationBudget != 0 && PIMActivationBudget < 3 )
+    {
+        std::cerr << "NVMain Error: PIMActivationBudget " << PIMActivationBudget 
+                  << " is too small for a triple-row activate." << std::endl;
+        exit(1);
+    }
+
+    if( ReservedRows( ) >= SubArrayRows( ) )
+    {
+        std::cerr << "NVMain Error: " << ReservedRows( ) << " reserved rows do not "
+                  << "fit in a subarray of " << SubArrayRows( ) << " rows." << std::endl;
+        exit(1);
+    }
+}
+
+/*
+ *  Rows in one subarray. MATHeight is only meaningful if it was configured
+ *  no larger than ROWS.
+ */
+ncounter_t Params::SubArrayRows( )
+{
+    return (MATHeight < ROWS) ? MATHeight : ROWS;
+}
+
+ncounter_t Params::ReservedRows( )
+{
+    return ReservedBGroupRows + ReservedDCCRows + ReservedZeroRows + ReservedOneRows;
+}
+
+ncounter_t Params::GetReservedRowBase( ReservedRowGroup group )
+{
+    ncounter_t base = SubArrayRows( ) - ReservedRows( );
+
+    switch( group )
+    {
+        case ReservedRow_One:
+            base += ReservedZeroRows;
+            /* fall through */
+        case ReservedRow_Zero:
+            base += ReservedDCCRows;
+            /* fall through */
+        case ReservedRow_DCC:
+            base += ReservedBGroupRows;
+            /* fall through */
+        case ReservedRow_BGroup:
+        case ReservedRow_None:
+        default:
+            break;
+    }
+
+    return base;
+}
+
+ReservedRowGroup Params::GetReservedRowGroup( ncounter_t row )
+{
+    ReservedRowGroup group = ReservedRow_None;
+
+    if( row >= GetReservedRowBase( ReservedRow_One ) )
+        group = ReservedRow_One;
+    else if( row >= GetReservedRowBase( ReservedRow_Zero ) )
+        group = ReservedRow_Zero;
+    else if( row >= GetReservedRowBase( ReservedRow_DCC ) )
+        group = ReservedRow_DCC;
+    else if( row >= GetReservedRowBase( ReservedRow_BGroup ) )
+        group = ReservedRow_BGroup;
+
+    return group;
 }
 
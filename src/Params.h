@@ -45,6 +45,7 @@
 
 #include "src/Config.h"
 #include "src/Debug.h"
+#include "src/PIMCostModel.h"
 #include "include/NVMTypes.h"
 
 #include <set>
@@ -63,6 +64,24 @@ enum PauseMode {
     PauseMode_Optimal   ///< Optimal: Same as IIWC, but consider iteration complete
 };
 
+enum ReservedRowPolicy {
+    ReservedRowPolicy_Reject,   ///< Exit if a multi-row activate targets unwired rows
+    ReservedRowPolicy_Convert   ///< Retarget the activate to the first wired row
+};
+
+enum PIMMode {
+    PIMMode_Ambit,              ///< DRAM charge sharing, TRA senses the majority
+    PIMMode_Pinatubo            ///< NVM multi-row sensing with switched references
+};
+
+enum ReservedRowGroup {
+    ReservedRow_None,           ///< Regular data row
+    ReservedRow_BGroup,         ///< TRA-capable rows
+    ReservedRow_DCC,            ///< Dual-contact cell rows
+    ReservedRow_Zero,           ///< Constant zero row(s)
+    ReservedRow_One             ///< Constant one row(s)
+};
+
 class Params
 {
   public:
@@ -89,6 +108,7 @@ class Params
     double EIDD5B;
     double EIDD6;
     double Eopenrd;
+    double Erbm; // LISA row buffer movement, per hop
     double Erd;
     double Esh;
     double Eref;
@@ -145,6 +165,9 @@ class Params
     ncounter_t BANKS;
     ncounter_t RAW;
     ncounter_t MATHeight;
+    bool MASA; // multiple activated subarrays per bank
+    bool RowClone; // RowClone PSM and LISA row copies
+    bool LocalWrite; // LW commands write results into the open row
     ncounter_t RBSize;
 
     ncycle_t tAL;
@@ -165,6 +188,8 @@ class Params
     ncycle_t tRP;
     ncycle_t tRRDR;
     ncycle_t tRRDW;
+    ncycle_t tSAS; // activate to activate in different subarrays of a bank
+    ncycle_t tRBM; // LISA row buffer movement, per hop
     ncycle_t tPPD;
     ncycle_t tRTP;
     ncycle_t tRTRS;
@@ -223,7 +248,63 @@ class Params
     ncounter_t MaxCancellations;
     PauseMode pauseMode;
 
-  private:
+    /* 
+     *  Ambit-style compute rows reserved at the top of every subarray, in
+     *  the order B-group, DCC, zero, one. They are not part of the normal
+     *  address space.
+     */
+    ncounter_t ReservedBGroupRows;
+    ncounter_t ReservedDCCRows;
+    ncounter_t ReservedZeroRows;
+    ncounter_t ReservedOneRows;
+    ReservedRowPolicy reservedRowPolicy;
+
+    /* 
+     *  Rows that may be activated per rank within any tRAW window, with
+     *  multi-row activates weighted by the rows they open (0 = no limit).
+     */
+    ncounter_t PIMActivationBudget;
+    bool PIMBatching;
+
+    /*
+     *  With PIMMode Pinatubo, multi-row activates raise their wordlines one
+     *  after another (tPinatuboWL each) and sense the OR, AND or XOR of up to
+     *  PinatuboMaxRows rows. XOR takes a second sensing step (tPinatuboSense).
+     *  Each extra row adds PinatuboRowScale activates of energy.
+     */
+    PIMMode pimMode;
+    ncounter_t PinatuboMaxRows;
+    ncycle_t tPinatuboWL;
+    ncycle_t tPinatuboSense;
+    double PinatuboRowScale;
+
+    /* Timing and energy of the PIM activate primitives. */
+    PIMCostModel pimCosts;
+
+    /* Track row contents so PIM commands compute their results. */
+    bool PIMFunctional;
+    /* Check bulk operation results and read data against the row contents. */
+    bool PIMVerify;
+
+    /* 
+     *  Writes to the TransposeSize bytes from TransposeBase hold packed
+     *  elements of TransposeWidth bits and are stored bit-serially by the
+     *  transposition unit (TransposeSize 0 = no unit).
+     */
+    uint64_t TransposeBase;
+    uint64_t TransposeSize;
+    ncounter_t TransposeWidth;
+    ncounter_t TransposeBufferLines;
+    ncycle_t TransposeLineCycles;
+    ncycle_t TransposeLatency;
+    double TransposeLineEnergy;
+
+    ncounter_t SubArrayRows( );
+    ncounter_t ReservedRows( );
+    ReservedRowGroup GetReservedRowGroup( ncounter_t row );
+    ncounter_t GetReservedRowBase( ReservedRowGroup group );
+
+    /* Timings are given in cycles, or in ns, us or ms of the memory clock. */
     void ConvertTiming( Config *conf, std::string param, ncycle_t& value );
     ncycle_t ConvertTiming( Config *conf, std::string param );
 };
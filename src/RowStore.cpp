@@ -0,0 +1,327 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+
+#include "src/RowStore.h"
+
+#include <cstring>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+using namespace NVM;
+
+std::vector<uint64_t> RowStore::zeroRow;
+
+RowStore::RowStore( ncounter_t rowBytes )
+{
+    this->rowBytes = rowBytes;
+    rowWords = (rowBytes + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    if( zeroRow.size( ) < rowWords )
+        zeroRow.resize( rowWords, 0 );
+}
+
+RowStore::~RowStore( )
+{
+    std::map<ncounter_t, uint64_t *>::iterator it;
+
+    for( it = rows.begin( ); it != rows.end( ); it++ )
+        delete [] it->second;
+}
+
+/* Returns the row contents, which must not be modified. */
+const uint64_t *RowStore::GetRow( ncounter_t row )
+{
+    std::map<ncounter_t, uint64_t *>::iterator it = rows.find( row );
+
+    if( it == rows.end( ) )
+        return &zeroRow[0];
+
+    return it->second;
+}
+
+/* Returns the row contents for writing, allocating the row if needed. */
+uint64_t *RowStore::GetWritableRow( ncounter_t row )
+{
+    std::map<ncounter_t, uint64_t *>::iterator it = rows.find( row );
+
+    if( it != rows.end( ) )
+        return it->second;
+
+    uint64_t *data = new uint64_t[rowWords];
+
+    Copy( data, &zeroRow[0], rowWords );
+    rows.insert( std::pair<ncounter_t, uint64_t *>( row, data ) );
+
+    return data;
+}
+
+void RowStore::SetRow( ncounter_t row, const uint64_t *data )
+{
+    Copy( GetWritableRow( row ), data, rowWords );
+}
+
+void RowStore::FillRow( ncounter_t row, uint64_t value )
+{
+    uint64_t *data = GetWritableRow( row );
+
+    for( ncounter_t i = 0; i < rowWords; i++ )
+        data[i] = value;
+}
+
+/* Byte accesses past the end of the row are dropped. */
+void RowStore::ReadBytes( const uint64_t *row, ncounter_t offset, uint8_t *data, ncounter_t size )
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>( row );
+
+    if( offset >= rowBytes )
+        return;
+
+    if( offset + size > rowBytes )
+        size = rowBytes - offset;
+
+    memcpy( data, bytes + offset, size );
+}
+
+void RowStore::WriteBytes( uint64_t *row, ncounter_t offset, const uint8_t *data, ncounter_t size )
+{
+    uint8_t *bytes = reinterpret_cast<uint8_t *>( row );
+
+    if( offset >= rowBytes )
+        return;
+
+    if( offset + size > rowBytes )
+        size = rowBytes - offset;
+
+    memcpy( bytes + offset, data, size );
+}
+
+void RowStore::Copy( uint64_t *dst, const uint64_t *src, ncounter_t words )
+{
+    if( dst != src )
+        memmove( dst, src, words * sizeof(uint64_t) );
+}
+
+/*
+ *  The kernels below work on whole rows (8 KB for a DDR3 x8 page). They use
+ *  AVX-512 or AVX2 when the compiler targets it and fall back to 64-bit
+ *  words for the remainder or on other hosts.
+ */
+void RowStore::Not( uint64_t *dst, const uint64_t *src, ncounter_t words )
+{
+    ncounter_t i = 0;
+
+#if defined(__AVX512F__)
+    __m512i ones = _mm512_set1_epi64( -1 );
+
+    for( ; i + 8 <= words; i += 8 )
+    {
+        __m512i vs = _mm512_loadu_si512( src + i );
+
+        _mm512_storeu_si512( dst + i, _mm512_xor_si512( vs, ones ) );
+    }
+#elif defined(__AVX2__)
+    __m256i ones = _mm256_set1_epi64x( -1 );
+
+    for( ; i + 4 <= words; i += 4 )
+    {
+        __m256i vs = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( src + i ) );
+
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( dst + i ), 
+                             _mm256_xor_si256( vs, ones ) );
+    }
+#endif
+
+    for( ; i < words; i++ )
+        dst[i] = ~src[i];
+}
+
+void RowStore::Or( uint64_t *dst, const uint64_t *a, const uint64_t *b, ncounter_t words )
+{
+    ncounter_t i = 0;
+
+#if defined(__AVX512F__)
+    for( ; i + 8 <= words; i += 8 )
+    {
+        __m512i va = _mm512_loadu_si512( a + i );
+        __m512i vb = _mm512_loadu_si512( b + i );
+
+        _mm512_storeu_si512( dst + i, _mm512_or_si512( va, vb ) );
+    }
+#elif defined(__AVX2__)
+    for( ; i + 4 <= words; i += 4 )
+    {
+        __m256i va = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( a + i ) );
+        __m256i vb = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( b + i ) );
+
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( dst + i ), 
+                             _mm256_or_si256( va, vb ) );
+    }
+#endif
+
+    for( ; i < words; i++ )
+        dst[i] = a[i] | b[i];
+}
+
+void RowStore::And( uint64_t *dst, const uint64_t *a, const uint64_t *b, ncounter_t words )
+{
+    ncounter_t i = 0;
+
+#if defined(__AVX512F__)
+    for( ; i + 8 <= words; i += 8 )
+    {
+        __m512i va = _mm512_loadu_si512( a + i );
+        __m512i vb = _mm512_loadu_si512( b + i );
+
+        _mm512_storeu_si512( dst + i, _mm512_and_si512( va, vb ) );
+    }
+#elif defined(__AVX2__)
+    for( ; i + 4 <= words; i += 4 )
+    {
+        __m256i va = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( a + i ) );
+        __m256i vb = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( b + i ) );
+
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( dst + i ), 
+                             _mm256_and_si256( va, vb ) );
+    }
+#endif
+
+    for( ; i < words; i++ )
+        dst[i] = a[i] & b[i];
+}
+
+void RowStore::Xor( uint64_t *dst, const uint64_t *a, const uint64_t *b, ncounter_t words )
+{
+    ncounter_t i = 0;
+
+#if defined(__AVX512F__)
+    for( ; i + 8 <= words; i += 8 )
+    {
+        __m512i va = _mm512_loadu_si512( a + i );
+        __m512i vb = _mm512_loadu_si512( b + i );
+
+        _mm512_storeu_si512( dst + i, _mm512_xor_si512( va, vb ) );
+    }
+#elif defined(__AVX2__)
+    for( ; i + 4 <= words; i += 4 )
+    {
+        __m256i va = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( a + i ) );
+        __m256i vb = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( b + i ) );
+
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( dst + i ), 
+                             _mm256_xor_si256( va, vb ) );
+    }
+#endif
+
+    for( ; i < words; i++ )
+        dst[i] = a[i] ^ b[i];
+}
+
+/* Bitwise majority, the value a triple-row activate senses. */
+void RowStore::Majority( uint64_t *dst, const uint64_t *a, const uint64_t *b, 
+                         const uint64_t *c, ncounter_t words )
+{
+    ncounter_t i = 0;
+
+#if defined(__AVX512F__)
+    for( ; i + 8 <= words; i += 8 )
+    {
+        __m512i va = _mm512_loadu_si512( a + i );
+        __m512i vb = _mm512_loadu_si512( b + i );
+        __m512i vc = _mm512_loadu_si512( c + i );
+
+        /* 0xE8 is the truth table of MAJ(a, b, c). */
+        _mm512_storeu_si512( dst + i, _mm512_ternarylogic_epi64( va, vb, vc, 0xE8 ) );
+    }
+#elif defined(__AVX2__)
+    for( ; i + 4 <= words; i += 4 )
+    {
+        __m256i va = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( a + i ) );
+        __m256i vb = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( b + i ) );
+        __m256i vc = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( c + i ) );
+        __m256i vm = _mm256_or_si256( _mm256_and_si256( va, vb ), 
+                                      _mm256_and_si256( vc, _mm256_or_si256( va, vb ) ) );
+
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( dst + i ), vm );
+    }
+#endif
+
+    for( ; i < words; i++ )
+        dst[i] = (a[i] & b[i]) | (c[i] & (a[i] | b[i]));
+}
+
+/*
+ *  Counts the set inputs of every bit position in three bit-sliced counters
+ *  and compares the count against half of the inputs.
+ */
+void RowStore::Majority( uint64_t *dst, const uint64_t *const *srcs, 
+                         ncounter_t count, ncounter_t words )
+{
+    ncounter_t half = count / 2;
+
+    for( ncounter_t i = 0; i < words; i++ )
+    {
+        uint64_t sum[3] = { 0, 0, 0 };
+
+        for( ncounter_t j = 0; j < count; j++ )
+        {
+            uint64_t carry = srcs[j][i];
+
+            for( int b = 0; b < 3; b++ )
+            {
+                uint64_t next = sum[b] & carry;
+
+                sum[b] ^= carry;
+                carry = next;
+            }
+        }
+
+        uint64_t greater = 0;
+        uint64_t equal = ~0ULL;
+
+        for( int b = 2; b >= 0; b-- )
+        {
+            uint64_t halfBit = ((half >> b) & 1) ? ~0ULL : 0;
+
+            greater |= equal & sum[b] & ~halfBit;
+            equal &= ~(sum[b] ^ halfBit);
+        }
+
+        if( count % 2 == 0 )
+            greater |= equal & srcs[0][i];
+
+        dst[i] = greater;
+    }
+}
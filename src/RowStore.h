@@ -0,0 +1,92 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+
+#ifndef __NVMAIN_ROWSTORE_H__
+#define __NVMAIN_ROWSTORE_H__
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+#include "include/NVMTypes.h"
+#include "include/NVMDataBlock.h"
+
+namespace NVM {
+
+/*
+ *  Functional contents of the rows of one subarray. The store is sparse:
+ *  rows that were never written read as a zero row shared by all stores,
+ *  and a row is allocated from it on its first write (copy-on-write).
+ */
+class RowStore
+{
+  public:
+    RowStore( ncounter_t rowBytes );
+    ~RowStore( );
+
+    ncounter_t GetRowBytes( ) { return rowBytes; }
+    ncounter_t GetRowWords( ) { return rowWords; }
+    ncounter_t GetAllocatedRows( ) { return rows.size( ); }
+
+    const uint64_t *GetRow( ncounter_t row );
+    uint64_t *GetWritableRow( ncounter_t row );
+    void SetRow( ncounter_t row, const uint64_t *data );
+    void FillRow( ncounter_t row, uint64_t value );
+
+    void ReadBytes( const uint64_t *row, ncounter_t offset, uint8_t *data, ncounter_t size );
+    void WriteBytes( uint64_t *row, ncounter_t offset, const uint8_t *data, ncounter_t size );
+
+    /* Row kernels. The destination may alias any of the sources. */
+    static void Copy( uint64_t *dst, const uint64_t *src, ncounter_t words );
+    static void Not( uint64_t *dst, const uint64_t *src, ncounter_t words );
+    static void Or( uint64_t *dst, const uint64_t *a, const uint64_t *b, ncounter_t words );
+    static void And( uint64_t *dst, const uint64_t *a, const uint64_t *b, ncounter_t words );
+    static void Xor( uint64_t *dst, const uint64_t *a, const uint64_t *b, ncounter_t words );
+    static void Majority( uint64_t *dst, const uint64_t *a, const uint64_t *b, 
+                          const uint64_t *c, ncounter_t words );
+    /* Majority of up to seven rows; ties resolve to the first row. */
+    static void Majority( uint64_t *dst, const uint64_t *const *srcs, 
+                          ncounter_t count, ncounter_t words );
+
+  private:
+    ncounter_t rowBytes;
+    ncounter_t rowWords;
+    std::map<ncounter_t, uint64_t *> rows;
+
+    static std::vector<uint64_t> zeroRow;
+};
+
+};
+
+#endif
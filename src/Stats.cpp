@@ -34,6 +34,10 @@
 
 #include "src/Stats.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
 
 using namespace NVM;
 
@@ -127,6 +131,67 @@ void Stats::ResetAll( )
 }
 
 
+/* Takes the value of each stat. Non-numeric stats are recorded as zero. */
+void Stats::Snapshot( std::vector<double>& values )
+{
+    values.resize( statList.size( ) );
+
+    for( size_t i = 0; i < statList.size( ); i++ )
+    {
+        values[i] = statList[i]->GetNumericValue( );
+    }
+}
+
+/*
+ *  Checks that every stat changed the same way over two consecutive
+ *  intervals given by three snapshots. Integral stats must match exactly,
+ *  the largest relative difference of the others is returned in error.
+ */
+bool Stats::CompareIntervals( std::vector<double>& start, std::vector<double>& middle,
+                              std::vector<double>& end, double& error )
+{
+    error = 0.0;
+
+    if( start.size( ) != statList.size( ) || middle.size( ) != statList.size( )
+        || end.size( ) != statList.size( ) )
+    {
+        return false;
+    }
+
+    for( size_t i = 0; i < statList.size( ); i++ )
+    {
+        double first = middle[i] - start[i];
+        double second = end[i] - middle[i];
+
+        if( statList[i]->IsIntegral( ) )
+        {
+            if( first != second )
+                return false;
+        }
+        else if( first != second )
+        {
+            double scale = std::max( std::fabs( first ), std::fabs( second ) );
+
+            error = std::max( error, std::fabs( first - second ) / scale );
+        }
+    }
+
+    return true;
+}
+
+/* Adds the change between two snapshots to each stat intervals times. */
+void Stats::Extrapolate( std::vector<double>& start, std::vector<double>& end,
+                         ncounter_t intervals )
+{
+    assert( start.size( ) == statList.size( ) && end.size( ) == statList.size( ) );
+
+    for( size_t i = 0; i < statList.size( ); i++ )
+    {
+        if( end[i] != start[i] )
+            statList[i]->AddNumericValue( (end[i] - start[i]) * static_cast<double>(intervals) );
+    }
+}
+
 void StatBase::Reset( )
 {
     std::memcpy( value, resetValue, typeSize );
@@ -149,4 +214,35 @@ void StatBase::Print( std::ostream& stream, ncounter_t psInterval )
     stream << units << std::endl;
 }
 
+bool StatBase::IsIntegral( )
+{
+    return ( statType == typeid(int).name() || statType == typeid(ncounter_t).name()
+             || statType == typeid(ncounters_t).name() || statType == typeid(ncycle_t).name()
+             || statType == typeid(ncycles_t).name() );
+}
+
+double StatBase::GetNumericValue( )
+{
+    double rv = 0.0;
 
+    if( statType == typeid(int).name() ) rv = *(static_cast<int *>(value));
+    else if( statType == typeid(float).name() ) rv = *(static_cast<float *>(value));
+    else if( statType == typeid(double).name() ) rv = *(static_cast<double *>(value));
+    else if( statType == typeid(ncounter_t).name() ) rv = static_cast<double>(*(static_cast<ncounter_t *>(value)));
+    else if( statType == typeid(ncounters_t).name() ) rv = static_cast<double>(*(static_cast<ncounters_t *>(value)));
+    else if( statType == typeid(ncycle_t).name() ) rv = static_cast<double>(*(static_cast<ncycle_t *>(value)));
+    else if( statType == typeid(ncycles_t).name() ) rv = static_cast<double>(*(static_cast<ncycles_t *>(value)));
+
+    return rv;
+}
+
+void StatBase::AddNumericValue( double delta )
+{
+    if( statType == typeid(int).name() ) *(static_cast<int *>(value)) += static_cast<int>(delta);
+    else if( statType == typeid(float).name() ) *(static_cast<float *>(value)) += static_cast<float>(delta);
+    else if( statType == typeid(double).name() ) *(static_cast<double *>(value)) += delta;
+    else if( statType == typeid(ncounter_t).name() ) *(static_cast<ncounter_t *>(value)) += static_cast<ncounters_t>(delta);
+    else if( statType == typeid(ncounters_t).name() ) *(static_cast<ncounters_t *>(value)) += static_cast<ncounters_t>(delta);
+    else if( statType == typeid(ncycle_t).name() ) *(static_cast<ncycle_t *>(value)) += static_cast<ncycles_t>(delta);
+    else if( statType == typeid(ncycles_t).name() ) *(static_cast<ncycles_t *>(value)) += static_cast<ncycles_t>(delta);
+}
@@ -37,13 +37,18 @@
 
 #define AddStat(STAT)                       \
         {                                   \
-            _AddStat(STAT, "")              \
+            _AddStat(STAT, #STAT, "")       \
         }
 #define AddUnitStat(STAT, UNITS)            \
         {                                   \
-            _AddStat(STAT, UNITS)           \
+            _AddStat(STAT, #STAT, UNITS)    \
         }
-#define _AddStat(STAT, UNITS)                                                 \
+/* Registers STAT under NAME, e.g., for the entries of a counter array. */
+#define AddNamedStat(STAT, NAME)            \
+        {                                   \
+            _AddStat(STAT, NAME, "")        \
+        }
+#define _AddStat(STAT, NAME, UNITS)                                           \
         {                                                                     \
             uint8_t *__resetValue = new uint8_t [sizeof(STAT)];               \
             memcpy(__resetValue, static_cast<StatType>(&STAT), sizeof(STAT)); \
@@ -51,7 +56,7 @@
                                       static_cast<StatType>(__resetValue),    \
                                       typeid(STAT).name(),                    \
                                       sizeof(STAT),                           \
-                                      StatName() + "." + #STAT,               \
+                                      StatName() + "." + NAME,                \
                                       UNITS);                                 \
         }
 #define RemoveStat(STAT) (this->GetStats()->removeStat(static_cast<StatType>(&STAT)))
@@ -102,6 +107,10 @@ class StatBase
     size_t GetTypeSize( ) { return typeSize; }
     std::string GetTypeName() { return statType; }
 
+    bool IsIntegral( );
+    double GetNumericValue( );
+    void AddNumericValue( double delta );
+
   private:
     std::string name, statType, units;
     size_t typeSize;
@@ -122,6 +131,12 @@ class Stats
     void PrintAll( std::ostream& );
     void ResetAll( );
 
+    void Snapshot( std::vector<double>& values );
+    bool CompareIntervals( std::vector<double>& start, std::vector<double>& middle,
+                           std::vector<double>& end, double& error );
+    void Extrapolate( std::vector<double>& start, std::vector<double>& end,
+                      ncounter_t intervals );
+
   private: 
     std::vector<StatBase *> statList;
     ncounter_t psInterval;
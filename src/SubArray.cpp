@@ -56,6 +56,7 @@
 
 #include <signal.h>
 #include <cassert>
+#include <cstring>
 #include <iostream>
 #include <limits>
 
@@ -80,6 +81,8 @@ SubArray::SubArray( )
     nextRead = 0;
     nextWrite = 0;
     nextPowerDown = 0;
+    nextOverlappedActivate = 0;
+    prechargeDelay = 0;
     nextCommand = CMD_NOP;
 
     state = SUBARRAY_CLOSED;
@@ -132,13 +135,16 @@ SubArray::SubArray( )
     activates = 0;
     precharges = 0;
     refreshes = 0;
-    overlapped_activates = 0;
-    overlapped_double_row_activates = 0;
-    overlapped_triple_row_activates = 0;
-    single_row_activates = 0;
-    double_row_activates = 0;
-    triple_row_activates = 0;
+    for( ncounter_t i = 0; i < PIMPrimitives; i++ )
+        pimActivates[i] = 0;
     local_writes = 0;
+    bgroup_activates = 0;
+    dcc_activates = 0;
+    constant_row_activates = 0;
+    pinatubo_or_senses = 0;
+    pinatubo_and_senses = 0;
+    pinatubo_xor_senses = 0;
+    pinatubo_rows = 0;
 
     actWaits = 0;
     actWaitTotal = 0;
@@ -165,10 +171,15 @@ SubArray::SubArray( )
     subArrayId = -1;
 
     psInterval = 0;
+
+    rowStore = NULL;
+    functional_rows = 0;
+    read_verify_mismatches = 0;
 }
 
 SubArray::~SubArray( )
 {
+    delete rowStore;
 }
 
 void SubArray::SetConfig( Config *c, bool createChildren )
@@ -248,6 +259,20 @@ void SubArray::SetConfig( Config *c, bool createChildren )
         }
     }
 
+    if( p->PIMFunctional )
+    {
+        ncounter_t rowBytes = p->COLS * p->tBURST * p->RATE * p->BusWidth / 8;
+
+        rowStore = new RowStore( rowBytes );
+        rowBuffer.resize( rowStore->GetRowWords( ), 0 );
+
+        /* Constant one rows read as all ones, the rest as zeros. */
+        ncounter_t oneRow = p->GetReservedRowBase( ReservedRow_One );
+
+        for( ncounter_t i = 0; i < p->ReservedOneRows; i++ )
+            rowStore->FillRow( oneRow + i, ~static_cast<uint64_t>(0) );
+    }
+
     ncounter_t totalWritePulses = p->nWP00 + p->nWP01 + p->nWP10 + p->nWP11;
     averageWriteIterations = static_cast<ncounter_t>( (totalWritePulses+2)/4 );
 
@@ -296,14 +321,36 @@ void SubArray::RegisterStats( )
     AddStat(measuredProgresses);
     AddStat(reads);
     AddStat(writes);
-    AddStat(overlapped_activates);
-    AddStat(overlapped_double_row_activates);
-    AddStat(overlapped_triple_row_activates);
-    AddStat(single_row_activates);
-    AddStat(double_row_activates);
-    AddStat(triple_row_activates);
+    for( ncounter_t i = 0; i < PIMPrimitives; i++ )
+    {
+        PIMPrimitive primitive = static_cast<PIMPrimitive>(i);
+
+        if( p->pimCosts.IsEnabled( primitive ) )
+            AddNamedStat(pimActivates[i], PIMCostModel::GetInfo( primitive ).statName);
+    }
     AddStat(local_writes);
 
+    if( p->PIMFunctional )
+        AddStat(functional_rows);
+
+    if( p->PIMVerify )
+        AddStat(read_verify_mismatches);
+
+    if( p->ReservedRows( ) > 0 )
+    {
+        AddStat(bgroup_activates);
+        AddStat(dcc_activates);
+        AddStat(constant_row_activates);
+    }
+
+    if( p->pimMode == PIMMode_Pinatubo )
+    {
+        AddStat(pinatubo_or_senses);
+        AddStat(pinatubo_and_senses);
+        AddStat(pinatubo_xor_senses);
+        AddStat(pinatubo_rows);
+    }
+
     /* Register these stats only for RaceTrack Memory */
     if( p->MemIsRTM )
     {
@@ -374,15 +421,18 @@ bool SubArray::OverlappedActivate( NVMainRequest *request ){
     /* Update timing constraints */
     nextPrecharge = MAX( nextPrecharge, 
                          GetEventQueue()->GetCurrentCycle() 
-                             + MAX( p->tRCD, 0 ) );
+                             + p->pimCosts.GetRestoreCycles( request->type ) );
 
     nextPowerDown = MAX( nextPowerDown, 
                          GetEventQueue()->GetCurrentCycle() 
-                             + MAX( p->tRCD, 0 ) );
+                             + p->pimCosts.GetRestoreCycles( request->type ) );
+
+    prechargeDelay = MAX( prechargeDelay, p->pimCosts.GetPrechargeDelay( request->type ) );
 
     /* send event response back up*/
     GetEventQueue( )->InsertEvent( EventResponse, this, request, 
-                    GetEventQueue()->GetCurrentCycle() + p->tRCD + p->tSH * (numShifts / wordSize) );
+                    GetEventQueue()->GetCurrentCycle() + p->pimCosts.GetActivateCycles( request->type )
+                        + p->tSH * (numShifts / wordSize) );
 
     /* 
      * The relative row number is record rather than the absolute row number 
@@ -390,51 +440,23 @@ bool SubArray::OverlappedActivate( NVMainRequest *request ){
      */
     openRow = activateRow;
 
+    CountReservedRowActivate( activateRow );
+
     state = SUBARRAY_OPEN;
     writeCycle = false;
 
     lastActivate = GetEventQueue()->GetCurrentCycle();
 
-    double scale;
+    if( rowStore )
+        RestoreRows( request );
 
-    switch(request->type)
-    {
-        case OA:
-            scale = 1.0;
-            overlapped_activates++;
-            break;
-        case ODRA:
-            scale = 1.22;
-            overlapped_double_row_activates++;
-            break;
-        case OTRA:
-            scale = 1.44;
-            overlapped_triple_row_activates++;
-            break;
-        default:
-            scale = 1.0;
-            std::cerr << "NVMain Error : MultiRowActivate unknown operation type "
-                        <<  request->type << std::endl;
-            break;
-    }
+    pimActivates[PIMCostModel::GetPrimitive( request->type )]++;
 
     /* Add to bank's total energy. */
-    if( p->EnergyModel == "current" )
-    {
-        /* DRAM Model */
-        double tRC = (double) p->tRCD;
-
-        subArrayEnergy += scale * ( (p->EIDD0 * tRC) - (p->EIDD3N *tRC) ) / (double)(p->BANKS); //active energy - idle energy
-
-        activeEnergy += scale * ( (p->EIDD0 * tRC) - (p->EIDD3N *tRC) ) / (double)(p->BANKS); //active energy - idle energy
-    }
-    else
-    {
-        /* Flat energy model. */
-        subArrayEnergy += scale * p->Erd; 
-        activeEnergy += scale * p->Erd;
-    }
+    double energy = p->pimCosts.GetEnergy( request->type );
 
+    subArrayEnergy += energy;
+    activeEnergy += energy;
 
     return true;
 }
@@ -463,26 +485,68 @@ bool SubArray::MultiRowActivate(NVMainRequest *request )
         return false;
     }
 
+    ncycle_t tActivate = p->pimCosts.GetActivateCycles( request->type );
+    ncycle_t tRestore = p->pimCosts.GetRestoreCycles( request->type );
+    double energy = p->pimCosts.GetEnergy( request->type );
+    ncounter_t pinatuboCount = 0;
+
+    prechargeDelay = p->pimCosts.GetPrechargeDelay( request->type );
+
+    /*
+     *  Pinatubo raises the wordlines one after another, each like a single
+     *  row activate, and senses all rows at once against the reference of
+     *  the operation. XOR senses twice, against the OR and AND references.
+     */
+    if( p->pimMode == PIMMode_Pinatubo )
+    {
+        pinatuboCount = GetPinatuboRows( request );
+
+        tActivate = p->pimCosts.GetActivateCycles( SRA ) + (pinatuboCount - 1) * p->tPinatuboWL;
+        if( request->bulkOp == BBOP_XOR )
+            tActivate += p->tPinatuboSense;
+
+        tRestore = MAX( tActivate, p->pimCosts.GetRestoreCycles( SRA ) );
+        prechargeDelay = p->pimCosts.GetPrechargeDelay( SRA );
+
+        /* Every extra row adds to the cell current of the sensing step. */
+        energy = p->pimCosts.GetEnergy( SRA ) 
+               * (1.0 + (double)(pinatuboCount - 1) * p->PinatuboRowScale);
+
+        if( request->bulkOp == BBOP_XOR )
+        {
+            energy *= 2.0;
+            pinatubo_xor_senses++;
+        }
+        else if( request->bulkOp == BBOP_AND )
+        {
+            pinatubo_and_senses++;
+        }
+        else
+        {
+            pinatubo_or_senses++;
+        }
+
+        pinatubo_rows += pinatuboCount;
+    }
+
     /* Update timing constraints */
     nextPrecharge = MAX( nextPrecharge, 
-                         GetEventQueue()->GetCurrentCycle() 
-                             + MAX( p->tRCD, p->tRAS ) );
+                         GetEventQueue()->GetCurrentCycle() + tRestore );
 
     nextRead = MAX( nextRead, 
                     GetEventQueue()->GetCurrentCycle() 
-                        + p->tRCD - p->tAL + p->tSH * (numShifts / wordSize) );
+                        + tActivate - p->tAL + p->tSH * (numShifts / wordSize) );
 
     nextWrite = MAX( nextWrite, 
                      GetEventQueue()->GetCurrentCycle() 
-                         + p->tRCD - p->tAL + p->tSH * (numShifts / wordSize) );
+                         + tActivate - p->tAL + p->tSH * (numShifts / wordSize) );
 
     nextPowerDown = MAX( nextPowerDown, 
-                         GetEventQueue()->GetCurrentCycle() 
-                             + MAX( p->tRCD, p->tRAS ) );
+                         GetEventQueue()->GetCurrentCycle() + tRestore );
 
     /* send event response back up */
     GetEventQueue( )->InsertEvent( EventResponse, this, request, 
-                    GetEventQueue()->GetCurrentCycle() + p->tRCD + p->tSH * (numShifts / wordSize) );
+                    GetEventQueue()->GetCurrentCycle() + tActivate + p->tSH * (numShifts / wordSize) );
 
     /* 
      * The relative row number is record rather than the absolute row number 
@@ -490,53 +554,120 @@ bool SubArray::MultiRowActivate(NVMainRequest *request )
      */
     openRow = activateRow;
 
+    CountReservedRowActivate( activateRow );
+
     state = SUBARRAY_OPEN;
     writeCycle = false;
 
     lastActivate = GetEventQueue()->GetCurrentCycle();
 
-    double scale;
+    if( rowStore && pinatuboCount > 0 )
+        SensePinatubo( request, pinatuboCount );
+    else if( rowStore )
+        SenseRows( request );
+
+    pimActivates[PIMCostModel::GetPrimitive( request->type )]++;
+
+    /* Add to bank's total energy. */
+    subArrayEnergy += energy;
+    activeEnergy += energy;
+
+    return true;
+}
 
-    switch(request->type)
+/* Count activates of the reserved row groups. */
+void SubArray::CountReservedRowActivate( ncounter_t row )
+{
+    switch( p->GetReservedRowGroup( row ) )
     {
-        case SRA:
-            scale = 1.0;
-            single_row_activates++;
+        case ReservedRow_BGroup:
+            bgroup_activates++;
             break;
-        case DRA:
-            scale = 1.22;
-            double_row_activates++;
+        case ReservedRow_DCC:
+            dcc_activates++;
             break;
-        case TRA:
-            scale = 1.44;
-            triple_row_activates++;
+        case ReservedRow_Zero:
+        case ReservedRow_One:
+            constant_row_activates++;
             break;
+        case ReservedRow_None:
         default:
-            scale = 1.0;
-            std::cerr << "NVMain Error : MultiRowActivate unknown operation type "
-                        <<  request->type << std::endl;
             break;
     }
+}
 
-    /* Add to bank's total energy. */
+/*
+ *  LISA row buffer movement. The bitlines of the subarrays between source
+ *  and destination are linked and the row buffer is copied one subarray
+ *  per hop. The source keeps its row open until the move finishes and the
+ *  destination ends up open with the copied row buffer, ready to be
+ *  written into its row by an overlapped activate.
+ */
+bool SubArray::RowBufferMove( NVMainRequest *request )
+{
+    uint64_t dstRow, dstSubArray, srcSubArray;
+
+    request->address.GetTranslatedAddress( &dstRow, NULL, NULL, NULL, NULL, &dstSubArray );
+    request->address2.GetTranslatedAddress( NULL, NULL, NULL, NULL, NULL, &srcSubArray );
+
+    ncounter_t hops = (dstSubArray > srcSubArray) ? (dstSubArray - srcSubArray)
+                                                  : (srcSubArray - dstSubArray);
+    ncycle_t moveEnd = GetEventQueue()->GetCurrentCycle() + MAX( 1, hops * p->tRBM );
+
+    if( srcSubArray == subArrayId )
+    {
+        /* The source drives the linked bitlines until the move is done. */
+        nextPrecharge = MAX( nextPrecharge, moveEnd );
+        nextPowerDown = MAX( nextPowerDown, moveEnd );
+
+        return true;
+    }
+
+    /* sanity check */
+    if( nextActivate > GetEventQueue()->GetCurrentCycle() )
+    {
+        std::cerr << "NVMain Error: SubArray violates ROW BUFFER MOVE timing constraint!"
+            << std::endl;
+        return false;
+    }
+    else if( p->UsePrecharge && state != SUBARRAY_CLOSED )
+    {
+        std::cerr << "NVMain Error: try to move a row buffer into a subarray that is not idle!"
+            << std::endl;
+        return false;
+    }
+
+    /* Update timing constraints */
+    nextPrecharge = MAX( nextPrecharge, moveEnd );
+    nextRead = MAX( nextRead, moveEnd );
+    nextWrite = MAX( nextWrite, moveEnd );
+    nextPowerDown = MAX( nextPowerDown, moveEnd );
+    nextOverlappedActivate = moveEnd;
+
+    GetEventQueue( )->InsertEvent( EventResponse, this, request, moveEnd );
+
+    openRow = dstRow;
+
+    state = SUBARRAY_OPEN;
+    writeCycle = false;
+
+    lastActivate = GetEventQueue()->GetCurrentCycle();
+
+    /* Each hop senses the row buffer once more. */
     if( p->EnergyModel == "current" )
     {
         /* DRAM Model */
-        ncycle_t tRC = p->tRAS + p->tRP;
-
-        subArrayEnergy += scale * ( ( p->EIDD0 * (double)tRC ) 
-                    - ( ( p->EIDD3N * (double)(p->tRAS) )
-                    +  ( p->EIDD2N * (double)(p->tRP) ) ) ) / (double)(p->BANKS);
+        subArrayEnergy += (double)hops * ( ( p->EIDD0 - p->EIDD3N ) * (double)(p->tRBM) ) 
+                        / (double)(p->BANKS);
 
-        activeEnergy += scale * ( ( p->EIDD0 * (double)tRC ) 
-                      - ( ( p->EIDD3N * (double)(p->tRAS) )
-                      +  ( p->EIDD2N * (double)(p->tRP) ) ) ) / (double)(p->BANKS);
+        activeEnergy += (double)hops * ( ( p->EIDD0 - p->EIDD3N ) * (double)(p->tRBM) ) 
+                      / (double)(p->BANKS);
     }
     else
     {
         /* Flat energy model. */
-        subArrayEnergy += scale * p->Erd;
-        activeEnergy += scale * p->Erd;
+        subArrayEnergy += (double)hops * p->Erbm;
+        activeEnergy += (double)hops * p->Erbm;
     }
 
     return true;
@@ -574,6 +705,8 @@ bool SubArray::Activate( NVMainRequest *request )
                          GetEventQueue()->GetCurrentCycle() 
                              + MAX( p->tRCD, p->tRAS ) );
 
+    prechargeDelay = 0;
+
     nextRead = MAX( nextRead, 
                     GetEventQueue()->GetCurrentCycle() 
                         + p->tRCD - p->tAL + p->tSH * (numShifts / wordSize) );
@@ -602,6 +735,9 @@ bool SubArray::Activate( NVMainRequest *request )
 
     lastActivate = GetEventQueue()->GetCurrentCycle();
 
+    if( rowStore )
+        SenseRows( request );
+
     /* Add to bank's total energy. */
     if( p->EnergyModel == "current" )
     {
@@ -679,7 +815,7 @@ bool SubArray::Read( NVMainRequest *request )
         nextActivate = MAX( nextActivate, 
                             GetEventQueue()->GetCurrentCycle()
                                 + MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
-                                + p->tAL + p->tRTP + p->tRP + decLat );
+                                + p->tAL + p->tRTP + p->tRP + prechargeDelay + decLat );
 
         nextPrecharge = MAX( nextPrecharge, nextActivate );
         nextRead = MAX( nextRead, nextActivate );
@@ -741,16 +877,18 @@ bool SubArray::Read( NVMainRequest *request )
     if( p->EnergyModel == "current" )
     {
         /* DRAM Model */
-        subArrayEnergy += ( ( p->EIDD4R - p->EIDD3N ) * (double)(p->tBURST) ) / (double)(p->BANKS);
+        subArrayEnergy += ( ( p->EIDD4R - p->EIDD3N ) * (double)(p->tBURST) ) 
+                        * (double)(request->burstCount) / (double)(p->BANKS);
 
-        burstEnergy += ( ( p->EIDD4R - p->EIDD3N ) * (double)(p->tBURST) ) / (double)(p->BANKS);
+        burstEnergy += ( ( p->EIDD4R - p->EIDD3N ) * (double)(p->tBURST) ) 
+                     * (double)(request->burstCount) / (double)(p->BANKS);
     }
     else
     {
         /* Flat Energy Model */
-        subArrayEnergy += p->Eopenrd;
+        subArrayEnergy += p->Eopenrd * (double)(request->burstCount);
 
-        burstEnergy += p->Eopenrd;
+        burstEnergy += p->Eopenrd * (double)(request->burstCount);
     }
 
     /*
@@ -776,20 +914,20 @@ bool SubArray::Read( NVMainRequest *request )
         }
     }
 
+    if( p->PIMVerify )
+        VerifyRead( request );
+
     reads++;
-    dataCycles += p->tBURST;
+    dataCycles += p->tBURST * request->burstCount;
     
     return true;
 }
 
 bool SubArray::LocalWrite( NVMainRequest *request )
 {
-    uint64_t writeDBC, writeDomain;
-    ncycle_t writeTimer;
-    ncycle_t encLat = 0, endrLat = 0;
-    ncounter_t numUnchangedBits = 0;
+    uint64_t writeDBC;
 
-    request->address.GetTranslatedAddress( &writeDBC, &writeDomain, NULL, NULL, NULL, NULL );
+    request->address.GetTranslatedAddress( &writeDBC, NULL, NULL, NULL, NULL, NULL );
     
     /* TODO: Can we remove this sanity check and totally trust IsIssuable()? */
     /* sanity check */
@@ -812,7 +950,6 @@ bool SubArray::LocalWrite( NVMainRequest *request )
         return false;
     }
     
-    
     /* Write all bits */
 
     /* Don't have to worry about pausing or canceling here, this needs to happen in-order with other PIM operations */
@@ -833,8 +970,12 @@ bool SubArray::LocalWrite( NVMainRequest *request )
 
     nextPowerDown = MAX( nextPowerDown, nextPrecharge );
 
-    /* Notify owner of write completion as well */
-    GetEventQueue( )->InsertEvent( writeEvent, writeEventTime );
+    /* 
+     * The data comes from inside the bank, so no bus burst is issued. Notify
+     * the owner once the row buffer holds the data.
+     */
+    GetEventQueue( )->InsertEvent( EventResponse, this, request, 
+            GetEventQueue()->GetCurrentCycle() + p->tCWD + p->tBURST );
 
     /* Calculate energy. */
     if( p->EnergyModel == "current" )
@@ -847,15 +988,17 @@ bool SubArray::LocalWrite( NVMainRequest *request )
     else
     {
         /* Flat energy model. */
-        subArrayEnergy += p->Ewr - p->Ewrpb * numUnchangedBits; // numUnchangedBits = 0
+        subArrayEnergy += p->Ewr;
 
         burstEnergy += p->Ewr;
     }
 
+    if( rowStore )
+        WriteColumn( request );
+
     writeCycle = true;
 
     local_writes++;
-    dataCycles += p->tBURST;
     
     return true;
 }
@@ -914,10 +1057,18 @@ bool SubArray::Write( NVMainRequest *request )
         {
             uint8_t *bitCountData = new uint8_t[request->data.GetSize()];
 
+            /* With functional rows, the old data is what the row holds now. */
+            if( rowStore )
+            {
+                memset( bitCountData, 0, request->data.GetSize() );
+                rowStore->ReadBytes( rowStore->GetRow( openRow ), GetColumnOffset( request ),
+                                     bitCountData, request->data.GetSize() );
+            }
+
             for( uint64_t bitCountByte = 0; bitCountByte < request->data.GetSize(); bitCountByte++ )
             {
                 bitCountData[bitCountByte] = request->data.GetByte( bitCountByte )
-                                           ^ request->oldData.GetByte( bitCountByte );
+                    ^ (rowStore ? bitCountData[bitCountByte] : request->oldData.GetByte( bitCountByte ));
             }
 
             ncounter_t bitCountWords = request->data.GetSize()/4;
@@ -978,7 +1129,7 @@ bool SubArray::Write( NVMainRequest *request )
                             GetEventQueue()->GetCurrentCycle()
                             + MAX( p->tBURST, p->tCCD ) * (request->burstCount - 1)
                             + p->tAL + p->tCWD + p->tBURST 
-                            + writeTimer + p->tWR + p->tRP );
+                            + writeTimer + p->tWR + p->tRP + prechargeDelay );
 
         nextPrecharge = MAX( nextPrecharge, nextActivate );
         nextRead = MAX( nextRead, nextActivate );
@@ -1039,7 +1190,7 @@ bool SubArray::Write( NVMainRequest *request )
 
     assert( hook != NULL );
 
-    writeEvent = new NVM::Event( );
+    writeEvent = GetEventQueue( )->AllocateEvent( );
     writeEvent->SetType( EventResponse );
     writeEvent->SetRecipient( hook );
     writeEvent->SetRequest( request );
@@ -1060,22 +1211,27 @@ bool SubArray::Write( NVMainRequest *request )
     if( p->EnergyModel == "current" )
     {
         /* DRAM Model. */
-        subArrayEnergy += ( ( p->EIDD4W - p->EIDD3N ) * (double)(p->tBURST) ) / (double)(p->BANKS);
+        subArrayEnergy += ( ( p->EIDD4W - p->EIDD3N ) * (double)(p->tBURST) ) 
+                        * (double)(request->burstCount) / (double)(p->BANKS);
 
-        burstEnergy += ( ( p->EIDD4W - p->EIDD3N ) * (double)(p->tBURST) ) / (double)(p->BANKS);
+        burstEnergy += ( ( p->EIDD4W - p->EIDD3N ) * (double)(p->tBURST) ) 
+                     * (double)(request->burstCount) / (double)(p->BANKS);
     }
     else
     {
         /* Flat energy model. */
-        subArrayEnergy += p->Ewr - p->Ewrpb * numUnchangedBits;
+        subArrayEnergy += p->Ewr * (double)(request->burstCount) - p->Ewrpb * numUnchangedBits;
 
-        burstEnergy += p->Ewr;
+        burstEnergy += p->Ewr * (double)(request->burstCount);
     }
 
+    if( rowStore )
+        WriteColumn( request );
+
     writeCycle = true;
 
     writes++;
-    dataCycles += p->tBURST;
+    dataCycles += p->tBURST * request->burstCount;
     
     return true;
 }
@@ -1211,10 +1367,10 @@ bool SubArray::Precharge( NVMainRequest *request )
     }
 
     /* Update timing constraints */
-    writeTimer = MAX( 1, p->tRP ); // Assume write-through. Needs to be at least one due to event callback.
+    writeTimer = MAX( 1, p->tRP + prechargeDelay ); // Assume write-through. Needs to be at least one due to event callback.
     if( writeMode == WRITE_BACK && writeCycle )
     {
-        writeTimer = MAX( 1, p->tRP + WriteCellData( request ) );
+        writeTimer = MAX( 1, p->tRP + prechargeDelay + WriteCellData( request ) );
 
         ncycle_t encLat = 0;
         ncycle_t endrLat = 0;
@@ -1377,7 +1533,7 @@ void SubArray::CheckWritePausing( )
 
         /* Delete the old event indicating write completion. */
         GetEventQueue( )->RemoveEvent( writeEvent, writeEventTime );
-        delete writeEvent;
+        GetEventQueue( )->FreeEvent( writeEvent );
         writeEvent = NULL;
 
         /* Return this write as paused/cancelled. */
@@ -1412,6 +1568,10 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
     unsigned int memoryWordSize = static_cast<unsigned int>(p->tBURST * p->RATE * p->BusWidth);
     unsigned int writeBytes32 = memoryWordSize / 32;
 
+    /* Only count the cells of a data block shorter than the memory word. */
+    if( rawData && request->data.GetSize( ) / 4 < writeBytes32 )
+        writeBytes32 = static_cast<unsigned int>( request->data.GetSize( ) / 4 );
+
     if( p->UniformWrites )
     {
         if( p->MLCLevels > 1 )
@@ -1484,7 +1644,7 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
         ncounter_t writeCount11 = CountBitsMLC2( 3, rawData, writeBytes32 );
 
         assert( (writeCount00 + writeCount01 + writeCount10 + writeCount11)
-                == (memoryWordSize/2) );
+                == (writeBytes32 * 16) );
 
         /* 
          *  Naive scheduling -- Assume we have enough write drivers for all the data.
@@ -1579,8 +1739,9 @@ ncycle_t SubArray::NextIssuable( NVMainRequest *request )
     ncycle_t nextCompare = 0;
 
     if( request->type == ACTIVATE ) nextCompare = nextActivate;
+    else if( PIMCostModel::IsOverlappedActivate( request->type ) ) nextCompare = nextOverlappedActivate;
     else if( request->type == READ ) nextCompare = nextRead;
-    else if( request->type == WRITE ) nextCompare = nextWrite;
+    else if( request->type == WRITE || request->type == LW ) nextCompare = nextWrite;
     else if( request->type == PRECHARGE ) nextCompare = nextPrecharge;
         
     // Should have no children
@@ -1600,7 +1761,7 @@ bool SubArray::IsIssuable( NVMainRequest *req, FailReason *reason )
     if( nextCommand != CMD_NOP )
         return false;
 
-    if( req->type == ACTIVATE || req->type == TRA || req->type == DRA || req->type == SRA )
+    if( req->type == ACTIVATE || PIMCostModel::IsMultiRowActivate( req->type ) )
     {
         if( nextActivate > (GetEventQueue()->GetCurrentCycle()) /* if it is too early to open */
             || (p->UsePrecharge && state != SUBARRAY_CLOSED)   /* or, the subarray needs a precharge */
@@ -1622,9 +1783,10 @@ bool SubArray::IsIssuable( NVMainRequest *req, FailReason *reason )
             }
         }
     }
-    else if ( req->type == OA || req->type == ODRA || req->type == OTRA )
+    else if ( PIMCostModel::IsOverlappedActivate( req->type ) )
     {
         if( state != SUBARRAY_OPEN  /* the subarray is not active */
+            || nextOverlappedActivate > GetEventQueue()->GetCurrentCycle() /* or, a row buffer move is in flight */
             || ( p->WritePausing && isWriting && writeRequest->flags & NVMainRequest::FLAG_FORCED ) ) /* or, write can't be paused. */
         {
             rv = false;
@@ -1632,6 +1794,37 @@ bool SubArray::IsIssuable( NVMainRequest *req, FailReason *reason )
                 reason->reason = SUBARRAY_TIMING;
         }
     }
+    else if( req->type == ROWCLONE_LISA )
+    {
+        uint64_t srcRow, srcSubArray;
+
+        req->address2.GetTranslatedAddress( &srcRow, NULL, NULL, NULL, NULL, &srcSubArray );
+
+        if( srcSubArray == subArrayId )
+        {
+            /* The source must have its row latched in the row buffer. */
+            if( nextRead > (GetEventQueue()->GetCurrentCycle())
+                || state != SUBARRAY_OPEN 
+                || srcRow != openRow )
+            {
+                rv = false;
+                if( reason ) 
+                    reason->reason = SUBARRAY_TIMING;
+            }
+        }
+        else
+        {
+            /* The destination row buffer must be precharged. */
+            if( nextActivate > (GetEventQueue()->GetCurrentCycle())
+                || (p->UsePrecharge && state != SUBARRAY_CLOSED)
+                || (p->WritePausing && isWriting) )
+            {
+                rv = false;
+                if( reason ) 
+                    reason->reason = SUBARRAY_TIMING;
+            }
+        }
+    }
     else if( req->type == SHIFT )
     {
         /* We assume subarray can always shift, because ACTIVATE before this has been successfully performed. */
@@ -1648,7 +1841,7 @@ bool SubArray::IsIssuable( NVMainRequest *req, FailReason *reason )
                 reason->reason = SUBARRAY_TIMING;
         }
     }
-    else if( req->type == WRITE || req->type == WRITE_PRECHARGE )
+    else if( req->type == WRITE || req->type == WRITE_PRECHARGE || req->type == LW )
     {
         if( nextWrite > (GetEventQueue()->GetCurrentCycle()) /* if it is too early to write */
             || state != SUBARRAY_OPEN  /* or, the subarray is not active */          
@@ -1734,15 +1927,8 @@ bool SubArray::IssueCommand( NVMainRequest *req )
             case SHIFT:
                 rv = this->Shift( req );
                 break;
-            case OA:
-            case ODRA:
-            case OTRA:
-                rv = this->OverlappedActivate( req );
-                break;
-            case SRA:
-            case DRA:
-            case TRA:
-                rv = this->MultiRowActivate( req );
+            case ROWCLONE_LISA:
+                rv = this->RowBufferMove( req );
                 break;
             case READ:
             case READ_PRECHARGE:
@@ -1753,6 +1939,10 @@ bool SubArray::IssueCommand( NVMainRequest *req )
             case WRITE_PRECHARGE:
                 rv = this->Write( req );
                 break;
+
+            case LW:
+                rv = this->LocalWrite( req );
+                break;
             
             case PRECHARGE:
             case PRECHARGE_ALL:
@@ -1763,9 +1953,15 @@ bool SubArray::IssueCommand( NVMainRequest *req )
                 rv = this->Refresh( req );
                 break;
 
+            /* PIM activates are dispatched by their entry in the cost table. */
             default:
-                std::cerr << "NVMain Error : subarray detects unknown operation "
-                    << "in command queue! " << req->type << std::endl;
+                if( PIMCostModel::IsMultiRowActivate( req->type ) )
+                    rv = this->MultiRowActivate( req );
+                else if( PIMCostModel::IsOverlappedActivate( req->type ) )
+                    rv = this->OverlappedActivate( req );
+                else
+                    std::cerr << "NVMain Error : subarray detects unknown operation "
+                        << "in command queue! " << req->type << std::endl;
                 break;  
         }
     }
@@ -1871,6 +2067,235 @@ bool SubArray::RequestComplete( NVMainRequest *req )
     }
 }
 
+/*
+ *  Rows raised together by a (multi-row) activate that starts at the
+ *  request's row. On the B-group and DCC rows they follow Ambit's B-group
+ *  addresses:
+ *
+ *    two rows:   DCCi -> DCCi, Ti     Ti -> Ti, Ti+1
+ *    three rows: T0 -> T0, T1, T2     T1 -> T1, T2, DCC0     T3 -> T3, T0, DCC1
+ *
+ *  Other rows raise the consecutive rows starting at the request's row.
+ */
+ncounter_t SubArray::GetActivatedRows( NVMainRequest *request, ncounter_t *rows )
+{
+    uint64_t row;
+    ncounter_t count = PIMCostModel::GetRows( request->type );
+
+    request->address.GetTranslatedAddress( &row, NULL, NULL, NULL, NULL, NULL );
+
+    for( ncounter_t i = 0; i < count; i++ )
+        rows[i] = row + i;
+
+    if( p->ReservedBGroupRows < 4 || p->ReservedDCCRows < 2 )
+        return count;
+
+    ncounter_t T0 = p->GetReservedRowBase( ReservedRow_BGroup );
+    ncounter_t DCC0 = p->GetReservedRowBase( ReservedRow_DCC );
+
+    if( count == 2 && ( row == DCC0 || row == DCC0 + 1 ) )
+    {
+        rows[1] = T0 + (row - DCC0);
+    }
+    else if( count == 3 && row == T0 + 1 )
+    {
+        rows[2] = DCC0;
+    }
+    else if( count == 3 && row == T0 + 3 )
+    {
+        rows[1] = T0;
+        rows[2] = DCC0 + 1;
+    }
+
+    return count;
+}
+
+/*
+ *  Rows a Pinatubo multi-row activate senses, the consecutive rows from the
+ *  request's row. A request that the sense amplifiers cannot resolve is a
+ *  trace error, so the simulation stops.
+ */
+ncounter_t SubArray::GetPinatuboRows( NVMainRequest *request )
+{
+    uint64_t row;
+    ncounter_t count = request->activateRows;
+
+    request->address.GetTranslatedAddress( &row, NULL, NULL, NULL, NULL, NULL );
+
+    if( count == 0 )
+        count = PIMCostModel::GetRows( request->type );
+
+    if( count > p->PinatuboMaxRows )
+    {
+        std::cerr << "NVMain Error: Pinatubo activate of " << count 
+            << " rows exceeds PinatuboMaxRows (" << p->PinatuboMaxRows 
+            << ")." << std::endl;
+        exit(1);
+    }
+
+    if( request->bulkOp == BBOP_XOR && count != 2 )
+    {
+        std::cerr << "NVMain Error: Pinatubo XOR senses exactly two rows, not " 
+            << count << "." << std::endl;
+        exit(1);
+    }
+
+    if( row + count > p->SubArrayRows( ) )
+    {
+        std::cerr << "NVMain Error: Pinatubo activate of " << count 
+            << " rows from row " << row << " crosses the subarray boundary." 
+            << std::endl;
+        exit(1);
+    }
+
+    return count;
+}
+
+/* Byte offset of the request's column within the row. */
+ncounter_t SubArray::GetColumnOffset( NVMainRequest *request )
+{
+    uint64_t col;
+
+    request->address.GetTranslatedAddress( NULL, &col, NULL, NULL, NULL, NULL );
+
+    return col * p->tBURST * p->RATE * p->BusWidth / 8;
+}
+
+/*
+ *  Activating from precharged senses the rows into the row buffer: one row
+ *  is copied, two rows resolve to the first row and three or more rows to
+ *  their bitwise majority, with ties going to the first row. The sense
+ *  amplifiers then drive the result back into every raised row.
+ */
+void SubArray::SenseRows( NVMainRequest *request )
+{
+    ncounter_t rows[PIMCostModel::MaxRows];
+    ncounter_t count = GetActivatedRows( request, rows );
+    ncounter_t words = rowStore->GetRowWords( );
+
+    if( count == 3 )
+    {
+        RowStore::Majority( &rowBuffer[0], rowStore->GetRow( rows[0] ), 
+                            rowStore->GetRow( rows[1] ), rowStore->GetRow( rows[2] ), words );
+    }
+    else if( count > 3 )
+    {
+        const uint64_t *srcs[PIMCostModel::MaxRows];
+
+        for( ncounter_t i = 0; i < count; i++ )
+            srcs[i] = rowStore->GetRow( rows[i] );
+
+        RowStore::Majority( &rowBuffer[0], srcs, count, words );
+    }
+    else
+    {
+        RowStore::Copy( &rowBuffer[0], rowStore->GetRow( rows[0] ), words );
+    }
+
+    for( ncounter_t i = (count >= 3) ? 0 : 1; i < count; i++ )
+        rowStore->SetRow( rows[i], &rowBuffer[0] );
+}
+
+/*
+ *  NVM sensing does not disturb the cells, so the row buffer receives the
+ *  OR, AND or XOR of the raised rows and the rows keep their contents.
+ */
+void SubArray::SensePinatubo( NVMainRequest *request, ncounter_t count )
+{
+    uint64_t row;
+    ncounter_t words = rowStore->GetRowWords( );
+
+    request->address.GetTranslatedAddress( &row, NULL, NULL, NULL, NULL, NULL );
+
+    RowStore::Copy( &rowBuffer[0], rowStore->GetRow( row ), words );
+
+    for( ncounter_t i = 1; i < count; i++ )
+    {
+        const uint64_t *next = rowStore->GetRow( row + i );
+
+        if( request->bulkOp == BBOP_XOR )
+            RowStore::Xor( &rowBuffer[0], &rowBuffer[0], next, words );
+        else if( request->bulkOp == BBOP_AND )
+            RowStore::And( &rowBuffer[0], &rowBuffer[0], next, words );
+        else
+            RowStore::Or( &rowBuffer[0], &rowBuffer[0], next, words );
+    }
+}
+
+/*
+ *  Overlapped activates copy the row buffer into the raised rows. DCC rows
+ *  are reached through their negated wordline here, so they store the
+ *  complement that a later activate reads back.
+ */
+void SubArray::RestoreRows( NVMainRequest *request )
+{
+    ncounter_t rows[PIMCostModel::MaxRows];
+    ncounter_t count = GetActivatedRows( request, rows );
+
+    for( ncounter_t i = 0; i < count; i++ )
+    {
+        if( p->GetReservedRowGroup( rows[i] ) == ReservedRow_DCC )
+            RowStore::Not( rowStore->GetWritableRow( rows[i] ), &rowBuffer[0], 
+                           rowStore->GetRowWords( ) );
+        else
+            rowStore->SetRow( rows[i], &rowBuffer[0] );
+    }
+}
+
+/* Writes the request's data into the open row and the row buffer. */
+void SubArray::WriteColumn( NVMainRequest *request )
+{
+    ncounter_t offset = GetColumnOffset( request );
+    ncounter_t size = request->data.GetSize( );
+
+    if( size == 0 )
+        return;
+
+    rowStore->WriteBytes( rowStore->GetWritableRow( openRow ), offset, request->data.rawData, size );
+    rowStore->WriteBytes( &rowBuffer[0], offset, request->data.rawData, size );
+}
+
+/* The data of a read is the value it is expected to return. */
+void SubArray::VerifyRead( NVMainRequest *request )
+{
+    ncounter_t offset = GetColumnOffset( request );
+    ncounter_t size = request->data.GetSize( );
+
+    if( size == 0 || offset >= rowStore->GetRowBytes( ) )
+        return;
+
+    if( offset + size > rowStore->GetRowBytes( ) )
+        size = rowStore->GetRowBytes( ) - offset;
+
+    uint8_t *actual = new uint8_t[size];
+
+    rowStore->ReadBytes( &rowBuffer[0], offset, actual, size );
+
+    if( memcmp( actual, request->data.rawData, size ) != 0 )
+    {
+        std::cerr << "NVMain Error: Read of 0x" << std::hex 
+            << request->address.GetPhysicalAddress( ) << std::dec 
+            << " in " << StatName( ) << " does not return the expected data." << std::endl;
+
+        read_verify_mismatches++;
+    }
+
+    delete [] actual;
+}
+
+/* Loads another subarray's row buffer, e.g., for a LISA row buffer move. */
+void SubArray::LoadRowBuffer( const uint64_t *data )
+{
+    RowStore::Copy( &rowBuffer[0], data, rowStore->GetRowWords( ) );
+}
+
+/* Replaces the open row, e.g., with a row copied from another bank. */
+void SubArray::StoreOpenRow( const uint64_t *data )
+{
+    LoadRowBuffer( data );
+    rowStore->SetRow( openRow, data );
+}
+
 ncycle_t SubArray::UpdateEndurance( NVMainRequest *request )
 {
     ncycle_t latency = 0;
@@ -1979,6 +2404,9 @@ void SubArray::CalculateStats( )
 
     actWaitAverage = static_cast<double>(actWaitTotal) / static_cast<double>(actWaits);
 
+    if( rowStore )
+        functional_rows = rowStore->GetAllocatedRows( );
+
     /* Print a histogram as a python-style dict. */
     mlcTimingHisto = PyDictHistogram<uint64_t, uint64_t>( mlcTimingMap );
     cancelCountHisto = PyDictHistogram<uint64_t, uint64_t>( cancelCountMap );
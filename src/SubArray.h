@@ -45,6 +45,7 @@
 
 #include <stdint.h>
 #include <map>
+#include <vector>
 
 #include "src/NVMObject.h"
 #include "src/Config.h"
@@ -54,6 +55,7 @@
 #include "include/NVMAddress.h"
 #include "include/NVMainRequest.h"
 #include "src/Params.h"
+#include "src/RowStore.h"
 
 #include <iostream>
 
@@ -100,6 +102,7 @@ class SubArray : public NVMObject
     bool LocalWrite( NVMainRequest *request );
     bool OverlappedActivate( NVMainRequest *request );
     bool MultiRowActivate( NVMainRequest *request );
+    bool RowBufferMove( NVMainRequest *request );
     bool Precharge( NVMainRequest *request );
     bool Refresh( NVMainRequest *request );
 
@@ -138,6 +141,12 @@ class SubArray : public NVMObject
     void Cycle( ncycle_t );
     bool IsWriting( ) { return isWriting; }
 
+    /* Functional row contents, NULL unless PIMFunctional is set. */
+    RowStore *GetRowStore( ) { return rowStore; }
+    const uint64_t *GetRowBuffer( ) { return &rowBuffer[0]; }
+    void LoadRowBuffer( const uint64_t *data );
+    void StoreOpenRow( const uint64_t *data );
+
   private:
     Config *conf;
     ncounter_t psInterval;
@@ -165,6 +174,8 @@ class SubArray : public NVMObject
     ncycle_t nextRead;
     ncycle_t nextWrite;
     ncycle_t nextPowerDown;
+    ncycle_t prechargeDelay;
+    ncycle_t nextOverlappedActivate;
     bool writeCycle;
     std::vector<NVMainRequest *> writeBackRequests;
     bool isWriting;
@@ -211,10 +222,11 @@ class SubArray : public NVMObject
 
     uint64_t worstCaseEndurance, averageEndurance;
 
-    ncounter_t reads, writes, activates, precharges, refreshes, 
-      overlapped_activates, overlapped_double_row_activates,
-      overlapped_triple_row_activates, single_row_activates,
-      double_row_activates, triple_row_activates, local_writes;
+    ncounter_t reads, writes, activates, precharges, refreshes, local_writes;
+    ncounter_t pimActivates[PIMPrimitives];
+    ncounter_t bgroup_activates, dcc_activates, constant_row_activates;
+    ncounter_t pinatubo_or_senses, pinatubo_and_senses, pinatubo_xor_senses,
+      pinatubo_rows;
     ncounter_t idleTimer;
 
     ncounter_t openRow;
@@ -233,6 +245,20 @@ class SubArray : public NVMObject
     std::string wpPauseHisto;
     std::string wpCancelHisto;
 
+    RowStore *rowStore;
+    std::vector<uint64_t> rowBuffer;
+    ncounter_t functional_rows, read_verify_mismatches;
+
+    ncounter_t GetActivatedRows( NVMainRequest *request, ncounter_t *rows );
+    ncounter_t GetPinatuboRows( NVMainRequest *request );
+    ncounter_t GetColumnOffset( NVMainRequest *request );
+    void CountReservedRowActivate( ncounter_t row );
+    void SenseRows( NVMainRequest *request );
+    void SensePinatubo( NVMainRequest *request, ncounter_t count );
+    void RestoreRows( NVMainRequest *request );
+    void WriteColumn( NVMainRequest *request );
+    void VerifyRead( NVMainRequest *request );
+
     ncycle_t WriteCellData( NVMainRequest *request );
     void CheckWritePausing( );
 
@@ -47,6 +47,13 @@ TranslationMethod::TranslationMethod( )
      * The method is for a 256 MB memory => 29 bits total.
      * The bits widths for each are 1 - 1 - 10 - 3 - 6 - 8 
      */
+    hasLayout = false;
+    layout = 0;
+    dataRows = 0;
+
+    for( int part = MEM_ROW; part <= MEM_SUBARRAY; part++ )
+        order[part] = -1;
+
     SetBitWidths( 10, 8, 3, 1, 1, 6 );
     SetOrder( 4, 1, 3, 5, 6, 2 );
 }
@@ -64,6 +71,8 @@ void TranslationMethod::SetBitWidths( unsigned int rowBits, unsigned int colBits
     bitWidths[MEM_RANK] = rankBits;
     bitWidths[MEM_CHANNEL] = channelBits;
     bitWidths[MEM_SUBARRAY] = subarrayBits;
+
+    UpdateLayout( );
 }
 
 void TranslationMethod::SetOrder( int row, int col, int bank, int rank, int channel, int subarray )
@@ -83,6 +92,53 @@ void TranslationMethod::SetOrder( int row, int col, int bank, int rank, int chan
     order[MEM_RANK] = rank - 1;
     order[MEM_CHANNEL] = channel - 1;
     order[MEM_SUBARRAY] = subarray - 1;
+
+    UpdateLayout( );
+}
+
+/*
+ *  Partitions are packed from order 0 at the LSB to order 5 at the MSB, so
+ *  each one is a contiguous bit field. The layout value packs the widths
+ *  and orders so translators can tell whether two layouts are the same.
+ */
+void TranslationMethod::UpdateLayout( )
+{
+    unsigned int shift = 0;
+    bool found[6] = { false, false, false, false, false, false };
+
+    hasLayout = true;
+    layout = 0;
+
+    for( int part = MEM_ROW; part <= MEM_SUBARRAY; part++ )
+    {
+        if( order[part] < 0 || order[part] > 5 || found[order[part]] 
+            || bitWidths[part] >= 64 )
+        {
+            hasLayout = false;
+            return;
+        }
+
+        found[order[part]] = true;
+        layout |= static_cast<uint64_t>( bitWidths[part] ) << (9 * part);
+        layout |= static_cast<uint64_t>( order[part] ) << (9 * part + 6);
+    }
+
+    for( int curOrder = 0; curOrder < 6; curOrder++ )
+    {
+        for( int part = MEM_ROW; part <= MEM_SUBARRAY; part++ )
+        {
+            if( order[part] == curOrder )
+            {
+                fieldShift[part] = shift;
+                fieldMask[part] = (1ULL << bitWidths[part]) - 1;
+                shift += bitWidths[part];
+            }
+        }
+    }
+
+    /* Very wide layouts are left to the generic translation. */
+    if( shift >= 64 )
+        hasLayout = false;
 }
 
 void TranslationMethod::SetCount( uint64_t rows, uint64_t cols, uint64_t banks, 
@@ -96,6 +152,11 @@ void TranslationMethod::SetCount( uint64_t rows, uint64_t cols, uint64_t banks,
     count[MEM_SUBARRAY] = subarrays;
 }
 
+void TranslationMethod::SetDataRows( uint64_t rows )
+{
+    dataRows = rows;
+}
+
 void TranslationMethod::GetBitWidths( unsigned int *rowBits, unsigned int *colBits, unsigned int *bankBits,
 				      unsigned int *rankBits, unsigned int *channelBits, unsigned int *subarrayBits )
 {
@@ -71,10 +71,34 @@ class TranslationMethod
     void GetCount( uint64_t *rows, uint64_t *cols, uint64_t *banks, 
                    uint64_t *ranks, uint64_t *channels, uint64_t *subarrays );
 
+    /* 
+     *  Bit position and mask of each partition, precomputed whenever the
+     *  widths or orders change. Only valid if HasLayout( ) is true.
+     */
+    bool HasLayout( ) { return hasLayout; }
+    uint64_t GetLayout( ) { return layout; }
+    unsigned int GetFieldShift( MemoryPartition p ) { return fieldShift[p]; }
+    uint64_t GetFieldMask( MemoryPartition p ) { return fieldMask[p]; }
+
+    /* 
+     *  Number of rows of each subarray that addresses map to, or 0 if all
+     *  of them do. The remaining rows at the top are not addressable.
+     */
+    void SetDataRows( uint64_t rows );
+    uint64_t GetDataRows( ) { return dataRows; }
+
   private:
     unsigned int bitWidths[6];
     uint64_t count[6];
     int order[6];
+    uint64_t dataRows;
+
+    bool hasLayout;
+    uint64_t layout;
+    unsigned int fieldShift[6];
+    uint64_t fieldMask[6];
+
+    void UpdateLayout( );
 };
 
 };
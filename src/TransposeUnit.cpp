@@ -0,0 +1,160 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+*
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+*
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* Author list:
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+
+#include "src/TransposeUnit.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+
+using namespace NVM;
+
+TransposeUnit::TransposeUnit( Params *p )
+{
+    base = p->TransposeBase;
+    width = p->TransposeWidth;
+    lineSize = p->tBURST * p->RATE * p->BusWidth / 8;
+    rowSize = p->COLS * lineSize;
+
+    /* Only whole blocks of `width' rows can be transposed. */
+    size = (p->TransposeSize / (width * rowSize)) * width * rowSize;
+    capacity = p->TransposeBufferLines / width;
+
+    if( width == 0 || size == 0 || capacity == 0 )
+    {
+        std::cerr << "NVMain Error: The transposition unit needs a TransposeSize of at least "
+                  << "TransposeWidth rows and room for TransposeWidth lines in its buffer."
+                  << std::endl;
+        exit(1);
+    }
+}
+
+TransposeUnit::~TransposeUnit( )
+{
+    std::list<TransposeGroup *>::iterator it;
+
+    for( it = groups.begin( ); it != groups.end( ); it++ )
+        delete (*it);
+}
+
+bool TransposeUnit::Contains( uint64_t address )
+{
+    return (address >= base && address - base < size);
+}
+
+TransposeGroup *TransposeUnit::Insert( uint64_t address, const uint8_t *data, ncounter_t size )
+{
+    ncounter_t groupSize = width * lineSize;
+    uint64_t groupAddress = base + ((address - base) / groupSize) * groupSize;
+    ncounter_t line = (address - groupAddress) / lineSize;
+    TransposeGroup *group = NULL;
+    std::list<TransposeGroup *>::iterator it;
+
+    for( it = groups.begin( ); it != groups.end( ); it++ )
+    {
+        if( (*it)->address == groupAddress )
+        {
+            group = *it;
+            break;
+        }
+    }
+
+    if( group == NULL )
+    {
+        group = new TransposeGroup;
+
+        group->address = groupAddress;
+        group->data.resize( groupSize, 0 );
+        group->present.resize( width, false );
+        group->lines = 0;
+
+        groups.push_back( group );
+    }
+
+    /* Requests without data (e.g., IgnoreData) write a zero line. */
+    if( size > lineSize )
+        size = lineSize;
+
+    memset( &group->data[line * lineSize], 0, lineSize );
+
+    if( data != NULL )
+        memcpy( &group->data[line * lineSize], data, size );
+
+    if( !group->present[line] )
+    {
+        group->present[line] = true;
+        group->lines++;
+    }
+
+    return group;
+}
+
+TransposeGroup *TransposeUnit::GetOldest( )
+{
+    return groups.empty( ) ? NULL : groups.front( );
+}
+
+void TransposeUnit::Remove( TransposeGroup *group )
+{
+    groups.remove( group );
+}
+
+uint64_t TransposeUnit::GetVerticalAddress( TransposeGroup *group, ncounter_t bit )
+{
+    ncounter_t groupSize = width * lineSize;
+    uint64_t offset = group->address - base;
+    uint64_t block = offset / (width * rowSize);
+    uint64_t column = (offset % (width * rowSize)) / groupSize;
+
+    return base + block * width * rowSize + bit * rowSize + column * lineSize;
+}
+
+/* Bit j of element e is bit e * width + j of the group's lines. */
+void TransposeUnit::Transpose( TransposeGroup *group, ncounter_t bit, uint8_t *line )
+{
+    ncounter_t elements = lineSize * 8;
+
+    for( ncounter_t element = 0; element < elements; element++ )
+    {
+        ncounter_t source = element * width + bit;
+
+        if( !group->present[source / elements] )
+            continue;
+
+        uint8_t value = (group->data[source / 8] >> (source % 8)) & 1;
+
+        line[element / 8] = static_cast<uint8_t>( 
+            (line[element / 8] & ~(1 << (element % 8))) | (value << (element % 8)) );
+    }
+}
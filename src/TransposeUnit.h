@@ -0,0 +1,117 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+*
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+*
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+*
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* Author list:
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+
+#ifndef __NVMAIN_TRANSPOSEUNIT_H__
+#define __NVMAIN_TRANSPOSEUNIT_H__
+
+#include <stdint.h>
+#include <list>
+#include <vector>
+
+#include "include/NVMTypes.h"
+#include "src/Params.h"
+
+namespace NVM {
+
+/* Lines of one group, collected in the transposition buffer. */
+struct TransposeGroup
+{
+    uint64_t address;           ///< Horizontal address of the first line
+    std::vector<uint8_t> data;
+    std::vector<bool> present;
+    ncounter_t lines;
+};
+
+/*
+ *  SIMDRAM-style transposition unit. The host writes packed n-bit elements
+ *  to the transpose region in horizontal cache lines, but bit-serial PIM
+ *  operations expect bit i of every element in row i of the operand.
+ *
+ *  The region is divided into blocks of n rows, which hold the same number
+ *  of bytes in either layout. The n consecutive lines of a group hold one
+ *  line's worth of elements (one per bit of a line); transposed, bit i of
+ *  these elements is the line of row i at the column of the group.
+ *
+ *  Lines are gathered in the buffer until their group is complete. If the
+ *  buffer is full, the oldest group is taken out early; the lines it misses
+ *  then have to be merged with the vertical lines already in memory.
+ */
+class TransposeUnit
+{
+  public:
+    TransposeUnit( Params *p );
+    ~TransposeUnit( );
+
+    bool Contains( uint64_t address );
+
+    ncounter_t GetWidth( ) { return width; }
+    ncounter_t GetLineSize( ) { return lineSize; }
+    ncounter_t GetBufferedGroups( ) { return groups.size( ); }
+
+    /* 
+     *  Buffers one horizontal line. Returns its group, which is complete
+     *  once all of its lines were written.
+     */
+    TransposeGroup *Insert( uint64_t address, const uint8_t *data, ncounter_t size );
+
+    /* Whether the buffer holds more groups than fit. */
+    bool Overflows( ) { return groups.size( ) > capacity; }
+    TransposeGroup *GetOldest( );
+
+    /* Takes a group out of the buffer. The caller owns it afterwards. */
+    void Remove( TransposeGroup *group );
+
+    bool IsComplete( TransposeGroup *group ) { return group->lines == width; }
+    uint64_t GetVerticalAddress( TransposeGroup *group, ncounter_t bit );
+
+    /* 
+     *  Writes bit `bit' of the group's elements into the vertical line. Bits
+     *  of lines that were not written are left unchanged.
+     */
+    void Transpose( TransposeGroup *group, ncounter_t bit, uint8_t *line );
+
+  private:
+    uint64_t base;
+    uint64_t size;
+    ncounter_t width;
+    ncounter_t lineSize;
+    ncounter_t rowSize;
+    ncounter_t capacity;
+
+    std::list<TransposeGroup *> groups;
+};
+
+};
+
+#endif
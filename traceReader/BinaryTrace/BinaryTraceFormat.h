@@ -0,0 +1,151 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __BINARYTRACEFORMAT_H__
+#define __BINARYTRACEFORMAT_H__
+
+#include "include/NVMainRequest.h"
+#include "include/NVMTypes.h"
+#include "src/PIMCostModel.h"
+
+#include <stdint.h>
+
+namespace NVM {
+
+/*
+ *  Binary trace format shared by BinaryTraceReader and BinaryTraceWriter.
+ *
+ *  The file starts with a 16 byte header: the magic "NVMB", a 16-bit
+ *  version and 16-bit flags field, the 32-bit default data block size and
+ *  a reserved 32-bit word, all little endian. Each record then consists of
+ *
+ *    - one byte with the op code in the low 5 bits and the flags below,
+ *    - the cycle as a zig-zag varint delta to the previous record,
+ *    - the address as a zig-zag varint delta to the previous record,
+ *    - address2 as a zig-zag varint delta to address (if present),
+ *    - the thread id as a zig-zag varint,
+ *    - for BBOP records, address3 as a zig-zag varint delta to address,
+ *      followed by the bulk operation, size and width as varints,
+ *    - for multi-row activate records, the sensed bulk operation and the
+ *      number of activated rows (0 = by op code) as varints,
+ *    - the data and old data blocks as a varint size and raw bytes
+ *      (if present).
+ */
+const char BinaryTraceMagic[4] = { 'N', 'V', 'M', 'B' };
+const uint16_t BinaryTraceVersion = 1;
+const size_t BinaryTraceHeaderSize = 16;
+
+const uint8_t BinaryTraceOpMask = 0x1F;
+const uint8_t BinaryTraceHasData = 0x20;
+const uint8_t BinaryTraceHasOldData = 0x40;
+const uint8_t BinaryTraceHasAddress2 = 0x80;
+
+/* 
+ *  Op codes are stored by their index here so OpType and PIMPrimitive may be
+ *  reordered. New operations are appended.
+ */
+const OpType BinaryTraceOps[] = { NOP, READ, WRITE, SRA, TRA, DRA, OA, 
+                                  ODRA, OTRA, LW, ROWCLONE_PSM, ROWCLONE_LISA,
+                                  QRA, FRA, BBOP };
+const uint8_t BinaryTraceOpCount = sizeof(BinaryTraceOps) / sizeof(BinaryTraceOps[0]);
+
+static_assert( BinaryTraceOpCount <= BinaryTraceOpMask + 1, 
+               "Binary trace op codes do not fit in BinaryTraceOpMask" );
+
+/* The op code of an operation, or BinaryTraceOpCount if it can't be stored. */
+inline uint8_t GetBinaryTraceOpCode( OpType operation )
+{
+    for( uint8_t opCode = 0; opCode < BinaryTraceOpCount; opCode++ )
+    {
+        if( BinaryTraceOps[opCode] == operation )
+            return opCode;
+    }
+
+    return BinaryTraceOpCount;
+}
+
+inline uint64_t ZigZagEncode( int64_t value )
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t ZigZagDecode( uint64_t value )
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/* Writes value 7 bits at a time, returns the number of bytes used. */
+inline size_t EncodeVarint( uint64_t value, uint8_t *buffer )
+{
+    size_t length = 0;
+
+    while( value >= 0x80 )
+    {
+        buffer[length++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+
+    buffer[length++] = static_cast<uint8_t>(value);
+
+    return length;
+}
+
+/* Reads a varint from [*cursor, end). Returns false if it is truncated. */
+inline bool DecodeVarint( const uint8_t **cursor, const uint8_t *end, uint64_t *value )
+{
+    const uint8_t *pos = *cursor;
+    uint64_t result = 0;
+    unsigned int shift = 0;
+
+    while( pos < end && shift < 64 )
+    {
+        uint8_t byte = *pos++;
+
+        result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+
+        if( (byte & 0x80) == 0 )
+        {
+            *cursor = pos;
+            *value = result;
+            return true;
+        }
+
+        shift += 7;
+    }
+
+    return false;
+}
+
+};
+
+#endif
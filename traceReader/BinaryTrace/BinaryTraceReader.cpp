@@ -0,0 +1,310 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceReader/BinaryTrace/BinaryTraceReader.h"
+#include "traceReader/BinaryTrace/BinaryTraceFormat.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace NVM;
+
+BinaryTraceReader::BinaryTraceReader( )
+{
+    traceFile = "";
+
+    traceFd = -1;
+    traceStart = NULL;
+    traceEnd = NULL;
+    cursor = NULL;
+    traceSize = 0;
+    opened = false;
+
+    lastCycle = 0;
+    lastAddress = 0;
+    records = 0;
+}
+
+BinaryTraceReader::~BinaryTraceReader( )
+{
+    if( traceStart != NULL )
+        munmap( const_cast<uint8_t *>(traceStart), traceSize );
+
+    if( traceFd >= 0 )
+        close( traceFd );
+}
+
+void BinaryTraceReader::SetTraceFile( std::string file )
+{
+    traceFile = file;
+}
+
+std::string BinaryTraceReader::GetTraceFile( )
+{
+    return traceFile;
+}
+
+bool BinaryTraceReader::OpenTrace( )
+{
+    struct stat traceStat;
+
+    opened = true;
+
+    traceFd = open( traceFile.c_str( ), O_RDONLY );
+
+    if( traceFd < 0 || fstat( traceFd, &traceStat ) != 0 )
+    {
+        std::cerr << "Could not open trace file: " << traceFile << "!" << std::endl;
+        return false;
+    }
+
+    traceSize = static_cast<size_t>( traceStat.st_size );
+
+    if( traceSize < BinaryTraceHeaderSize )
+    {
+        std::cerr << "BinaryTraceReader: " << traceFile << " is too short to "
+                  << "be a binary trace!" << std::endl;
+        return false;
+    }
+
+    void *mapping = mmap( NULL, traceSize, PROT_READ, MAP_PRIVATE, traceFd, 0 );
+
+    if( mapping == MAP_FAILED )
+    {
+        std::cerr << "BinaryTraceReader: Could not map trace file: " << traceFile 
+                  << "!" << std::endl;
+        return false;
+    }
+
+    /* Records are only read front to back. */
+    madvise( mapping, traceSize, MADV_SEQUENTIAL );
+
+    traceStart = static_cast<const uint8_t *>( mapping );
+    traceEnd = traceStart + traceSize;
+
+    uint16_t version = static_cast<uint16_t>( traceStart[4] | (traceStart[5] << 8) );
+
+    if( memcmp( traceStart, BinaryTraceMagic, sizeof(BinaryTraceMagic) ) != 0 )
+    {
+        std::cerr << "BinaryTraceReader: " << traceFile << " is not a binary "
+                  << "trace!" << std::endl;
+        munmap( mapping, traceSize );
+        traceStart = NULL;
+        return false;
+    }
+
+    if( version != BinaryTraceVersion )
+    {
+        std::cerr << "BinaryTraceReader: Unsupported trace version " << version
+                  << " in " << traceFile << "!" << std::endl;
+        munmap( mapping, traceSize );
+        traceStart = NULL;
+        return false;
+    }
+
+    cursor = traceStart + BinaryTraceHeaderSize;
+
+    return true;
+}
+
+bool BinaryTraceReader::ReadDataBlock( NVMDataBlock& block )
+{
+    uint64_t size;
+
+    if( !DecodeVarint( &cursor, traceEnd, &size ) 
+        || size > static_cast<uint64_t>( traceEnd - cursor ) )
+    {
+        return false;
+    }
+
+    block.SetSize( size );
+    memcpy( block.rawData, cursor, size );
+    cursor += size;
+
+    return true;
+}
+
+/* Send back a "dummy" line like the text trace reader does. */
+bool BinaryTraceReader::EndOfTrace( TraceLine *nextAccess )
+{
+    NVMAddress nAddress;
+    NVMDataBlock dataBlock;
+    NVMDataBlock oldDataBlock;
+
+    nAddress.SetPhysicalAddress( 0xDEADC0DEDEADBEEFULL );
+    nextAccess->SetLine( nAddress, NOP, 0, dataBlock, oldDataBlock, 0 );
+
+    return false;
+}
+
+bool BinaryTraceReader::GetNextAccess( TraceLine *nextAccess )
+{
+    /* If there is no trace file, we can't do anything. */
+    if( traceFile == "" )
+    {
+        std::cerr << "No trace file specified!" << std::endl;
+        return false;
+    }
+
+    if( !opened && !OpenTrace( ) )
+        return EndOfTrace( nextAccess );
+
+    if( traceStart == NULL )
+        return EndOfTrace( nextAccess );
+
+    if( cursor >= traceEnd )
+    {
+        std::cout << "BinaryTraceReader: Reached EOF!" << std::endl;
+        return EndOfTrace( nextAccess );
+    }
+
+    uint8_t header = *cursor++;
+    uint8_t opCode = header & BinaryTraceOpMask;
+    uint64_t cycleDelta, addressDelta, address2Delta = 0, threadId;
+    uint64_t address3Delta = 0, bulkOp = 0, bulkSize = 0, bulkWidth = 1;
+    uint64_t activateRows = 0;
+    NVMDataBlock dataBlock;
+    NVMDataBlock oldDataBlock;
+    bool valid = true;
+
+    valid = valid && DecodeVarint( &cursor, traceEnd, &cycleDelta );
+    valid = valid && DecodeVarint( &cursor, traceEnd, &addressDelta );
+
+    if( valid && (header & BinaryTraceHasAddress2) )
+        valid = DecodeVarint( &cursor, traceEnd, &address2Delta );
+
+    valid = valid && DecodeVarint( &cursor, traceEnd, &threadId );
+
+    if( valid && opCode < BinaryTraceOpCount && BinaryTraceOps[opCode] == BBOP )
+    {
+        valid = DecodeVarint( &cursor, traceEnd, &address3Delta )
+             && DecodeVarint( &cursor, traceEnd, &bulkOp )
+             && DecodeVarint( &cursor, traceEnd, &bulkSize )
+             && DecodeVarint( &cursor, traceEnd, &bulkWidth );
+    }
+    else if( valid && opCode < BinaryTraceOpCount 
+             && PIMCostModel::IsMultiRowActivate( BinaryTraceOps[opCode] ) )
+    {
+        valid = DecodeVarint( &cursor, traceEnd, &bulkOp )
+             && DecodeVarint( &cursor, traceEnd, &activateRows );
+    }
+
+    if( valid && (header & BinaryTraceHasData) )
+        valid = ReadDataBlock( dataBlock );
+
+    if( valid && (header & BinaryTraceHasOldData) )
+        valid = ReadDataBlock( oldDataBlock );
+
+    records++;
+
+    if( !valid || opCode >= BinaryTraceOpCount )
+    {
+        std::cerr << "BinaryTraceReader: Record " << records << " of " 
+                  << traceFile << " is corrupt!" << std::endl;
+        cursor = traceEnd;
+        return EndOfTrace( nextAccess );
+    }
+
+    OpType operation = BinaryTraceOps[opCode];
+
+    lastCycle += ZigZagDecode( cycleDelta );
+    lastAddress += ZigZagDecode( addressDelta );
+
+    NVMAddress nAddress;
+
+    nAddress.SetPhysicalAddress( lastAddress );
+
+    /* As in the text format, OA and TRA use address for address2 if none is given. */
+    if( (header & BinaryTraceHasAddress2) || operation == OA || operation == TRA )
+    {
+        NVMAddress nAddress2;
+
+        nAddress2.SetPhysicalAddress( lastAddress + ZigZagDecode( address2Delta ) );
+
+        nextAccess->SetLine( nAddress, nAddress2, operation, lastCycle, dataBlock, 
+                             oldDataBlock, ZigZagDecode( threadId ) );
+    }
+    else
+    {
+        nextAccess->SetLine( nAddress, operation, lastCycle, dataBlock, 
+                             oldDataBlock, ZigZagDecode( threadId ) );
+    }
+
+    if( operation == BBOP )
+    {
+        NVMAddress nAddress3;
+
+        nAddress3.SetPhysicalAddress( lastAddress + ZigZagDecode( address3Delta ) );
+
+        nextAccess->SetBulkOperation( nAddress3, static_cast<BulkBitwiseOp>( bulkOp ),
+                                      bulkSize, bulkWidth );
+    }
+    else if( PIMCostModel::IsMultiRowActivate( operation ) )
+    {
+        nextAccess->SetMultiRowActivate( static_cast<BulkBitwiseOp>( bulkOp ),
+                                         activateRows );
+    }
+
+    return true;
+}
+
+/* 
+ * Get the next N accesses to main memory. Called GetNextAccess N times and 
+ * places the return values into a vector of TraceLine pointers.
+ */
+int BinaryTraceReader::GetNextNAccesses( unsigned int N, 
+                                   std::vector<TraceLine *> *nextAccesses )
+{
+    int successes = 0;
+
+    for( unsigned int i = 0; i < N; i++ )
+    {
+        TraceLine *nextLine = new TraceLine( );
+
+        if( GetNextAccess( nextLine ) )
+        {
+            nextAccesses->push_back( nextLine );
+            successes++;
+        }
+        else
+        {
+            delete nextLine;
+            break;
+        }
+    }
+
+    return successes;
+}
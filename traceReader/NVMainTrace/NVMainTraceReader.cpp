@@ -35,11 +35,9 @@
 *******************************************************************************/
 
 #include "traceReader/NVMainTrace/NVMainTraceReader.h"
-#include <sstream>
+#include "src/PIMCostModel.h"
 #include <cstdlib>
-#include <cassert>
 #include <cstring>
-#include <arpa/inet.h>
 
 using namespace NVM;
 
@@ -49,6 +47,10 @@ NVMainTraceReader::NVMainTraceReader( )
 
     traceVersion = 0;
     readVersion = false;
+
+    bufferStart = 0;
+    bufferEnd = 0;
+    bufferEOF = false;
 }
 
 NVMainTraceReader::~NVMainTraceReader( )
@@ -67,6 +69,137 @@ std::string NVMainTraceReader::GetTraceFile( )
     return traceFile;
 }
 
+/* Size of the buffer the trace is read into. Grows for longer lines. */
+static const size_t TraceBufferSize = 1 << 20;
+
+/* Value of each hex digit, or -1 for characters that are not hex digits. */
+static const signed char *HexTable( )
+{
+    static signed char table[256];
+    static bool initialized = false;
+
+    if( !initialized )
+    {
+        memset( table, -1, sizeof(table) );
+
+        for( int digit = 0; digit < 10; digit++ )
+            table['0' + digit] = static_cast<signed char>( digit );
+
+        for( int digit = 0; digit < 6; digit++ )
+        {
+            table['a' + digit] = static_cast<signed char>( 10 + digit );
+            table['A' + digit] = static_cast<signed char>( 10 + digit );
+        }
+
+        initialized = true;
+    }
+
+    return table;
+}
+
+/* Parses a hex number with an optional 0x prefix, up to the first non-hex digit. */
+static uint64_t ParseHex( const char *start, const char *end )
+{
+    const signed char *hex = HexTable( );
+    uint64_t value = 0;
+
+    if( end - start > 2 && start[0] == '0' && (start[1] == 'x' || start[1] == 'X') )
+        start += 2;
+
+    for( ; start < end && hex[static_cast<unsigned char>(*start)] >= 0; start++ )
+        value = (value << 4) | static_cast<uint64_t>( hex[static_cast<unsigned char>(*start)] );
+
+    return value;
+}
+
+/* Parses a decimal number like atoi, up to the first non-digit. */
+static int64_t ParseDecimal( const char *start, const char *end )
+{
+    bool negative = false;
+    int64_t value = 0;
+
+    if( start < end && (*start == '-' || *start == '+') )
+    {
+        negative = (*start == '-');
+        start++;
+    }
+
+    for( ; start < end && *start >= '0' && *start <= '9'; start++ )
+        value = value * 10 + (*start - '0');
+
+    return (negative ? -value : value);
+}
+
+/* 
+ *  Fills block with one byte per two hex digits, most significant digit
+ *  first. Characters that are not hex digits are read as zero.
+ */
+static void ParseDataBlock( const char *start, const char *end, NVMDataBlock& block )
+{
+    const signed char *hex = HexTable( );
+    uint64_t size = static_cast<uint64_t>( end - start ) / 2;
+
+    if( size == 0 )
+        return;
+
+    block.SetSize( size );
+
+    for( uint64_t byte = 0; byte < size; byte++ )
+    {
+        signed char high = hex[static_cast<unsigned char>(start[2*byte])];
+        signed char low = hex[static_cast<unsigned char>(start[2*byte+1])];
+
+        block.rawData[byte] = static_cast<uint8_t>( ((high < 0) ? 0 : high) << 4 
+                                                   | ((low < 0) ? 0 : low) );
+    }
+}
+
+/*
+ *  Returns the next newline terminated line in the trace. Text after the
+ *  last newline is not a line, matching getline followed by an eof check.
+ */
+bool NVMainTraceReader::ReadLine( const char **lineStart, const char **lineEnd )
+{
+    while( true )
+    {
+        const char *newline = NULL;
+        
+        if( bufferStart < bufferEnd )
+        {
+            newline = static_cast<const char *>( 
+                      memchr( &buffer[bufferStart], '\n', bufferEnd - bufferStart ) );
+        }
+
+        if( newline != NULL )
+        {
+            *lineStart = &buffer[bufferStart];
+            *lineEnd = newline;
+            bufferStart = static_cast<size_t>( newline - &buffer[0] ) + 1;
+            return true;
+        }
+
+        if( bufferEOF )
+            return false;
+
+        /* Move the partial line to the front and refill the rest. */
+        if( bufferStart > 0 )
+        {
+            memmove( &buffer[0], &buffer[bufferStart], bufferEnd - bufferStart );
+            bufferEnd -= bufferStart;
+            bufferStart = 0;
+        }
+
+        if( bufferEnd == buffer.size( ) )
+            buffer.resize( 2 * buffer.size( ) );
+
+        trace.read( &buffer[bufferEnd], buffer.size( ) - bufferEnd );
+        bufferEnd += static_cast<size_t>( trace.gcount( ) );
+
+        if( trace.gcount( ) == 0 )
+            bufferEOF = true;
+    }
+}
+
 /*
  *  This trace is printed from nvmain.cpp. The format is:
  *
@@ -90,24 +223,42 @@ bool NVMainTraceReader::GetNextAccess( TraceLine *nextAccess )
             std::cerr << "Could not open trace file: " << traceFile << "!" << std::endl;
             return false;
         }
+
+        buffer.resize( TraceBufferSize );
+        bufferStart = 0;
+        bufferEnd = 0;
+        bufferEOF = false;
     }
 
-    std::string fullLine;
+    const char *lineStart;
+    const char *lineEnd;
 
     /* We will read in a full line and fill in these values */
-    unsigned int cycle = 0;
+    ncycle_t cycle = 0;
     OpType operation = READ;
-    uint64_t address;
-    uint64_t address2;
+    uint64_t address = 0;
+    uint64_t address2 = 0;
+    uint64_t address3 = 0;
+    uint64_t bulkSize = 0;
+    uint64_t bulkWidth = 1;
+    BulkBitwiseOp bulkOp = BBOP_COPY;
+    uint64_t activateRows = 0;
+    bool multiRow = false;
     NVMDataBlock dataBlock;
     NVMDataBlock oldDataBlock;
     unsigned int threadId = 0;
     bool two_addresses = false;
     
     /* There are no more lines in the trace... Send back a "dummy" line */
-    getline( trace, fullLine );
-    if( trace.eof( ) )
+    if( !ReadLine( &lineStart, &lineEnd ) )
     {
+        if( trace.is_corrupt( ) )
+        {
+            std::cerr << "NVMain Error: Could not read all of trace file "
+                      << traceFile << "." << std::endl;
+            exit(1);
+        }
+
         NVMAddress nAddress;
         nAddress.SetPhysicalAddress( 0xDEADC0DEDEADBEEFULL );
         nextAccess->SetLine( nAddress, NOP, 0, dataBlock, oldDataBlock, 0 );
@@ -117,147 +268,200 @@ bool NVMainTraceReader::GetNextAccess( TraceLine *nextAccess )
 
     if( !readVersion )
     {
-        if( fullLine.substr( 0, 4 ) == "NVMV" )
+        if( lineEnd - lineStart >= 4 && strncmp( lineStart, "NVMV", 4 ) == 0 )
         {
-            std::string versionString = fullLine.substr( 4, std::string::npos );
+            std::string versionString( lineStart + 4, lineEnd );
             traceVersion = atoi( versionString.c_str( ) );
         }
 
         readVersion = true;
-        getline( trace, fullLine );
+
+        if( !ReadLine( &lineStart, &lineEnd ) )
+            lineStart = lineEnd;
     }
     
-    std::istringstream lineStream( fullLine );
-    std::string field;
-    unsigned char fieldId = 0;
-    
     /*
      *  Again, the format is : CYCLE OP ADDRESS DATA THREADID ADDRESS2
      *  So the field ids are :   0    1    2      3      4      5
+     *
+     *  Bulk bitwise operations (BBOP_AND, BBOP_OR, ...) write ADDRESS from
+     *  ADDRESS2 and a third operand, followed by the operand size in bytes:
+     *  CYCLE OP ADDRESS DATA THREADID ADDRESS2 ADDRESS3 SIZE
+     *    0    1    2      3     4       5        6      7
+     *
+     *  Arithmetic (BBOP_ADD, BBOP_SUB, BBOP_LT, BBOP_MUL, BBOP_POPCOUNT) works
+     *  on vertical operands, one row per bit, and adds the source element
+     *  width in bits as field 8. SIZE is then the size of one bit row.
+     *
+     *  Row copies (ROWCLONE_PSM, ROWCLONE_LISA) copy the row of ADDRESS2
+     *  into the row of ADDRESS.
+     *
+     *  Local writes (LW) write DATA into the open row of ADDRESS from inside
+     *  the bank, without a data bus burst.
+     *
+     *  Pinatubo multi-row activates (MRA_OR, MRA_AND, MRA_XOR) sense ROWS
+     *  consecutive rows starting at the row of ADDRESS (two by default):
+     *  CYCLE OP ADDRESS DATA THREADID ROWS
+     *    0    1    2      3     4      5
      */
-    while( getline( lineStream, field, ' ' ) )
-    {
-        if( field != "" )
-        {
-            if( fieldId == 0 )
-                cycle = atoi( field.c_str( ) );
-            else if( fieldId == 1 )
-            {
-                if( field == "R" )
-                    operation = READ;
-                else if( field == "W" )
-                    operation = WRITE;
-                else if(field =="O" )
-                    operation = OA;
-                else if(field == "S" || field == "SRA" )
-                    operation = SRA;
-                else if (field == "D" || field == "DRA" )
-                    operation = DRA;
-                else if(field == "T" || field == "TRA" )
-                    operation = TRA;
-                else if (field == "ODRA" )
-                    operation = ODRA;
-                else if(field == "OTRA" )
-                    operation = OTRA;
-                else if(field == "oSRA" )
-                    operation = OA;  /* Overlapped Single Row Activate */
-                else if(field == "ROWCLONE_PSM" )
-                    operation = ROWCLONE_PSM;
-                else
-                    std::cout << "Warning: Unknown operation `" 
-                        << field << "'" << std::endl;
-            }
-            else if( fieldId == 2 )
-            {
-                std::stringstream fmat;
+    const char *cursor = lineStart;
+    unsigned char fieldId = 0;
 
-                fmat << std::hex << field;
-                fmat >> address;
-            }
-            else if( fieldId == 3 )
-            {
-                int byte;
-                int start, end;
+    while( cursor < lineEnd )
+    {
+        /* Fields are separated by one or more spaces. */
+        const char *field = cursor;
+        const char *fieldEnd = static_cast<const char *>( 
+                               memchr( cursor, ' ', lineEnd - cursor ) );
 
-                /* Assumes 64-byte memory words.... */
-                // TODO: Drop assumption and use field.length()/2 bytes
-                assert(sizeof(uint64_t)*8 == 64);
-                assert(field.length() == 128); // 1 char per 4 bits
+        if( fieldEnd == NULL )
+            fieldEnd = lineEnd;
 
-                dataBlock.SetSize( 64 );
+        cursor = fieldEnd + 1;
 
-                uint32_t *rawData = reinterpret_cast<uint32_t*>(dataBlock.rawData);
-                memset(rawData, 0, 64);
-                
-                for( byte = 0; byte < 16; byte++ )
-                {
-                    std::stringstream fmat;
+        if( field == fieldEnd )
+            continue;
 
-                    end = 8*byte + 8;
-                    start = 8*byte;
+        size_t length = static_cast<size_t>( fieldEnd - field );
 
-                    fmat << std::hex << field.substr( start, end - start );
-                    fmat >> rawData[byte];
-                    rawData[byte] = htonl( rawData[byte] );
-                }
+        if( fieldId == 0 )
+            cycle = static_cast<ncycle_t>( ParseDecimal( field, fieldEnd ) );
+        else if( fieldId == 1 )
+        {
+            std::string op( field, length );
+
+            if( op == "R" )
+                operation = READ;
+            else if( op == "W" )
+                operation = WRITE;
+            else if(op =="O" )
+                operation = OA;
+            else if(op == "S" )
+                operation = SRA;
+            else if (op == "D" )
+                operation = DRA;
+            else if(op == "T" )
+                operation = TRA;
+            /* PIM activates by their name in the cost table, e.g., TRA or QRA. */
+            else if( PIMCostModel::GetPrimitive( op ) != PIMPrimitives )
+                operation = PIMCostModel::GetInfo( PIMCostModel::GetPrimitive( op ) ).type;
+            else if(op == "oSRA" )
+                operation = OA;  /* Overlapped Single Row Activate */
+            else if(op == "ROWCLONE_PSM" )
+                operation = ROWCLONE_PSM;
+            else if( op == "ROWCLONE_LISA" )
+                operation = ROWCLONE_LISA;
+            else if( op == "LW" )
+                operation = LW;  /* Local Write of a PIM result */
+            else if( op == "MRA_OR" || op == "MRA_AND" || op == "MRA_XOR" )
+            {
+                /* The activate type is set from the row count below. */
+                operation = DRA;
+                multiRow = true;
+                activateRows = 2;
+
+                if( op == "MRA_AND" )
+                    bulkOp = BBOP_AND;
+                else if( op == "MRA_XOR" )
+                    bulkOp = BBOP_XOR;
+                else
+                    bulkOp = BBOP_OR;
             }
-            else if( fieldId == 4 )
+            else if( length > 5 && op.compare( 0, 5, "BBOP_" ) == 0 )
             {
-                if( traceVersion == 0 )
-                {
-                    threadId = atoi( field.c_str( ) );
-
-                    /* Zero out old data in 1.0 trace format. */
-                    oldDataBlock.SetSize( 64 );
-
-                    uint64_t *rawData = reinterpret_cast<uint64_t*>(oldDataBlock.rawData);
-                    memset(rawData, 0, 64);
-                }
+                operation = BBOP;
+
+                if( op == "BBOP_AND" )
+                    bulkOp = BBOP_AND;
+                else if( op == "BBOP_OR" )
+                    bulkOp = BBOP_OR;
+                else if( op == "BBOP_XOR" )
+                    bulkOp = BBOP_XOR;
+                else if( op == "BBOP_NOT" )
+                    bulkOp = BBOP_NOT;
+                else if( op == "BBOP_NAND" )
+                    bulkOp = BBOP_NAND;
+                else if( op == "BBOP_NOR" )
+                    bulkOp = BBOP_NOR;
+                else if( op == "BBOP_COPY" )
+                    bulkOp = BBOP_COPY;
+                else if( op == "BBOP_ADD" )
+                    bulkOp = BBOP_ADD;
+                else if( op == "BBOP_SUB" )
+                    bulkOp = BBOP_SUB;
+                else if( op == "BBOP_LT" )
+                    bulkOp = BBOP_LT;
+                else if( op == "BBOP_MUL" )
+                    bulkOp = BBOP_MUL;
+                else if( op == "BBOP_POPCOUNT" )
+                    bulkOp = BBOP_POPCOUNT;
                 else
                 {
-                    int byte;
-                    int start, end;
-
-                    /* Assumes 64-byte memory words.... */
-                    // TODO: Drop assumption and use field.length()/2 bytes
-                    assert(sizeof(uint64_t)*8 == 64);
-                    assert(field.length() == 128); // 1 char per 4 bits
-
-                    oldDataBlock.SetSize( 64 );
-
-                    uint32_t *rawData = reinterpret_cast<uint32_t*>(oldDataBlock.rawData);
-                    memset(rawData, 0, 64);
-                    
-                    for( byte = 0; byte < 16; byte++ )
-                    {
-                        std::stringstream fmat;
-
-                        end = 8*byte + 8;
-                        start = 8*byte;
-
-                        fmat << std::hex << field.substr( start, end - start );
-                        fmat >> rawData[byte];
-                        rawData[byte] = htonl( rawData[byte] );
-                    }
+                    operation = READ;
+                    std::cout << "Warning: Unknown operation `" 
+                        << op << "'" << std::endl;
                 }
             }
-            else if( fieldId == 5 )
+            else
+                std::cout << "Warning: Unknown operation `" 
+                    << op << "'" << std::endl;
+        }
+        else if( fieldId == 2 )
+        {
+            address = ParseHex( field, fieldEnd );
+        }
+        else if( fieldId == 3 )
+        {
+            /* Data blocks may be any size, with two hex digits per byte. */
+            ParseDataBlock( field, fieldEnd, dataBlock );
+        }
+        else if( fieldId == 4 )
+        {
+            if( traceVersion == 0 )
             {
-                if( traceVersion != 0 ){
-                    threadId = atoi( field.c_str( ) );
-                    break;
-                }
-                //handle ADDRESS 2 if it exists
-                
-                std::stringstream fmat;
+                threadId = static_cast<unsigned int>( ParseDecimal( field, fieldEnd ) );
 
-                fmat << std::hex << field;
-                fmat >> address2;
-                two_addresses = true;
+                /* Zero out old data in 1.0 trace format. */
+                oldDataBlock.SetSize( 64 );
+                memset( oldDataBlock.rawData, 0, 64 );
+            }
+            else
+            {
+                ParseDataBlock( field, fieldEnd, oldDataBlock );
+            }
+        }
+        else if( fieldId == 5 )
+        {
+            if( traceVersion != 0 ){
+                threadId = static_cast<unsigned int>( ParseDecimal( field, fieldEnd ) );
+                break;
             }
+            if( multiRow )
+            {
+                activateRows = ParseDecimal( field, fieldEnd );
+                fieldId++;
+                continue;
+            }
+
+            //handle ADDRESS 2 if it exists
             
-            fieldId++;
+            address2 = ParseHex( field, fieldEnd );
+            two_addresses = true;
+        }
+        else if( fieldId == 6 )
+        {
+            address3 = ParseHex( field, fieldEnd );
+        }
+        else if( fieldId == 7 )
+        {
+            bulkSize = ParseDecimal( field, fieldEnd );
         }
+        else if( fieldId == 8 )
+        {
+            bulkWidth = ParseDecimal( field, fieldEnd );
+        }
+        
+        fieldId++;
     }
 
     static unsigned int linenum = 0;
@@ -265,11 +469,44 @@ bool NVMainTraceReader::GetNextAccess( TraceLine *nextAccess )
     linenum++;
 
     if( operation != READ && operation != WRITE && 
-        operation != TRA && operation != DRA && operation != SRA &&
-        operation != OTRA && operation != ODRA && operation != OA )
+        !PIMCostModel::IsMultiRowActivate( operation ) &&
+        !PIMCostModel::IsOverlappedActivate( operation ) &&
+        operation != BBOP && operation != ROWCLONE_PSM && operation != ROWCLONE_LISA &&
+        operation != LW )
         std::cout << "NVMainTraceReader: Unknown Operation: " << operation 
-            << "Line number is " << linenum << ". Full Line is \"" << fullLine 
-            << "\"" << std::endl;
+            << "Line number is " << linenum << ". Full Line is \"" 
+            << std::string( lineStart, lineEnd ) << "\"" << std::endl;
+
+    if( multiRow )
+    {
+        if( activateRows == 0 )
+        {
+            std::cout << "NVMainTraceReader: Multi-row activate of zero rows on line "
+                << linenum << "." << std::endl;
+            activateRows = 2;
+        }
+
+        operation = PIMCostModel::GetMultiRowActivate( activateRows );
+    }
+    else if( PIMCostModel::IsMultiRowActivate( operation ) )
+    {
+        /* Plain row activates sense the OR of the rows they raise. */
+        bulkOp = BBOP_OR;
+    }
+
+    if( operation == BBOP && !two_addresses )
+    {
+        std::cout << "NVMainTraceReader: Bulk bitwise operation without a source "
+            << "address on line " << linenum << "." << std::endl;
+        operation = READ;
+    }
+
+    if( ( operation == ROWCLONE_PSM || operation == ROWCLONE_LISA ) && !two_addresses )
+    {
+        std::cout << "NVMainTraceReader: Row copy without a source address on line "
+            << linenum << "." << std::endl;
+        operation = READ;
+    }
 
     /*
      *  Set the line parameters.
@@ -288,6 +525,20 @@ bool NVMainTraceReader::GetNextAccess( TraceLine *nextAccess )
 
         nextAccess->SetLine( nAddress, nAddress2, operation, cycle, dataBlock, oldDataBlock, threadId );
 
+        if( operation == BBOP )
+        {
+            NVMAddress nAddress3;
+
+            /* Unary operations only read ADDRESS2. */
+            nAddress3.SetPhysicalAddress( (fieldId > 6) ? address3 : address2 );
+
+            nextAccess->SetBulkOperation( nAddress3, bulkOp, bulkSize, bulkWidth );
+        }
+        else if( PIMCostModel::IsMultiRowActivate( operation ) )
+        {
+            nextAccess->SetMultiRowActivate( bulkOp, activateRows );
+        }
+
         return true;
     }
 
@@ -303,6 +554,9 @@ bool NVMainTraceReader::GetNextAccess( TraceLine *nextAccess )
         nextAccess->SetLine( nAddress, operation, cycle, dataBlock, oldDataBlock, threadId );
     }
 
+    if( PIMCostModel::IsMultiRowActivate( operation ) )
+        nextAccess->SetMultiRowActivate( bulkOp, activateRows );
+
     return true;
 }
 
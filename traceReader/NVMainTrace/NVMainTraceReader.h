@@ -35,6 +35,7 @@
 #define __NVMAINTRACEREADER_H__
 
 #include "traceReader/GenericTraceReader.h"
+#include "include/CompressedStream.h"
 #include <string>
 #include <iostream>
 #include <fstream>
@@ -55,9 +56,16 @@ class NVMainTraceReader : public GenericTraceReader
   
   private:
     std::string traceFile;
-    std::ifstream trace;
+    TraceInputStream trace;
     unsigned int traceVersion;
     bool readVersion;
+
+    /* Trace text is parsed in place from this buffer. */
+    std::vector<char> buffer;
+    size_t bufferStart, bufferEnd;
+    bool bufferEOF;
+
+    bool ReadLine( const char **lineStart, const char **lineEnd );
 };
 
 };
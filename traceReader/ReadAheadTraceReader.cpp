@@ -0,0 +1,225 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceReader/ReadAheadTraceReader.h"
+
+using namespace NVM;
+
+/* Polls of the ring before a waiting side goes to sleep. */
+static const int readAheadSpins = 64;
+
+ReadAheadTraceReader::ReadAheadTraceReader( GenericTraceReader *reader, 
+                                            ncounter_t depth )
+    : ring( depth ), valid( depth, 0 )
+{
+    this->reader = reader;
+    started = false;
+
+    head = 0;
+    tail = 0;
+    stopping = false;
+
+    producerStalls = 0;
+    consumerStalls = 0;
+
+    producerSleeping = false;
+    consumerSleeping = false;
+}
+
+ReadAheadTraceReader::~ReadAheadTraceReader( )
+{
+    stopping = true;
+    Wake( producerSleeping, producerWake );
+
+    if( started )
+        producer.join( );
+
+    delete reader;
+}
+
+void ReadAheadTraceReader::SetTraceFile( std::string file )
+{
+    reader->SetTraceFile( file );
+}
+
+std::string ReadAheadTraceReader::GetTraceFile( )
+{
+    return reader->GetTraceFile( );
+}
+
+void ReadAheadTraceReader::Produce( )
+{
+    ncounter_t depth = ring.size( );
+    bool more = true;
+
+    while( more )
+    {
+        ncounter_t produced = head.load( std::memory_order_relaxed );
+
+        /* Wait for the simulation to free a slot. */
+        if( produced - tail.load( std::memory_order_acquire ) == depth )
+        {
+            producerStalls.fetch_add( 1, std::memory_order_relaxed );
+
+            for( int spin = 0; spin < readAheadSpins; spin++ )
+            {
+                if( produced - tail.load( std::memory_order_acquire ) != depth )
+                    break;
+
+                std::this_thread::yield( );
+            }
+
+            std::unique_lock<std::mutex> lock( sleepLock );
+
+            producerSleeping = true;
+            while( !stopping.load( ) && produced - tail.load( ) == depth )
+                producerWake.wait( lock );
+            producerSleeping = false;
+
+            if( stopping.load( ) )
+                return;
+        }
+
+        ncounter_t slot = produced % depth;
+
+        more = reader->GetNextAccess( &ring[slot] );
+        valid[slot] = more;
+
+        head.store( produced + 1 );
+        Wake( consumerSleeping, consumerWake );
+    }
+}
+
+void ReadAheadTraceReader::Wake( std::atomic<bool>& sleeping, 
+                                 std::condition_variable& wake )
+{
+    /* 
+     *  The counters and sleeping flags are sequentially consistent, so either
+     *  the sleeper sees the new count before waiting or this sees it asleep.
+     */
+    if( sleeping.load( ) )
+    {
+        std::lock_guard<std::mutex> lock( sleepLock );
+        wake.notify_one( );
+    }
+}
+
+bool ReadAheadTraceReader::GetNextAccess( TraceLine *nextAccess )
+{
+    if( !started )
+    {
+        producer = std::thread( &ReadAheadTraceReader::Produce, this );
+        started = true;
+    }
+
+    ncounter_t consumed = tail.load( std::memory_order_relaxed );
+
+    /* Wait for the producer to parse the next line. */
+    if( head.load( std::memory_order_acquire ) == consumed )
+    {
+        consumerStalls.fetch_add( 1, std::memory_order_relaxed );
+
+        for( int spin = 0; spin < readAheadSpins; spin++ )
+        {
+            if( head.load( std::memory_order_acquire ) != consumed )
+                break;
+
+            std::this_thread::yield( );
+        }
+
+        std::unique_lock<std::mutex> lock( sleepLock );
+
+        consumerSleeping = true;
+        while( head.load( ) == consumed )
+            consumerWake.wait( lock );
+        consumerSleeping = false;
+    }
+
+    ncounter_t slot = consumed % ring.size( );
+    TraceLine& line = ring[slot];
+    bool rv = valid[slot];
+
+    nextAccess->SetLine( line.GetAddress( ), line.GetAddress2( ), 
+                         line.GetOperation( ), line.GetCycle( ), line.GetData( ),
+                         line.GetOldData( ), line.GetThreadId( ) );
+    nextAccess->SetBulkOperation( line.GetAddress3( ), line.GetBulkOperation( ),
+                                  line.GetBulkSize( ), line.GetBulkWidth( ) );
+    nextAccess->SetMultiRowActivate( line.GetBulkOperation( ), line.GetActivateRows( ) );
+
+    /* The last line is left in the ring once the trace has ended. */
+    if( rv )
+    {
+        tail.store( consumed + 1 );
+        Wake( producerSleeping, producerWake );
+    }
+
+    return rv;
+}
+
+/* 
+ * Get the next N accesses to main memory. Called GetNextAccess N times and 
+ * places the return values into a vector of TraceLine pointers.
+ */
+int ReadAheadTraceReader::GetNextNAccesses( unsigned int N, 
+                                   std::vector<TraceLine *> *nextAccesses )
+{
+    int successes = 0;
+
+    for( unsigned int i = 0; i < N; i++ )
+    {
+        TraceLine *nextLine = new TraceLine( );
+
+        if( GetNextAccess( nextLine ) )
+        {
+            nextAccesses->push_back( nextLine );
+            successes++;
+        }
+        else
+        {
+            delete nextLine;
+            break;
+        }
+    }
+
+    return successes;
+}
+
+ncounter_t ReadAheadTraceReader::GetProducerStalls( )
+{
+    return producerStalls.load( );
+}
+
+ncounter_t ReadAheadTraceReader::GetConsumerStalls( )
+{
+    return consumerStalls.load( );
+}
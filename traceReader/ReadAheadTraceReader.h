@@ -0,0 +1,100 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __READAHEADTRACEREADER_H__
+#define __READAHEADTRACEREADER_H__
+
+#include "traceReader/GenericTraceReader.h"
+#include "include/NVMTypes.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NVM {
+
+/*
+ *  Wraps another trace reader and parses ahead of the simulation on a
+ *  producer thread. Parsed lines are passed through a single producer,
+ *  single consumer ring so the simulation only waits if the producer falls
+ *  behind. Either side spins briefly on an empty or full ring, then sleeps
+ *  until the other side moves.
+ */
+class ReadAheadTraceReader : public GenericTraceReader
+{
+  public:
+    ReadAheadTraceReader( GenericTraceReader *reader, ncounter_t depth );
+    ~ReadAheadTraceReader( );
+    
+    void SetTraceFile( std::string file );
+    std::string GetTraceFile( );
+    
+    bool GetNextAccess( TraceLine *nextAccess );
+    int  GetNextNAccesses( unsigned int N, std::vector<TraceLine *> *nextAccess );
+
+    ncounter_t GetProducerStalls( );
+    ncounter_t GetConsumerStalls( );
+
+  private:
+    GenericTraceReader *reader;
+    std::thread producer;
+    bool started;
+
+    /* Ring slots and whether the wrapped reader returned a line for each. */
+    std::vector<TraceLine> ring;
+    std::vector<char> valid;
+
+    /* Free running counts of lines produced and consumed. */
+    std::atomic<ncounter_t> head;
+    std::atomic<ncounter_t> tail;
+    std::atomic<bool> stopping;
+
+    std::atomic<ncounter_t> producerStalls;
+    std::atomic<ncounter_t> consumerStalls;
+
+    /* Set while a side is asleep so the other side knows to wake it. */
+    std::mutex sleepLock;
+    std::condition_variable producerWake;
+    std::condition_variable consumerWake;
+    std::atomic<bool> producerSleeping;
+    std::atomic<bool> consumerSleeping;
+
+    void Produce( );
+    void Wake( std::atomic<bool>& sleeping, std::condition_variable& wake );
+};
+
+};
+
+#endif
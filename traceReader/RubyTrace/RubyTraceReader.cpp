@@ -106,6 +106,13 @@ bool RubyTraceReader::GetNextAccess( TraceLine *nextAccess )
          */
         if( trace.eof( ) )
         {
+            if( trace.is_corrupt( ) )
+            {
+                std::cerr << "NVMain Error: Could not read all of trace file "
+                          << traceFile << "." << std::endl;
+                exit(1);
+            }
+
             NVMAddress nAddress;
             nAddress.SetPhysicalAddress( 0xDEADC0DEDEADBEEFULL );
             nextAccess->SetLine( nAddress, NOP, 0, dataBlock, oldDataBlock, 0 );
@@ -43,6 +43,11 @@ TraceLine::TraceLine( )
      */
     address.SetPhysicalAddress( 0xDEADC0DE0BADC0DEULL );
     address2.SetPhysicalAddress( 0xDEADC0DE0BADC0DEULL );
+    address3.SetPhysicalAddress( 0xDEADC0DE0BADC0DEULL );
+    bulkOp = BBOP_COPY;
+    bulkSize = 0;
+    bulkWidth = 1;
+    activateRows = 0;
     operation = NOP;
     cycle = 0;
     threadId = 0;
@@ -76,6 +81,23 @@ void TraceLine::SetLine( NVMAddress& addr, NVMAddress& addr2, OpType op, ncycle_
     this->threadId = threadId;
 }
 
+/* Set the second source, size and element width of a bulk bitwise operation. */
+void TraceLine::SetBulkOperation( NVMAddress& addr3, BulkBitwiseOp bulkOp, ncounter_t bulkSize,
+                                  ncounter_t bulkWidth )
+{
+    this->address3 = addr3;
+    this->bulkOp = bulkOp;
+    this->bulkSize = bulkSize;
+    this->bulkWidth = bulkWidth;
+}
+
+/* Set the sensed operation and row count of a Pinatubo multi-row activate. */
+void TraceLine::SetMultiRowActivate( BulkBitwiseOp senseOp, ncounter_t rows )
+{
+    this->bulkOp = senseOp;
+    this->activateRows = rows;
+}
+
 /* Get the address of the memory operation. */
 NVMAddress& TraceLine::GetAddress( )
 {
@@ -88,6 +110,12 @@ NVMAddress& TraceLine::GetAddress2( )
     return address2;
 }
 
+/* Get the second source address of a bulk bitwise operation. */
+NVMAddress& TraceLine::GetAddress3( )
+{
+    return address3;
+}
+
 /* Get the memory command of the operation. */
 OpType TraceLine::GetOperation( )
 {
@@ -113,3 +141,23 @@ ncounters_t TraceLine::GetThreadId( )
 {
     return threadId;
 }
+
+BulkBitwiseOp TraceLine::GetBulkOperation( )
+{
+    return bulkOp;
+}
+
+ncounter_t TraceLine::GetBulkSize( )
+{
+    return bulkSize;
+}
+
+ncounter_t TraceLine::GetBulkWidth( )
+{
+    return bulkWidth;
+}
+
+ncounter_t TraceLine::GetActivateRows( )
+{
+    return activateRows;
+}
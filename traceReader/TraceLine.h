@@ -52,19 +52,33 @@ class TraceLine
 
     void SetLine( NVMAddress& addr, NVMAddress& addr2, OpType op, ncycle_t cy, NVMDataBlock& data, NVMDataBlock& oldData, ncounters_t threadId );
 
+    void SetBulkOperation( NVMAddress& addr3, BulkBitwiseOp bulkOp, ncounter_t bulkSize,
+                           ncounter_t bulkWidth = 1 );
+    void SetMultiRowActivate( BulkBitwiseOp senseOp, ncounter_t rows );
+
 
     NVMAddress& GetAddress( );
     NVMAddress& GetAddress2( );
+    NVMAddress& GetAddress3( );
 
     OpType GetOperation( );
     ncycle_t GetCycle( );
     NVMDataBlock& GetData( );
     NVMDataBlock& GetOldData( );
     ncounters_t GetThreadId( );
+    BulkBitwiseOp GetBulkOperation( );
+    ncounter_t GetBulkSize( );
+    ncounter_t GetBulkWidth( );
+    ncounter_t GetActivateRows( );
 
   private:
     NVMAddress address;
     NVMAddress address2;
+    NVMAddress address3;
+    BulkBitwiseOp bulkOp;
+    ncounter_t bulkSize;
+    ncounter_t bulkWidth;
+    ncounter_t activateRows;
     OpType operation;
     ncycle_t cycle;
     NVMDataBlock data;
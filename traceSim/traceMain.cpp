@@ -38,12 +38,14 @@
 #include <cmath>
 #include <stdlib.h>
 #include <fstream>
+#include <chrono>
 
 #include "src/Interconnect.h"
 #include "Interconnect/InterconnectFactory.h"
 #include "src/Config.h"
 #include "src/TranslationMethod.h"
 #include "traceReader/TraceReaderFactory.h"
+#include "traceReader/ReadAheadTraceReader.h"
 #include "src/AddressTranslator.h"
 #include "Decoders/DecoderFactory.h"
 #include "src/MemoryController.h"
@@ -53,6 +55,7 @@
 #include "include/NVMHelpers.h"
 #include "Utils/HookFactory.h"
 #include "src/EventQueue.h"
+#include "src/PIMCostModel.h"
 #include "NVM/nvmain.h"
 #include "traceSim/traceMain.h"
 
@@ -67,7 +70,10 @@ int main( int argc, char *argv[] )
 
 TraceMain::TraceMain( )
 {
-
+    readAhead = NULL;
+    readAheadDepth = 0;
+    readAheadProducerStalls = 0;
+    readAheadConsumerStalls = 0;
 }
 
 TraceMain::~TraceMain( )
@@ -184,6 +190,37 @@ int TraceMain::RunTrace( int argc, char *argv[] )
 
     trace->SetTraceFile( argv[2] );
 
+    /* 
+     *  Optionally parse the trace ahead of the simulation on a second thread.
+     *  TraceReadAhead sets the number of lines buffered, 0 (default) disables.
+     */
+    if( config->KeyExists( "TraceReadAhead" ) )
+        readAheadDepth = config->GetValueUL( "TraceReadAhead" );
+
+    if( readAheadDepth > 0 )
+    {
+        readAhead = new ReadAheadTraceReader( trace, readAheadDepth );
+        trace = readAhead;
+
+        StatName( "traceMain" );
+
+        AddStat(readAheadDepth);
+        AddStat(readAheadProducerStalls);
+        AddStat(readAheadConsumerStalls);
+    }
+
+    /* Only measure how fast the trace can be read, without simulating it. */
+    if( config->KeyExists( "TraceBenchmark" ) 
+        && config->GetString( "TraceBenchmark" ) == "true" )
+    {
+        int rv = BenchmarkTrace( trace );
+
+        delete config;
+        delete stats;
+
+        return rv;
+    }
+
     if( argc == 3 )
         simulateCycles = 0;
     else
@@ -237,10 +274,25 @@ int TraceMain::RunTrace( int argc, char *argv[] )
         request->status = MEM_REQUEST_INCOMPLETE;
         request->owner = (NVMObject *)this;
 
-        if(request->type == ROWCLONE_PSM || request->type == OA || request->type == TRA)
+        if(request->type == ROWCLONE_PSM || request->type == ROWCLONE_LISA 
+           || request->type == OA || request->type == TRA)
         {
             request->address2 = tl->GetAddress2( );
         }
+        else if( request->type == BBOP )
+        {
+            request->address2 = tl->GetAddress2( );
+            request->address3 = tl->GetAddress3( );
+            request->bulkOp = tl->GetBulkOperation( );
+            request->bulkSize = tl->GetBulkSize( );
+            request->bulkWidth = tl->GetBulkWidth( );
+        }
+
+        if( PIMCostModel::IsMultiRowActivate( request->type ) )
+        {
+            request->bulkOp = tl->GetBulkOperation( );
+            request->activateRows = tl->GetActivateRows( );
+        }
         
         /* 
          * If you want to ignore the cycles used in the trace file, just set
@@ -253,8 +305,10 @@ int TraceMain::RunTrace( int argc, char *argv[] )
 
         // TODO if we keep adding new operations, we should add a function in NVMainRequest to check if valid for trace
         if( request->type != READ && request->type != WRITE && 
-            request->type != TRA && request->type != DRA && request->type != SRA &&
-            request->type != ODRA && request->type != OTRA && request->type != OA )
+            !PIMCostModel::IsMultiRowActivate( request->type ) &&
+            !PIMCostModel::IsOverlappedActivate( request->type ) &&
+            request->type != BBOP && request->type != ROWCLONE_PSM &&
+            request->type != ROWCLONE_LISA && request->type != LW )
             std::cout << "traceMain: Unknown Operation: " << request->type 
                 << std::endl;
 
@@ -308,6 +362,13 @@ int TraceMain::RunTrace( int argc, char *argv[] )
     }       
 
     GetChild( )->CalculateStats( );
+
+    if( readAhead != NULL )
+    {
+        readAheadProducerStalls = readAhead->GetProducerStalls( );
+        readAheadConsumerStalls = readAhead->GetConsumerStalls( );
+    }
+
     std::ostream& refStream = (statStream.is_open()) ? statStream : std::cout;
     stats->PrintAll( refStream );
 
@@ -317,12 +378,36 @@ int TraceMain::RunTrace( int argc, char *argv[] )
         std::cout << "Note: " << outstandingRequests << " requests still in-flight."
                   << std::endl;
 
+    /* Stops the read ahead thread, if any. */
+    delete trace;
     delete config;
     delete stats;
 
     return 0;
 }
 
+int TraceMain::BenchmarkTrace( GenericTraceReader *trace )
+{
+    TraceLine line;
+    ncounter_t lines = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now( );
+
+    while( trace->GetNextAccess( &line ) )
+        lines++;
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now( ) - start;
+
+    std::cout << "traceMain: Read " << lines << " trace lines in " 
+              << elapsed.count( ) << " seconds (" 
+              << ((elapsed.count( ) > 0.0) ? lines / elapsed.count( ) : 0.0)
+              << " lines/second)." << std::endl;
+
+    delete trace;
+
+    return 0;
+}
+
 void TraceMain::Cycle( ncycle_t /*steps*/ )
 {
 
@@ -38,6 +38,7 @@
 
 
 #include "src/NVMObject.h"
+#include "traceReader/ReadAheadTraceReader.h"
 
 
 namespace NVM {
@@ -57,6 +58,13 @@ class TraceMain : public NVMObject
 
   private:
     ncounter_t outstandingRequests;
+
+    int BenchmarkTrace( GenericTraceReader *trace );
+
+    ReadAheadTraceReader *readAhead;
+    ncounter_t readAheadDepth;
+    ncounter_t readAheadProducerStalls;
+    ncounter_t readAheadConsumerStalls;
 };
 
 
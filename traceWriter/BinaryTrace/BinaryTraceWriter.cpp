@@ -0,0 +1,232 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceWriter/BinaryTrace/BinaryTraceWriter.h"
+#include "traceReader/BinaryTrace/BinaryTraceFormat.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace NVM;
+
+/* 
+ *  Writers that are still open when the simulator exits, e.g., because the
+ *  memory system owning the pre-tracer is never deleted, are closed here so
+ *  that the tail of the trace is not lost.
+ */
+static std::vector<BinaryTraceWriter *> *openWriters = NULL;
+
+static void CloseOpenWriters( )
+{
+    while( openWriters != NULL && !openWriters->empty( ) )
+        openWriters->back( )->Close( );
+}
+
+BinaryTraceWriter::BinaryTraceWriter( )
+{
+    lastCycle = 0;
+    lastAddress = 0;
+}
+
+BinaryTraceWriter::~BinaryTraceWriter( )
+{
+    Close( );
+}
+
+void BinaryTraceWriter::Close( )
+{
+    if( !trace.is_open( ) )
+        return;
+
+    trace.close( );
+
+    for( size_t i = 0; i < openWriters->size( ); i++ )
+    {
+        if( (*openWriters)[i] == this )
+        {
+            openWriters->erase( openWriters->begin( ) + i );
+            break;
+        }
+    }
+}
+
+void BinaryTraceWriter::SetTraceFile( std::string file )
+{
+    // Note: This function assumes an absolute path is given, otherwise
+    // the current directory is used. 
+
+    traceFile = file;
+
+    trace.open( traceFile.c_str( ), std::ios::out | std::ios::binary );
+
+    if( !trace.is_open( ) )
+    {
+        std::cout << "Warning: Could not open trace file " << file
+                  << ". Output will be suppressed." << std::endl;
+        return;
+    }
+
+    if( openWriters == NULL )
+    {
+        openWriters = new std::vector<BinaryTraceWriter *>( );
+        atexit( CloseOpenWriters );
+    }
+    openWriters->push_back( this );
+
+    /* Magic, version, flags, default block size and a reserved word. */
+    uint8_t header[BinaryTraceHeaderSize];
+
+    memset( header, 0, sizeof(header) );
+    memcpy( header, BinaryTraceMagic, sizeof(BinaryTraceMagic) );
+    header[4] = static_cast<uint8_t>( BinaryTraceVersion & 0xFF );
+    header[5] = static_cast<uint8_t>( BinaryTraceVersion >> 8 );
+    header[8] = 64;
+
+    trace.write( reinterpret_cast<const char *>(header), sizeof(header) );
+}
+
+std::string BinaryTraceWriter::GetTraceFile( )
+{
+    return traceFile;
+}
+
+void BinaryTraceWriter::SetEcho( bool echo )
+{
+    if( echo )
+    {
+        std::cout << "BinaryTraceWriter: Echo is not supported by the binary "
+                  << "trace format." << std::endl;
+    }
+
+    GenericTraceWriter::SetEcho( false );
+}
+
+bool BinaryTraceWriter::SetNextAccess( TraceLine *nextAccess )
+{
+    bool rv = false;
+
+    if( trace.is_open( ) )
+    {
+        WriteTraceLine( nextAccess );
+        rv = trace.good();
+    }
+
+    return rv;
+}
+
+void BinaryTraceWriter::WriteVarint( uint64_t value )
+{
+    uint8_t buffer[10];
+    size_t length = EncodeVarint( value, buffer );
+
+    record.insert( record.end( ), buffer, buffer + length );
+}
+
+void BinaryTraceWriter::WriteDataBlock( NVMDataBlock& block )
+{
+    WriteVarint( block.GetSize( ) );
+    record.insert( record.end( ), block.rawData, block.rawData + block.GetSize( ) );
+}
+
+void BinaryTraceWriter::WriteTraceLine( TraceLine *line )
+{
+    NVMDataBlock& data = line->GetData( );
+    NVMDataBlock& oldData = line->GetOldData( );
+    OpType operation = line->GetOperation( );
+    uint8_t opCode = GetBinaryTraceOpCode( operation );
+
+    /* Only print operations the format knows about. */
+    if( opCode == BinaryTraceOpCount || operation == NOP )
+    {
+        static bool warned = false;
+
+        if( operation != NOP && !warned )
+        {
+            std::cout << "BinaryTraceWriter: Warning: Operation type " << operation
+                      << " can not be stored in a binary trace. These lines are"
+                      << " left out of " << traceFile << "." << std::endl;
+            warned = true;
+        }
+
+        return;
+    }
+
+    uint64_t address = line->GetAddress( ).GetPhysicalAddress( );
+    uint64_t address2 = line->GetAddress2( ).GetPhysicalAddress( );
+
+    /* PIM operations carry address2 unless it was never set on the line. */
+    bool hasAddress2 = (operation != READ && operation != WRITE 
+                        && address2 != 0xDEADC0DE0BADC0DEULL);
+    bool hasData = (data.GetSize( ) > 0 && data.rawData != NULL);
+    bool hasOldData = (oldData.GetSize( ) > 0 && oldData.rawData != NULL);
+
+    record.clear( );
+    record.push_back( static_cast<uint8_t>( opCode 
+                      | (hasData ? BinaryTraceHasData : 0)
+                      | (hasOldData ? BinaryTraceHasOldData : 0)
+                      | (hasAddress2 ? BinaryTraceHasAddress2 : 0) ) );
+
+    WriteVarint( ZigZagEncode( static_cast<int64_t>(line->GetCycle( ) - lastCycle) ) );
+    WriteVarint( ZigZagEncode( static_cast<int64_t>(address - lastAddress) ) );
+
+    if( hasAddress2 )
+        WriteVarint( ZigZagEncode( static_cast<int64_t>(address2 - address) ) );
+
+    WriteVarint( ZigZagEncode( static_cast<int64_t>(line->GetThreadId( )) ) );
+
+    if( operation == BBOP )
+    {
+        uint64_t address3 = line->GetAddress3( ).GetPhysicalAddress( );
+
+        WriteVarint( ZigZagEncode( static_cast<int64_t>(address3 - address) ) );
+        WriteVarint( line->GetBulkOperation( ) );
+        WriteVarint( line->GetBulkSize( ) );
+        WriteVarint( line->GetBulkWidth( ) );
+    }
+    else if( PIMCostModel::IsMultiRowActivate( operation ) )
+    {
+        WriteVarint( line->GetBulkOperation( ) );
+        WriteVarint( line->GetActivateRows( ) );
+    }
+
+    if( hasData )
+        WriteDataBlock( data );
+
+    if( hasOldData )
+        WriteDataBlock( oldData );
+
+    trace.write( reinterpret_cast<const char *>(&record[0]), record.size( ) );
+
+    lastCycle = line->GetCycle( );
+    lastAddress = address;
+}
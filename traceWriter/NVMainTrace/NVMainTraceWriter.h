@@ -35,6 +35,7 @@
 #define __NVMAINTRACEWRITER_H__
 
 #include "traceWriter/GenericTraceWriter.h"
+#include "include/CompressedStream.h"
 #include <string>
 #include <iostream>
 #include <fstream>
@@ -54,7 +55,7 @@ class NVMainTraceWriter : public GenericTraceWriter
   
   private:
     std::string traceFile;
-    std::ofstream trace;
+    TraceOutputStream trace;
 
     void WriteTraceLine( std::ostream& , TraceLine *line );
 };